@@ -63,15 +63,28 @@
 #define configUSE_NEWLIB_REENTRANT 0
 #define configENABLE_BACKWARD_COMPATIBILITY 0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+/* índice 1: resposta do net_io_call (o 0 continua livre para as tasks) */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 
 /* System */
 #define configSTACK_DEPTH_TYPE uint32_t
 #define configMESSAGE_BUFFER_LENGTH_TYPE size_t
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION 0
+/* Tasks, filas e pools da aplicação são estáticos (mem_report.py mostra o
+ * total por subsistema); idle/timer usam a memória que o kernel reserva.
+ * O heap fica só como reserva pequena: nada o usa depois do boot. */
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configKERNEL_PROVIDED_STATIC_MEMORY 1
 #define configSUPPORT_DYNAMIC_ALLOCATION 1
-#define configTOTAL_HEAP_SIZE (128 * 1024)
+#if PICO_CYW43_ARCH_FREERTOS
+/* lwip_sys_freertos: a tcpip_thread (TCPIP_THREAD_STACKSIZE, 4 KB), a task do
+ * async_context do cyw43 e as filas/mutexes do sys_arch saem do heap,
+ * uma vez só, no cyw43_arch_init */
+#define configTOTAL_HEAP_SIZE (20 * 1024)
+#else
+#define configTOTAL_HEAP_SIZE (8 * 1024)
+#endif
 #define configAPPLICATION_ALLOCATED_HEAP 0
 
 /* Hook function related definitions. */
@@ -80,10 +93,20 @@
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS 0
+#define configGENERATE_RUN_TIME_STATS 1
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
+/* Relógio das estatísticas: timer de 1 MHz do RP2040 (já roda, não precisa
+ * configurar). 64 bits para não dar a volta (32 bits viram em ~71 min). */
+#ifndef __ASSEMBLER__
+#include <stdint.h>
+extern uint64_t time_us_64(void);
+#endif
+#define configRUN_TIME_COUNTER_TYPE uint64_t
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() time_us_64()
+
 /* Co-routine related definitions. */
 #define configUSE_CO_ROUTINES 0
 #define configMAX_CO_ROUTINE_PRIORITIES 1
@@ -105,7 +128,9 @@
 #define configNUM_CORES 2
 #define configTICK_CORE 0
 #define configRUN_MULTIPLE_PRIORITIES 1
-#define configUSE_CORE_AFFINITY 0
+/* Afinidade explícita: DSP/Neopixel no core 1, jogo/IMU/rede no core 0
+ * (ver xTaskCreateAffinitySet no main e em local_report.c) */
+#define configUSE_CORE_AFFINITY 1
 
 /* RP2040 specific */
 #define configSUPPORT_PICO_SYNC_INTEROP 1
@@ -0,0 +1,194 @@
+/**
+ * @file biquad_bench.c
+ * @brief Testes no PC do pré-filtro do microfone (biquad.c): resposta em
+ *        frequência, rejeição do zumbido e custo por bloco
+ *
+ * Usa os mesmos coeficientes gerados no build (gen_biquad.py):
+ *   - resposta medida com tons sintéticos x resposta ideal (double)
+ *   - DC/offset do ADC removido e ruído de arredondamento na saída
+ *   - zumbido de 390 Hz mais forte que um tom de 1 kHz: o que o mic_dsp.c
+ *     detecta com e sem o filtro
+ *   - custo por bloco de SAMPLES amostras (ns e, em x86, ciclos)
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório):
+ *   python3 microfone/gen_biquad.py 20000 40 390 8 /tmp/mic_biquad_coefs.h
+ *   gcc -O2 -Imicrofone -I/tmp -o biquad_bench bench/biquad_bench.c microfone/biquad.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <complex.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "biquad.h"
+#include "mic_biquad_coefs.h"
+#include "mic_dsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define N_TOM     8192
+#define REPS      2000
+
+static int falhas = 0;
+
+static void verifica(int ok, const char *msg) {
+    if (!ok) { printf("  FALHOU: %s\n", msg); falhas++; }
+}
+
+static uint32_t rng_state = 777u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static uint16_t adc(double v) {
+    long x = lround(2048.0 + v);
+    if (x < 0) x = 0;
+    if (x > 4095) x = 4095;
+    return (uint16_t)x;
+}
+
+// |H(f)| ideal da cascata (coeficientes double)
+static double ganho_ideal_db(double f) {
+    double complex z1 = cexp(-I * 2 * M_PI * f / MIC_BIQUAD_FS);
+    double complex z2 = z1 * z1;
+    double complex h = 1;
+    for (int s = 0; s < MIC_BIQUAD_N_STAGES; s++) {
+        const double *c = mic_biquad_coefs_ref[s];
+        h *= (c[0] + c[1] * z1 + c[2] * z2) / (1 + c[3] * z1 + c[4] * z2);
+    }
+    return 20 * log10(cabs(h) + 1e-12);
+}
+
+// ganho medido: RMS da saída / RMS da entrada na segunda metade (regime)
+static double ganho_medido_db(double f, double amp) {
+    static uint16_t in[N_TOM], out[N_TOM];
+    biquad_cascade_t c;
+    biquad_cascade_init(&c, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+
+    for (int n = 0; n < N_TOM; n++) in[n] = adc(amp * sin(2 * M_PI * f * n / MIC_BIQUAD_FS));
+    for (int n = 0; n < N_TOM; n += SAMPLES) biquad_cascade_process_adc(&c, in + n, out + n, SAMPLES);
+
+    double ei = 0, eo = 0;
+    for (int n = N_TOM / 2; n < N_TOM; n++) {
+        ei += ((double)in[n] - 2048) * ((double)in[n] - 2048);
+        eo += ((double)out[n] - 2048) * ((double)out[n] - 2048);
+    }
+    return 10 * log10((eo + 1e-9) / ei);
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void) {
+    printf("filtro: %s (fs %d Hz, %d estágios)\n", MIC_BIQUAD_DESC, MIC_BIQUAD_FS, MIC_BIQUAD_N_STAGES);
+
+    // --- resposta em frequência ---
+    static const double freqs[] = { 20, 40, 80, 150, 200, 300, 370, 385, 390, 395, 410, 500, 1000, 3000, 8000 };
+    printf("\n  f (Hz)   medido (dB)   ideal (dB)\n");
+    for (unsigned i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        double f = freqs[i];
+        double m = ganho_medido_db(f, 1000.0);
+        double id = ganho_ideal_db(f);
+        printf("  %6.0f   %10.2f   %10.2f\n", f, m, id);
+
+        // faixa útil (fora do notch e acima do passa-altas): erro < 0,5 dB
+        if (f >= 150 && (f < 300 || f > 500)) verifica(fabs(m - id) < 0.5, "ganho fora do ideal na faixa útil");
+    }
+    verifica(ganho_medido_db(390, 1000.0) < -30.0, "notch de 390 Hz atenua menos de 30 dB");
+
+    // --- DC/offset e ruído de arredondamento ---
+    {
+        static uint16_t in[N_TOM], out[N_TOM];
+        biquad_cascade_t c;
+        biquad_cascade_init(&c, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+        for (int n = 0; n < N_TOM; n++) in[n] = (uint16_t)(2048 + 137);   // offset do microfone fora do centro
+        for (int n = 0; n < N_TOM; n += SAMPLES) biquad_cascade_process_adc(&c, in + n, out + n, SAMPLES);
+
+        double mean = 0, e2 = 0;
+        for (int n = N_TOM / 2; n < N_TOM; n++) mean += out[n];
+        mean /= N_TOM / 2;
+        for (int n = N_TOM / 2; n < N_TOM; n++) e2 += (out[n] - mean) * (out[n] - mean);
+        printf("\nDC de +137 LSB: saída média %.2f (2048 = centro), ruído %.3f LSB rms\n", mean, sqrt(e2 / (N_TOM / 2)));
+        verifica(fabs(mean - 2048) < 1.0, "DC não foi removido");
+        verifica(sqrt(e2 / (N_TOM / 2)) < 0.5, "ruído de arredondamento alto");
+    }
+
+    // --- zumbido forte + sinal de 1 kHz, pelo mic_dsp ---
+    {
+        if (!mic_dsp_init()) { fprintf(stderr, "mic_dsp_init falhou\n"); return 1; }
+
+        biquad_cascade_t c;
+        biquad_cascade_init(&c, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+
+        const int quadros = 64;
+        int agudo_sem = 0, agudo_com = 0;
+        static uint16_t in[SAMPLES], out[SAMPLES];
+        for (int q = 0; q < quadros; q++) {
+            for (int n = 0; n < SAMPLES; n++) {
+                double t = (double)(q * SAMPLES + n) / MIC_BIQUAD_FS;
+                in[n] = adc(600 * sin(2 * M_PI * 390 * t) + 150 * sin(2 * M_PI * 1000 * t) + 8 * (frand() - 0.5));
+            }
+            biquad_cascade_process_adc(&c, in, out, SAMPLES);
+            if (q < 4) continue;   // transiente inicial do filtro
+
+            mic_dsp_result_t r;
+            mic_dsp_analyze(in, &r);
+            if (r.sound_type == 3) agudo_sem++;
+            mic_dsp_analyze(out, &r);
+            if (r.sound_type == 3) agudo_com++;
+        }
+        printf("\nzumbido 390 Hz (600) + tom 1 kHz (150): agudo detectado sem filtro %d/%d, com filtro %d/%d\n",
+               agudo_sem, quadros - 4, agudo_com, quadros - 4);
+        verifica(agudo_com == quadros - 4, "tom de 1 kHz não detectado com o filtro");
+    }
+
+    // --- custo por bloco ---
+    {
+        static uint16_t in[SAMPLES], out[SAMPLES];
+        for (int n = 0; n < SAMPLES; n++) in[n] = adc(800 * sin(2 * M_PI * 440.0 * n / MIC_BIQUAD_FS) + 30 * (frand() - 0.5));
+
+        biquad_cascade_t c;
+        biquad_cascade_init(&c, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+        volatile uint32_t sink = 0;
+
+        double t0 = agora_ns();
+#if HAVE_RDTSC
+        uint64_t c0 = __rdtsc();
+#endif
+        for (int r = 0; r < REPS; r++) {
+            biquad_cascade_process_adc(&c, in, out, SAMPLES);
+            sink += out[r % SAMPLES];
+        }
+#if HAVE_RDTSC
+        uint64_t c1 = __rdtsc();
+#endif
+        double t1 = agora_ns();
+        (void)sink;
+
+        printf("\ncusto/bloco (%d amostras): %.0f ns", SAMPLES, (t1 - t0) / REPS);
+#if HAVE_RDTSC
+        printf(", %.0f ciclos (PC)", (double)(c1 - c0) / REPS);
+#endif
+        printf("\n");
+    }
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * @file decim_bench.c
+ * @brief Testes no PC do decimador CIC do microfone (decim.c)
+ *
+ * Compilado uma vez por fator (MIC_DECIM, o mesmo define do firmware):
+ *   - resposta medida com tons x fórmula do CIC (queda na banda útil)
+ *   - atenuação de um tom acima da nova Nyquist (aliasing)
+ *   - resolução: tons graves/médios aleatórios (50..580 Hz) decimados e
+ *     analisados pelo mic_dsp.c; erro médio/máximo da freq dominante
+ *   - custo por bloco do DMA (SAMPLES leituras do ADC)
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório), um binário por fator:
+ *   gcc -O2 -Imicrofone -DMIC_DECIM=4 -o decim4 bench/decim_bench.c microfone/decim.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "decim.h"
+#include "mic_dsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define N_TOM     (SAMPLES * MIC_DECIM * 16)
+#define N_TONS    200
+#define REPS      4000
+
+static int falhas = 0;
+
+static void verifica(int ok, const char *msg) {
+    if (!ok) { printf("  FALHOU: %s\n", msg); falhas++; }
+}
+
+static uint32_t rng_state = 4242u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static uint16_t adc(double v) {
+    long x = lround(2048.0 + v);
+    if (x < 0) x = 0;
+    if (x > 4095) x = 4095;
+    return (uint16_t)x;
+}
+
+static double cic_ideal_db(double f) {
+    if (MIC_DECIM == 1) return 0.0;
+    double x = M_PI * f / MIC_ADC_RATE;
+    if (x < 1e-12) return 0.0;
+    double h = sin(x * MIC_DECIM) / (MIC_DECIM * sin(x));
+    return 20.0 * DECIM_CIC_ORDER * log10(fabs(h) + 1e-12);
+}
+
+// ganho medido: RMS de saída / RMS de entrada (segunda metade, regime)
+static double cic_medido_db(double f, double amp) {
+    static uint16_t in[N_TOM], out[N_TOM];
+    decim_cic_t d;
+    decim_cic_init(&d, MIC_DECIM);
+
+    for (int n = 0; n < N_TOM; n++) in[n] = adc(amp * sin(2 * M_PI * f * n / MIC_ADC_RATE + 0.3));
+    int m = decim_cic_process_adc(&d, in, N_TOM, out);
+
+    double ei = 0, eo = 0;
+    for (int n = N_TOM / 2; n < N_TOM; n++) ei += ((double)in[n] - 2048) * ((double)in[n] - 2048);
+    for (int n = m / 2; n < m; n++) eo += ((double)out[n] - 2048) * ((double)out[n] - 2048);
+    return 10 * log10((eo / (m - m / 2) + 1e-9) / (ei / (N_TOM - N_TOM / 2)));
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void) {
+    printf("decimação /%d: ADC %d Hz -> análise %d Hz, bin %.1f Hz (CIC ordem %d)\n",
+           MIC_DECIM, MIC_ADC_RATE, SAMPLE_RATE, (double)SAMPLE_RATE / SAMPLES, DECIM_CIC_ORDER);
+
+    // --- resposta na banda útil ---
+    printf("\n  f (Hz)   medido (dB)   CIC (dB)\n");
+    static const double freqs[] = { 100, 200, 400, 600, 1000, 1500, 2000, 3000, 4000 };
+    for (unsigned i = 0; i < sizeof(freqs) / sizeof(freqs[0]); i++) {
+        double f = freqs[i];
+        if (f >= SAMPLE_RATE / 2.0) break;
+        double m = cic_medido_db(f, 1000.0);
+        double id = cic_ideal_db(f);
+        printf("  %6.0f   %10.2f   %9.2f\n", f, m, id);
+        verifica(fabs(m - id) < 0.3, "resposta fora da fórmula do CIC");
+    }
+
+    // --- aliasing: tom logo acima da nova Nyquist ---
+    if (MIC_DECIM > 1) {
+        double f = SAMPLE_RATE - 1000.0;   // dobra para 1 kHz
+        if (f > SAMPLE_RATE / 2.0) {
+            double m = cic_medido_db(f, 1000.0);
+            printf("\ntom de %.0f Hz (dobra em 1000 Hz): %.1f dB\n", f, m);
+        }
+    }
+
+    // --- resolução: tons de 50 a 580 Hz pelo mic_dsp ---
+    {
+        if (!mic_dsp_init()) { fprintf(stderr, "mic_dsp_init falhou\n"); return 1; }
+
+        static uint16_t in[SAMPLES * MIC_DECIM * 2], quadro[SAMPLES * 2 + 1];
+        double err_sum = 0, err_max = 0;
+
+        for (int t = 0; t < N_TONS; t++) {
+            double f = 50.0 + frand() * 530.0;
+            double ph = frand() * 2 * M_PI;
+            for (int n = 0; n < SAMPLES * MIC_DECIM * 2; n++) {
+                in[n] = adc(700 * sin(2 * M_PI * f * n / MIC_ADC_RATE + ph) + 6 * (frand() - 0.5));
+            }
+
+            decim_cic_t d;
+            decim_cic_init(&d, MIC_DECIM);
+            int m = decim_cic_process_adc(&d, in, SAMPLES * MIC_DECIM * 2, quadro);
+            if (m < 2 * SAMPLES) { printf("decimador devolveu %d amostras\n", m); return 1; }
+
+            // segundo quadro: sem o transiente inicial do CIC
+            mic_dsp_result_t r;
+            mic_dsp_analyze(quadro + SAMPLES, &r);
+            double e = fabs(r.freq_hz - f);
+            err_sum += e;
+            if (e > err_max) err_max = e;
+        }
+
+        double bin = (double)SAMPLE_RATE / SAMPLES;
+        printf("\nfreq dominante (50..580 Hz): erro médio %.1f Hz, máximo %.1f Hz (bin %.1f Hz)\n",
+               err_sum / N_TONS, err_max, bin);
+        // meio bin + folga: nos tons mais graves o vazamento da freq negativa
+        // (janela retangular) às vezes puxa o pico para o bin vizinho
+        verifica(err_max <= bin * 0.6, "erro de frequência maior que 0,6 bin");
+    }
+
+    // --- custo por bloco do DMA ---
+    {
+        static uint16_t in[SAMPLES], out[SAMPLES + 1];
+        for (int n = 0; n < SAMPLES; n++) in[n] = adc(800 * sin(2 * M_PI * 300.0 * n / MIC_ADC_RATE) + 30 * (frand() - 0.5));
+
+        decim_cic_t d;
+        decim_cic_init(&d, MIC_DECIM);
+        volatile uint32_t sink = 0;
+
+        double t0 = agora_ns();
+#if HAVE_RDTSC
+        uint64_t c0 = __rdtsc();
+#endif
+        for (int r = 0; r < REPS; r++) {
+            int m = decim_cic_process_adc(&d, in, SAMPLES, out);
+            sink += out[m - 1];
+        }
+#if HAVE_RDTSC
+        uint64_t c1 = __rdtsc();
+#endif
+        double t1 = agora_ns();
+        (void)sink;
+
+        printf("\ncusto/bloco (%d leituras do ADC): %.0f ns", SAMPLES, (t1 - t0) / REPS);
+#if HAVE_RDTSC
+        printf(", %.0f ciclos (PC)", (double)(c1 - c0) / REPS);
+#endif
+        printf("\n");
+    }
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
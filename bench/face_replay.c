@@ -0,0 +1,303 @@
+/**
+ * @file face_replay.c
+ * @brief Replay determinístico de traces do MPU6050 no detector de face (PC)
+ *
+ * Alimenta traces gravados (CSV, ver traces/gen_traces.py) no mesmo código
+ * usado pelo firmware (face_detect.c) e em detectores alternativos, e mede:
+ *   - latência por transição (início da face no truth -> trava estável)
+ *   - travas falsas (saída estável muda para uma face diferente do truth;
+ *     durante o giro, travar na face de destino não conta como falsa)
+ *   - travas perdidas (face do truth que o detector nunca travou)
+ *   - custo por amostra (ns e, em x86, ciclos via rdtsc)
+ *
+ * Compilar (na raiz do repositório):
+ *   gcc -O2 -I. -o face_replay bench/face_replay.c face_detect.c -lm
+ *
+ * Uso:
+ *   ./face_replay [-d detector] [-v] [--no-timing] trace.csv [...]
+ *
+ * Com --no-timing a saída é determinística e pode ser comparada com
+ * bench/traces/baseline.txt para acompanhar regressões.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "face_detect.h"
+
+// ==========================
+// Trace em memória
+// ==========================
+typedef struct {
+    uint64_t t_us;
+    int16_t  accel[3];
+    int16_t  gyro[3];
+    face_t   truth;
+} amostra_t;
+
+typedef struct {
+    amostra_t *v;
+    size_t     n;
+    size_t     cap;
+} trace_t;
+
+static face_t face_from_str(const char *s) {
+    if (strcmp(s, "FRENTE") == 0) return FACE_FRENTE;
+    if (strcmp(s, "TRAS") == 0)   return FACE_TRAS;
+    if (strcmp(s, "ESQ") == 0)    return FACE_ESQ;
+    if (strcmp(s, "DIR") == 0)    return FACE_DIR;
+    if (strcmp(s, "BASE") == 0)   return FACE_BASE;
+    if (strcmp(s, "TOPO") == 0)   return FACE_TOPO;
+    return FACE_MOVENDO;
+}
+
+static bool trace_load(const char *path, trace_t *tr) {
+    FILE *f = fopen(path, "r");
+    if (!f) return false;
+
+    memset(tr, 0, sizeof(*tr));
+    char line[160];
+    bool header = true;
+
+    while (fgets(line, sizeof(line), f)) {
+        if (header) { header = false; continue; }
+
+        unsigned long long t;
+        int a0, a1, a2, g0, g1, g2;
+        char truth[16];
+        if (sscanf(line, "%llu,%d,%d,%d,%d,%d,%d,%15s", &t, &a0, &a1, &a2, &g0, &g1, &g2, truth) != 8) continue;
+
+        if (tr->n == tr->cap) {
+            tr->cap = tr->cap ? tr->cap * 2 : 1024;
+            tr->v = (amostra_t *)realloc(tr->v, tr->cap * sizeof(amostra_t));
+            if (!tr->v) { fclose(f); return false; }
+        }
+        amostra_t *s = &tr->v[tr->n++];
+        s->t_us = (uint64_t)t;
+        s->accel[0] = (int16_t)a0; s->accel[1] = (int16_t)a1; s->accel[2] = (int16_t)a2;
+        s->gyro[0]  = (int16_t)g0; s->gyro[1]  = (int16_t)g1; s->gyro[2]  = (int16_t)g2;
+        s->truth = face_from_str(truth);
+    }
+
+    fclose(f);
+    return tr->n > 0;
+}
+
+// ==========================
+// Detectores
+// ==========================
+// Para comparar um detector novo: implementar reset/amostra e
+// acrescentar uma entrada em DETECTORES[].
+typedef struct {
+    const char *nome;
+    void   (*reset)(void);
+    face_t (*amostra)(const int16_t accel[3], const int16_t gyro[3]);
+} detector_t;
+
+// firmware atual: detectar_face_base_raw() + atualizar_face_estavel()
+static face_filtro_t g_base;
+
+static void base_reset(void) { face_filtro_reset(&g_base); }
+
+static face_t base_amostra(const int16_t accel[3], const int16_t gyro[3]) {
+    (void)gyro;
+    return face_filtro_atualizar(&g_base, face_classificar(accel));
+}
+
+static const detector_t DETECTORES[] = {
+    { "base", base_reset, base_amostra },
+};
+#define N_DETECTORES (sizeof(DETECTORES) / sizeof(DETECTORES[0]))
+
+// ==========================
+// Métricas
+// ==========================
+typedef struct {
+    int      transicoes;
+    int      travadas;
+    int      perdidas;
+    int      falsas;
+    uint64_t lat_soma_us;
+    uint64_t lat_max_us;
+} metricas_t;
+
+static void replay(const detector_t *d, const trace_t *tr, bool verbose, metricas_t *m) {
+    memset(m, 0, sizeof(*m));
+    d->reset();
+
+    face_t prev_truth = FACE_MOVENDO;
+    face_t prev_out   = FACE_MOVENDO;
+
+    // face de destino de cada giro (próxima face parada do truth)
+    face_t *destino = (face_t *)malloc(tr->n * sizeof(face_t));
+    if (!destino) return;
+    face_t prox = FACE_MOVENDO;
+    for (size_t i = tr->n; i-- > 0;) {
+        if (tr->v[i].truth != FACE_MOVENDO) prox = tr->v[i].truth;
+        destino[i] = prox;
+    }
+
+    // segmento atual do truth (face parada)
+    bool     seg_ativo = false;
+    bool     seg_travou = false;
+    face_t   seg_face = FACE_MOVENDO;
+    uint64_t seg_t0 = 0;
+
+    for (size_t i = 0; i <= tr->n; i++) {
+        bool fim = (i == tr->n);
+        const amostra_t *s = fim ? NULL : &tr->v[i];
+        face_t truth = fim ? FACE_MOVENDO : s->truth;
+
+        // fecha segmento anterior
+        if (seg_ativo && (fim || truth != seg_face)) {
+            if (!seg_travou) {
+                m->perdidas++;
+                if (verbose) printf("  t=%8.3fs %-6s PERDIDA\n", seg_t0 / 1e6, face_nome(seg_face));
+            }
+            seg_ativo = false;
+        }
+        if (fim) break;
+
+        // abre segmento novo
+        if (truth != FACE_MOVENDO && truth != prev_truth) {
+            seg_ativo = true;
+            seg_travou = false;
+            seg_face = truth;
+            seg_t0 = s->t_us;
+            m->transicoes++;
+        }
+        prev_truth = truth;
+
+        face_t out = d->amostra(s->accel, s->gyro);
+
+        if (seg_ativo && !seg_travou && out == seg_face) {
+            uint64_t lat = s->t_us - seg_t0;
+            seg_travou = true;
+            m->travadas++;
+            m->lat_soma_us += lat;
+            if (lat > m->lat_max_us) m->lat_max_us = lat;
+            if (verbose) printf("  t=%8.3fs %-6s lat=%4u ms\n", seg_t0 / 1e6, face_nome(seg_face), (unsigned)(lat / 1000));
+        }
+
+        bool esperada = (out == truth) || (truth == FACE_MOVENDO && out == destino[i]);
+        if (out != prev_out && out != FACE_MOVENDO && !esperada) {
+            m->falsas++;
+            if (verbose) printf("  t=%8.3fs FALSA: saida=%s truth=%s\n", s->t_us / 1e6, face_nome(out), face_nome(truth));
+        }
+        prev_out = out;
+    }
+
+    free(destino);
+}
+
+// custo por amostra: repete o trace inteiro várias vezes
+static void medir_custo(const detector_t *d, const trace_t *tr, int reps, double *ns_por_amostra, double *ciclos_por_amostra) {
+    volatile int sink = 0;
+    struct timespec t0, t1;
+
+    d->reset();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+#if HAVE_RDTSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (int r = 0; r < reps; r++) {
+        for (size_t i = 0; i < tr->n; i++) {
+            sink += (int)d->amostra(tr->v[i].accel, tr->v[i].gyro);
+        }
+    }
+#if HAVE_RDTSC
+    uint64_t c1 = __rdtsc();
+#endif
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+
+    double total = (double)reps * (double)tr->n;
+    double ns = (t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec);
+    *ns_por_amostra = ns / total;
+#if HAVE_RDTSC
+    *ciclos_por_amostra = (double)(c1 - c0) / total;
+#else
+    *ciclos_por_amostra = 0.0;
+#endif
+}
+
+static const char* base_name(const char *path) {
+    const char *b = strrchr(path, '/');
+    const char *w = strrchr(path, '\\');
+    if (w && (!b || w > b)) b = w;
+    return b ? b + 1 : path;
+}
+
+static void usage(void) {
+    fprintf(stderr, "uso: face_replay [-d detector] [-v] [--no-timing] trace.csv [...]\n");
+    fprintf(stderr, "detectores:");
+    for (size_t i = 0; i < N_DETECTORES; i++) fprintf(stderr, " %s", DETECTORES[i].nome);
+    fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+    const char *det_nome = NULL;
+    bool verbose = false;
+    bool timing = true;
+    int first = 1;
+
+    for (; first < argc; first++) {
+        if (strcmp(argv[first], "-d") == 0 && first + 1 < argc) { det_nome = argv[++first]; continue; }
+        if (strcmp(argv[first], "-v") == 0) { verbose = true; continue; }
+        if (strcmp(argv[first], "--no-timing") == 0) { timing = false; continue; }
+        break;
+    }
+    if (first >= argc) { usage(); return 2; }
+
+    int falhas = 0;
+
+    for (size_t di = 0; di < N_DETECTORES; di++) {
+        const detector_t *d = &DETECTORES[di];
+        if (det_nome && strcmp(det_nome, d->nome) != 0) continue;
+
+        printf("detector: %s\n", d->nome);
+        printf("%-22s %5s %5s %5s %5s %8s %8s", "trace", "trans", "trav", "perd", "falsa", "lat_avg", "lat_max");
+        if (timing) printf(" %9s %9s", "ns/amost", "cic/amost");
+        printf("\n");
+
+        for (int a = first; a < argc; a++) {
+            trace_t tr;
+            if (!trace_load(argv[a], &tr)) {
+                fprintf(stderr, "erro lendo %s\n", argv[a]);
+                falhas++;
+                continue;
+            }
+
+            metricas_t m;
+            if (verbose) printf("%s:\n", base_name(argv[a]));
+            replay(d, &tr, verbose, &m);
+
+            unsigned lat_avg = m.travadas ? (unsigned)(m.lat_soma_us / m.travadas / 1000) : 0;
+            printf("%-22s %5d %5d %5d %5d %6u ms %6u ms",
+                   base_name(argv[a]), m.transicoes, m.travadas, m.perdidas, m.falsas,
+                   lat_avg, (unsigned)(m.lat_max_us / 1000));
+
+            if (timing) {
+                double ns, cyc;
+                medir_custo(d, &tr, 2000, &ns, &cyc);
+                printf(" %9.1f %9.1f", ns, cyc);
+            }
+            printf("\n");
+            free(tr.v);
+        }
+        printf("\n");
+    }
+
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,364 @@
+/**
+ * @file json_bench.c
+ * @brief Testes no PC do json_writer.c contra o snprintf que montava a
+ *        telemetria do MQTT
+ *
+ * Snapshots sintéticos com as 17 chaves da telemetria (mic variado, nomes
+ * de usuário com e sem caracteres especiais):
+ *   - custo por snapshot: o snprintf único com %.1f/%.3f/%.4f do
+ *     cubo_data_to_json_callback antigo (+ o memset de 512 B que vinha
+ *     antes) x o json_writer com ponto fixo (ns e, em x86, ciclos)
+ *   - mesma saída: chave a chave, igual ou no máximo 1 no último dígito
+ *     (o %.Nf arredonda o valor exato do float; o jw_fix arredonda em
+ *     float), e JSON válido sempre (o snprintf quebra com aspas no nome)
+ *   - casos de borda: escape, NaN/inf, negativos, u64/i64, buffer justo
+ *     (nunca escreve além de cap)
+ *
+ * No alvo o hot_bench (cmake -DHOT_BENCH=ON) mede os mesmos dois caminhos
+ * no M0+, onde o %f em soft-float pesa bem mais que no PC.
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório):
+ *   gcc -O2 -I. -o json_bench bench/json_bench.c json_writer.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "json_writer.h"
+
+#define N_SNAP  2000
+#define REPS    50
+#define BUF     512     // BUFFER_SIZE do mqtt.h
+
+static int falhas = 0;
+
+static void verifica(int ok, const char *msg) {
+    if (!ok) { printf("  FALHOU: %s\n", msg); falhas++; }
+}
+
+static uint32_t rng_state = 2024u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (double)t.tv_sec * 1e9 + (double)t.tv_nsec;
+}
+
+// ============================
+// Snapshot da telemetria (os campos do cubo_data_to_json_callback)
+// ============================
+typedef struct {
+    int      estado;
+    const char *user, *modo, *alvo, *face, *info;
+    float    mic_freq, mic_int;
+    unsigned mic_type;
+    float    mic_rms, mic_cent, mic_flat, mic_zcr;
+    unsigned ok_total, err_total, last_ms, avg_ms;
+} snap_t;
+
+static const char *USERS[]  = { "", "Davi", "Ana Maria", "joão", "x\"y", "a\\b", "tab\tnome" };
+static const char *MODOS[]  = { "MENU", "PRONTO", "NIVEL 1", "MEMORIA", "RAPIDO" };
+static const char *FACES[]  = { "MOV", "FRENTE", "TRAS", "ESQ", "DIR", "BASE", "TOPO" };
+
+static void gerar(snap_t *s, int i) {
+    s->estado = i & 1;
+    s->user = USERS[i % 7];
+    s->modo = MODOS[i % 5];
+    s->alvo = FACES[(i / 3) % 7];
+    s->face = FACES[(i / 5) % 7];
+    s->info = (i % 4) ? "OK:12 ER:3" : "-";
+    s->mic_freq = (frand() < 0.3) ? 0.0f : (float)(80.0 + frand() * 3900.0);
+    s->mic_int  = (float)frand();
+    s->mic_type = (unsigned)(frand() * 4.0);
+    s->mic_rms  = (float)(frand() * 0.2);
+    s->mic_cent = (float)(frand() * 6000.0);
+    s->mic_flat = (float)frand();
+    s->mic_zcr  = (float)(frand() * 0.5);
+    s->ok_total = (unsigned)(frand() * 200.0);
+    s->err_total = (unsigned)(frand() * 50.0);
+    s->last_ms = (unsigned)(frand() * 5000.0);
+    s->avg_ms  = (unsigned)(frand() * 3000.0);
+}
+
+// o caminho antigo, como estava (memset do buffer + um snprintf)
+static size_t json_snprintf(const snap_t *s, char *buffer, size_t buffer_size) {
+    memset(buffer, 0, buffer_size);
+    int n = snprintf(buffer, buffer_size,
+        "{"
+        "\"estado\":%d,"
+        "\"user\":\"%s\","
+        "\"modo\":\"%s\","
+        "\"alvo\":\"%s\","
+        "\"face\":\"%s\","
+        "\"info\":\"%s\","
+        "\"mic_freq\":%.1f,"
+        "\"mic_int\":%.3f,"
+        "\"mic_type\":%u,"
+        "\"mic_rms\":%.4f,"
+        "\"mic_cent\":%.0f,"
+        "\"mic_flat\":%.3f,"
+        "\"mic_zcr\":%.3f,"
+        "\"ok_total\":%u,"
+        "\"err_total\":%u,"
+        "\"last_ms\":%u,"
+        "\"avg_ms\":%u"
+        "}",
+        s->estado, s->user, s->modo, s->alvo, s->face, s->info,
+        s->mic_freq, s->mic_int, s->mic_type,
+        s->mic_rms, s->mic_cent, s->mic_flat, s->mic_zcr,
+        s->ok_total, s->err_total, s->last_ms, s->avg_ms);
+    return (n > 0) ? (size_t)n : 0;
+}
+
+static size_t json_jw(const snap_t *s, char *buffer, size_t buffer_size) {
+    jw_t w;
+    jw_init(&w, buffer, buffer_size);
+    jw_obj_begin(&w);
+    jw_key(&w, "estado");    jw_i32(&w, s->estado);
+    jw_key(&w, "user");      jw_str(&w, s->user);
+    jw_key(&w, "modo");      jw_str(&w, s->modo);
+    jw_key(&w, "alvo");      jw_str(&w, s->alvo);
+    jw_key(&w, "face");      jw_str(&w, s->face);
+    jw_key(&w, "info");      jw_str(&w, s->info);
+    jw_key(&w, "mic_freq");  jw_fix(&w, s->mic_freq, 1);
+    jw_key(&w, "mic_int");   jw_fix(&w, s->mic_int, 3);
+    jw_key(&w, "mic_type");  jw_u32(&w, s->mic_type);
+    jw_key(&w, "mic_rms");   jw_fix(&w, s->mic_rms, 4);
+    jw_key(&w, "mic_cent");  jw_fix(&w, s->mic_cent, 0);
+    jw_key(&w, "mic_flat");  jw_fix(&w, s->mic_flat, 3);
+    jw_key(&w, "mic_zcr");   jw_fix(&w, s->mic_zcr, 3);
+    jw_key(&w, "ok_total");  jw_u32(&w, s->ok_total);
+    jw_key(&w, "err_total"); jw_u32(&w, s->err_total);
+    jw_key(&w, "last_ms");   jw_u32(&w, s->last_ms);
+    jw_key(&w, "avg_ms");    jw_u32(&w, s->avg_ms);
+    jw_obj_end(&w);
+    return jw_finish(&w);
+}
+
+// ============================
+// Validador de JSON (descida recursiva, só para conferir a saída)
+// ============================
+static const char *vj_valor(const char *p);
+
+static const char *vj_ws(const char *p) {
+    while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+    return p;
+}
+
+static const char *vj_str(const char *p) {
+    if (*p++ != '"') return NULL;
+    while (*p != '"') {
+        if ((unsigned char)*p < 0x20) return NULL;
+        if (*p == '\\') {
+            p++;
+            if (*p == 'u') {
+                for (int i = 1; i <= 4; i++) if (!strchr("0123456789abcdefABCDEF", p[i]) || !p[i]) return NULL;
+                p += 4;
+            } else if (!*p || !strchr("\"\\/bfnrt", *p)) {
+                return NULL;
+            }
+        }
+        p++;
+    }
+    return p + 1;
+}
+
+static const char *vj_num(const char *p) {
+    if (*p == '-') p++;
+    if (*p == '0') p++;
+    else if (*p >= '1' && *p <= '9') while (*p >= '0' && *p <= '9') p++;
+    else return NULL;
+    if (*p == '.') {
+        p++;
+        if (!(*p >= '0' && *p <= '9')) return NULL;
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    return p;
+}
+
+static const char *vj_valor(const char *p) {
+    p = vj_ws(p);
+    if (*p == '"') return vj_str(p);
+    if (*p == '{' || *p == '[') {
+        char fim = (*p == '{') ? '}' : ']';
+        p = vj_ws(p + 1);
+        if (*p == fim) return p + 1;
+        for (;;) {
+            if (fim == '}') {
+                p = vj_str(vj_ws(p));
+                if (!p) return NULL;
+                p = vj_ws(p);
+                if (*p++ != ':') return NULL;
+            }
+            p = vj_valor(p);
+            if (!p) return NULL;
+            p = vj_ws(p);
+            if (*p == fim) return p + 1;
+            if (*p++ != ',') return NULL;
+        }
+    }
+    if (!strncmp(p, "true", 4))  return p + 4;
+    if (!strncmp(p, "false", 5)) return p + 5;
+    if (!strncmp(p, "null", 4))  return p + 4;
+    return vj_num(p);
+}
+
+static int json_valido(const char *s) {
+    const char *p = vj_valor(s);
+    return p && *vj_ws(p) == '\0';
+}
+
+// ============================
+// Comparação chave a chave (mesma ordem nos dois)
+// ============================
+// 0 = igual, 1 = diferença no último dígito, 2 = diferente
+static int comparar(const char *a, const char *b) {
+    if (!strcmp(a, b)) return 0;
+    int pior = 0;
+    while (*a && *b) {
+        const char *fa = strpbrk(a, ",}"), *fb = strpbrk(b, ",}");
+        if (!fa || !fb) return 2;
+        size_t na = (size_t)(fa - a), nb = (size_t)(fb - b);
+        if (na != nb || memcmp(a, b, na)) {
+            const char *ca = memchr(a, ':', na), *cb = memchr(b, ':', nb);
+            if (!ca || !cb || (ca - a) != (cb - b) || memcmp(a, b, (size_t)(ca - a))) return 2;
+            double va = strtod(ca + 1, NULL), vb = strtod(cb + 1, NULL);
+            const char *pt = memchr(ca, '.', (size_t)(fa - ca));
+            double ulp = pt ? pow(10.0, -(double)(fa - pt - 1)) : 1.0;
+            if (fabs(va - vb) > ulp * 1.001) return 2;
+            pior = 1;
+        }
+        a = fa + 1;
+        b = fb + 1;
+    }
+    return (*a || *b) ? 2 : pior;
+}
+
+// ============================
+// Casos de borda
+// ============================
+static void bordas(void) {
+    char buf[128];
+    jw_t w;
+
+    printf("bordas:\n");
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_obj_begin(&w);
+    jw_key(&w, "u"); jw_str(&w, "a\"b\\c\n\x01é");
+    jw_obj_end(&w);
+    jw_finish(&w);
+    verifica(!strcmp(buf, "{\"u\":\"a\\\"b\\\\c\\n\\u0001é\"}"), "escape");
+    verifica(json_valido(buf), "escape = JSON válido");
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_arr_begin(&w);
+    jw_fix(&w, NAN, 2); jw_fix(&w, INFINITY, 1); jw_fix(&w, -0.0001f, 3);
+    jw_fix(&w, -2.5f, 1); jw_fix(&w, 0.9996f, 3); jw_fix(&w, 8589934592.0f, 0);
+    jw_arr_end(&w);
+    jw_finish(&w);
+    verifica(!strcmp(buf, "[null,null,0.000,-2.5,1.000,8589934592]"), "jw_fix: NaN/inf/negativo/arredonda/u64");
+    printf("  jw_fix    : %s\n", buf);
+
+    jw_init(&w, buf, sizeof(buf));
+    jw_arr_begin(&w);
+    jw_i64(&w, 1760000000123LL); jw_i64(&w, INT64_MIN); jw_u32(&w, UINT32_MAX); jw_i32(&w, INT32_MIN);
+    jw_bool(&w, true); jw_null(&w);
+    jw_arr_end(&w);
+    jw_finish(&w);
+    char ref[128];
+    snprintf(ref, sizeof(ref), "[%lld,%lld,%u,%d,true,null]",
+             1760000000123LL, (long long)INT64_MIN, UINT32_MAX, INT32_MIN);
+    verifica(!strcmp(buf, ref), "inteiros = printf");
+    printf("  inteiros  : %s\n", buf);
+
+    // buffer justo: de 0 a 40 bytes, nunca passa de cap e só dá certo com cap > len
+    snap_t s;
+    gerar(&s, 1);
+    char cheio[BUF];
+    size_t n = json_jw(&s, cheio, sizeof(cheio));
+    int ok = 1;
+    for (size_t cap = 0; cap <= n + 1; cap++) {
+        char b2[BUF + 8];
+        memset(b2, 0x5A, sizeof(b2));
+        size_t m = json_jw(&s, b2, cap);
+        for (size_t i = cap; i < sizeof(b2); i++) if ((uint8_t)b2[i] != 0x5A) ok = 0;
+        if ((cap > n) != (m == n)) ok = 0;
+    }
+    verifica(ok, "limite: nunca escreve além de cap e só falha quando não cabe");
+    printf("  limite    : %zu B, testado com cap 0..%zu\n", n, n + 1);
+}
+
+int main(void) {
+    static snap_t snaps[N_SNAP];
+    static char a[BUF], b[BUF];
+
+    for (int i = 0; i < N_SNAP; i++) gerar(&snaps[i], i);
+
+    bordas();
+
+    // saída: mesma coisa, e JSON válido
+    int iguais = 0, ultimo = 0, difer = 0, snp_inval = 0, jw_inval = 0;
+    size_t bytes_a = 0, bytes_b = 0;
+    for (int i = 0; i < N_SNAP; i++) {
+        bytes_a += json_snprintf(&snaps[i], a, sizeof(a));
+        bytes_b += json_jw(&snaps[i], b, sizeof(b));
+        if (!json_valido(b)) jw_inval++;
+        if (!json_valido(a)) { snp_inval++; continue; }   // aspas/controle no nome
+        int c = comparar(a, b);
+        if (c == 0) iguais++;
+        else if (c == 1) ultimo++;
+        else { difer++; if (difer <= 3) printf("  snprintf: %s\n  jw      : %s\n", a, b); }
+    }
+    printf("saída      : %d snapshots, %d iguais, %d com 1 no último dígito, %d diferentes\n",
+           N_SNAP, iguais, ultimo, difer);
+    printf("JSON válido: json_writer %d/%d, snprintf %d/%d (nomes com aspas/tab quebram)\n",
+           N_SNAP - jw_inval, N_SNAP, N_SNAP - snp_inval, N_SNAP);
+    printf("bytes      : %.1f por snapshot (iguais fora o escape)\n", (double)bytes_b / N_SNAP);
+    verifica(difer == 0, "saída diferente do snprintf");
+    verifica(jw_inval == 0, "json_writer gerou JSON inválido");
+
+    // tempo
+    volatile size_t sink = 0;
+    const char *nomes[2] = { "snprintf + memset", "json_writer" };
+    double ns[2];
+    for (int k = 0; k < 2; k++) {
+        double t0 = agora_ns();
+#if HAVE_RDTSC
+        uint64_t c0 = __rdtsc();
+#endif
+        for (int r = 0; r < REPS; r++) {
+            for (int i = 0; i < N_SNAP; i++) {
+                sink += k ? json_jw(&snaps[i], b, sizeof(b)) : json_snprintf(&snaps[i], a, sizeof(a));
+            }
+        }
+        ns[k] = (agora_ns() - t0) / ((double)REPS * N_SNAP);
+        printf("%-18s: %.0f ns/snapshot", nomes[k], ns[k]);
+#if HAVE_RDTSC
+        printf(", %.0f ciclos (PC)", (double)(__rdtsc() - c0) / ((double)REPS * N_SNAP));
+#endif
+        printf("\n");
+    }
+    printf("ganho      : %.1fx (PC; no M0+ o %%f é soft-float, ver hot_bench)\n", ns[0] / ns[1]);
+    (void)sink;
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,412 @@
+/**
+ * @file lr_outbox_sim.c
+ * @brief Testes no PC do outbox na flash do local_report (lr_outbox.c)
+ *        sobre uma flash NOR simulada
+ *
+ * A flash simulada segue as regras da real: apagar deixa o setor em 0xFF,
+ * gravar só baixa bits (AND) e só em página alinhada; conta gravações e
+ * apagamentos por setor e soma o tempo típico do W25Q16JV (página 0,4 ms,
+ * setor 45 ms) em que os dois núcleos ficam parados no Pico.
+ *
+ * Cenários (eventos de verdade, codificados com lr_proto.c):
+ *   - online: a janela consome logo; a flash não pode ser tocada
+ *   - offline: rajada de eventos sem rede, depois replay completo: vazão,
+ *     amplificação de escrita, tempo parado, taxa de replay
+ *   - anel cheio: escreve mais do que cabe sem ler; o que sobra sai em
+ *     ordem e lidos + perdidos = escritos
+ *   - quedas de energia: operações aleatórias com reboot no meio (inclusive
+ *     com a página/setor gravado pela metade); nada que chegou à flash se
+ *     perde, nada sai corrompido ou fora de ordem, e só se repete o que
+ *     foi entregue depois do último cursor gravado
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório):
+ *   gcc -O2 -I. -o lr_outbox_sim bench/lr_outbox_sim.c lr_outbox.c lr_proto.c
+ *   gcc -O2 -I. -DLR_OB_PAGE=1024 -o lr_outbox_sim_1k bench/lr_outbox_sim.c lr_outbox.c lr_proto.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+#include "lr_outbox.h"
+#include "lr_proto.h"
+
+#define REGIAO       (256u * 1024u)   // igual ao firmware
+#define T_PROG_US    400u
+#define T_ERASE_US   45000u
+#define JANELA       24               // LR_REL_WINDOW
+
+static int falhas = 0;
+#define CHECK(c, ...) do { if (!(c)) { printf("  FALHA: " __VA_ARGS__); printf("\n"); falhas++; } } while (0)
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint32_t rnd_state = 2024;
+static uint32_t rnd(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+// ============================
+// Flash simulada
+// ============================
+typedef struct {
+    uint8_t  mem[REGIAO];
+    uint32_t size;
+    uint32_t progs, erases;
+    uint32_t desgaste[REGIAO / LR_OB_SECTOR];
+    uint64_t parado_us;
+    int      queda;     // >0: conta operações; ao chegar a 0 grava pela metade e "cai"
+    int      caiu;
+} flash_sim_t;
+
+static bool sim_erase(void *ctx, uint32_t off) {
+    flash_sim_t *f = ctx;
+    if (f->caiu || off % LR_OB_SECTOR || off >= f->size) return false;
+    if (f->queda > 0 && --f->queda == 0) {
+        memset(f->mem + off, 0xFF, LR_OB_SECTOR / 2);   // apagou metade
+        f->caiu = 1;
+        return false;
+    }
+    memset(f->mem + off, 0xFF, LR_OB_SECTOR);
+    f->erases++;
+    f->desgaste[off / LR_OB_SECTOR]++;
+    f->parado_us += T_ERASE_US;
+    return true;
+}
+
+static bool sim_prog(void *ctx, uint32_t off, const uint8_t *page) {
+    flash_sim_t *f = ctx;
+    if (f->caiu || off % LR_OB_PAGE || off >= f->size) return false;
+    uint32_t n = LR_OB_PAGE;
+    if (f->queda > 0 && --f->queda == 0) {
+        n = 1 + rnd() % (LR_OB_PAGE - 1);   // gravou só o começo
+        f->caiu = 1;
+    }
+    for (uint32_t i = 0; i < n; i++) f->mem[off + i] &= page[i];
+    if (f->caiu) return false;
+    f->progs++;
+    f->parado_us += (uint64_t)T_PROG_US * (LR_OB_PAGE / 256);
+    return true;
+}
+
+static void sim_init(flash_sim_t *f, uint32_t size) {
+    memset(f, 0, sizeof(*f));
+    memset(f->mem, 0xFF, sizeof(f->mem));
+    f->size = size;
+}
+
+static lr_ob_flash_t sim_flash(flash_sim_t *f) {
+    lr_ob_flash_t fl = { f->mem, f->size, f, sim_erase, sim_prog };
+    return fl;
+}
+
+// ============================
+// Registros: evento real com um id global no campo seq (o firmware
+// carimba o seq só ao entrar na janela)
+// ============================
+static uint8_t gerar(uint32_t gid, uint8_t *buf) {
+    static const char *users[] = { "", "Ana", "Davi", "Maria Eduarda", "joao.pedro.silva" };
+    lr_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.tipo = (uint8_t)(1 + gid % 4);
+    ev.modo = LR_MODO_MEMORIA;
+    ev.device = 0xC0B0C0B0u;
+    ev.session = (uint16_t)(gid / 20);
+    ev.seq = gid;
+    ev.ts_us = (uint64_t)gid * 1000003u;
+    ev.user = users[gid % 5];
+    ev.mic.freq = (float)(gid % 3000);
+    ev.mic.frames = gid * 7u;
+    ev.last_ms = gid * 13u;
+    return (uint8_t)lr_proto_encode(&ev, buf, LR_PROTO_MAX_LEN);
+}
+
+static bool confere(const uint8_t *p, uint8_t len, uint32_t *gid) {
+    uint8_t esperado[LR_PROTO_MAX_LEN];
+    *gid = lr_proto_ev_seq(p);
+    uint8_t n = gerar(*gid, esperado);
+    return n == len && memcmp(esperado, p, n) == 0;
+}
+
+static uint32_t total_bytes_ev = 0;
+
+static bool append_gid(lr_outbox_t *ob, uint32_t gid) {
+    uint8_t buf[LR_PROTO_MAX_LEN];
+    uint8_t n = gerar(gid, buf);
+    total_bytes_ev += n;
+    return lr_ob_append(ob, LR_OB_T_EVENT, buf, n);
+}
+
+// ============================
+// Cenários
+// ============================
+static void cenario_online(void) {
+    static flash_sim_t f;
+    static lr_outbox_t ob;
+    sim_init(&f, REGIAO);
+    lr_ob_flash_t fl = sim_flash(&f);
+    lr_ob_mount(&ob, &fl);
+
+    // janela cheia por um instante: o evento passa pelo outbox, volta logo
+    // e é confirmado antes do flush periódico
+    uint32_t ok = 1;
+    for (uint32_t gid = 1; gid <= 3000; gid++) {
+        append_gid(&ob, gid);
+        uint8_t t, n;
+        uint32_t rid, g;
+        const uint8_t *p = lr_ob_read(&ob, &t, &n, &rid);
+        if (!p || !confere(p, n, &g) || g != gid) ok = 0;
+        lr_ob_consume(&ob, rid);
+        if (gid % 3 == 0) lr_ob_flush(&ob);
+    }
+    lr_ob_flush(&ob);
+
+    printf("online     : 3000 eventos, %u páginas gravadas, %u apagamentos, %u páginas descartadas\n",
+           f.progs, f.erases, ob.st_dropped);
+    CHECK(ok, "online: leitura diferente do escrito");
+    CHECK(f.progs == 0 && f.erases == 0, "online: não devia tocar a flash");
+}
+
+// Quedas de rede seguidas (n_ev eventos cada), cada uma seguida de reboot
+// e replay completo, na mesma flash: o anel dá voltas e gasta os setores
+static void cenario_offline(int ciclos, int n_ev) {
+    static flash_sim_t f;
+    static lr_outbox_t ob;
+    sim_init(&f, REGIAO);
+    lr_ob_flash_t fl = sim_flash(&f);
+    lr_ob_mount(&ob, &fl);
+    total_bytes_ev = 0;
+
+    double t_esc = 0, t_rep = 0;
+    uint64_t parado_esc = 0;
+    uint32_t progs_esc = 0, progs_rep = 0, lidos = 0, gid = 0, esperado = 1;
+    uint32_t er_adiant = 0;   // apagamentos no lr_ob_prepare (fila parada)
+
+    for (int c = 0; c < ciclos; c++) {
+        // sem rede: tudo para a flash, flush a cada 20 eventos (o timer do
+        // firmware, com rodadas a cada ~100 ms)
+        uint64_t parado0 = f.parado_us;
+        uint32_t progs0 = f.progs;
+        double t0 = agora_s();
+        for (int i = 1; i <= n_ev; i++) {
+            if (!append_gid(&ob, ++gid)) { CHECK(0, "offline: append falhou em %u", gid); return; }
+            if (i % 20 == 0) {
+                lr_ob_flush(&ob);
+                uint32_t e0 = f.erases;
+                lr_ob_prepare(&ob);   // entre eventos a fila fica parada
+                er_adiant += f.erases - e0;
+            }
+        }
+        lr_ob_flush(&ob);
+        t_esc += agora_s() - t0;
+        parado_esc += f.parado_us - parado0;
+        progs_esc += f.progs - progs0;
+
+        // reboot com a rede de volta: replay em ordem, janela de JANELA
+        // eventos confirmados em blocos
+        lr_ob_mount(&ob, &fl);
+        progs0 = f.progs;
+        uint32_t fila[JANELA], nf = 0;
+        t0 = agora_s();
+        for (;;) {
+            uint8_t t, n;
+            uint32_t rid, g;
+            const uint8_t *p;
+            while (nf < JANELA && (p = lr_ob_read(&ob, &t, &n, &rid)) != NULL) {
+                if (!confere(p, n, &g) || g != esperado) {
+                    CHECK(0, "offline: replay fora de ordem/corrompido (gid %u, esperado %u)", g, esperado);
+                    return;
+                }
+                esperado++;
+                lidos++;
+                fila[nf++] = rid;
+            }
+            if (nf == 0) break;
+            lr_ob_consume(&ob, fila[nf - 1]);   // ACK cumulativo
+            nf = 0;
+            if (lidos % 240 == 0) lr_ob_flush(&ob);
+        }
+        lr_ob_flush(&ob);
+        t_rep += agora_s() - t0;
+        progs_rep += f.progs - progs0;
+        CHECK(ob.st_lost == 0, "offline: perdeu %u no ciclo %d", ob.st_lost, c);
+
+        // reboot depois do replay: o cursor tem que dizer que acabou
+        lr_ob_mount(&ob, &fl);
+        CHECK(!lr_ob_pending(&ob), "offline: cursor não sobreviveu ao reboot (ciclo %d)", c);
+    }
+
+    uint32_t wmin = UINT32_MAX, wmax = 0;
+    for (uint32_t s = 0; s < REGIAO / LR_OB_SECTOR; s++) {
+        if (f.desgaste[s] < wmin) wmin = f.desgaste[s];
+        if (f.desgaste[s] > wmax) wmax = f.desgaste[s];
+    }
+
+    uint32_t total = (uint32_t)(ciclos * n_ev);
+    printf("offline    : %d x %d eventos (%.1f B médio), página de %d B\n",
+           ciclos, n_ev, (double)total_bytes_ev / total, LR_OB_PAGE);
+    printf("  escrita  : %u páginas, %u apagamentos (%u adiantados pelo lr_ob_prepare, %u no append/flush), amplificação %.2fx (%.2fx contando o apagamento)\n",
+           progs_esc, f.erases, er_adiant, f.erases - er_adiant, (double)progs_esc * LR_OB_PAGE / total_bytes_ev,
+           ((double)progs_esc * LR_OB_PAGE + (double)f.erases * LR_OB_SECTOR) / total_bytes_ev);
+    printf("  vazão    : PC %.0f ns/evento | Pico (flash parada) %.2f ms/evento, %.0f eventos/s\n",
+           t_esc * 1e9 / total, parado_esc / 1000.0 / total, total / (parado_esc / 1e6));
+    printf("  replay   : %u eventos, PC %.0f ns/evento; %u páginas de cursor no replay\n",
+           lidos, t_rep * 1e9 / (lidos ? lidos : 1), progs_rep);
+    printf("  desgaste : apagamentos por setor %u..%u\n", wmin, wmax);
+
+    CHECK(lidos == total, "offline: replay leu %u de %u", lidos, total);
+}
+
+static void cenario_anel(void) {
+    static flash_sim_t f;
+    static lr_outbox_t ob;
+    const uint32_t size = 4u * LR_OB_SECTOR;
+    sim_init(&f, size);
+    lr_ob_flash_t fl = sim_flash(&f);
+    lr_ob_mount(&ob, &fl);
+
+    const uint32_t n_ev = 2000;
+    for (uint32_t i = 1; i <= n_ev; i++) append_gid(&ob, i);
+
+    // reboot no meio também vale
+    lr_ob_flush(&ob);
+    lr_ob_mount(&ob, &fl);
+
+    uint32_t lidos = 0, ultimo = 0, ok = 1;
+    uint8_t t, n;
+    uint32_t rid, gid;
+    const uint8_t *p;
+    while ((p = lr_ob_read(&ob, &t, &n, &rid)) != NULL) {
+        if (!confere(p, n, &gid) || gid <= ultimo) ok = 0;
+        ultimo = gid;
+        lidos++;
+    }
+    printf("anel cheio : %u escritos em %u KB, %u lidos (os mais novos), %u perdidos\n",
+           n_ev, size / 1024, lidos, ob.st_lost);
+    CHECK(ok, "anel: fora de ordem/corrompido");
+    CHECK(ultimo == n_ev, "anel: o mais novo (%u) não saiu", ultimo);
+    CHECK(lidos + ob.st_lost == n_ev, "anel: lidos + perdidos = %u, escritos %u", lidos + ob.st_lost, n_ev);
+}
+
+// Quedas de energia: o oráculo sabe o gid de cada rid e o que já chegou à
+// flash (fl_last_rid) em cada queda
+static void cenario_quedas(int rodadas) {
+    static flash_sim_t f;
+    static lr_outbox_t ob;
+    static uint32_t rid_gid[200000];
+    static uint8_t  entregue[200000];   // por gid: vezes entregue
+    static uint8_t  perdivel[200000];   // estava só na RAM numa queda
+
+    sim_init(&f, REGIAO);
+    memset(entregue, 0, sizeof(entregue));
+    memset(perdivel, 0, sizeof(perdivel));
+    lr_ob_flash_t fl = sim_flash(&f);
+    lr_ob_mount(&ob, &fl);
+
+    uint32_t gid = 0, ok = 1, quedas = 0, repetidos = 0, lim_rep = 0, anel = 0;
+    uint32_t fila[JANELA], fila_gid[JANELA], nf = 0;
+    uint32_t ultimo_lido = 0;
+
+    for (int r = 0; r < rodadas && ok; r++) {
+        if (!f.caiu && rnd() % 40 == 0) f.queda = 1 + (int)(rnd() % 4);
+
+        uint32_t op = rnd() % 100;
+        if (op < 35 && gid + 1 < 200000) {
+            uint32_t rid = ob.next_rid;
+            gid++;
+            rid_gid[rid] = gid;
+            if (!append_gid(&ob, gid)) perdivel[gid] = 1;   // caiu gravando a página anterior
+        } else if (op < 70) {
+            uint8_t t, n;
+            uint32_t rid, g;
+            const uint8_t *p;
+            while (nf < JANELA && (p = lr_ob_read(&ob, &t, &n, &rid)) != NULL) {
+                if (!confere(p, n, &g) || g != rid_gid[rid]) { ok = 0; printf("  corrompido rid %u\n", rid); break; }
+                if (g <= ultimo_lido) { ok = 0; printf("  fora de ordem gid %u depois de %u\n", g, ultimo_lido); break; }
+                ultimo_lido = g;
+                fila[nf] = rid;
+                fila_gid[nf++] = g;
+            }
+        } else if (op < 92) {
+            // ACK de uma parte da janela
+            uint32_t k = nf ? 1 + rnd() % nf : 0;
+            if (k) {
+                lr_ob_consume(&ob, fila[k - 1]);
+                for (uint32_t i = 0; i < k; i++) {
+                    if (entregue[fila_gid[i]]) repetidos++;
+                    if (entregue[fila_gid[i]] < 255) entregue[fila_gid[i]]++;
+                }
+                memmove(fila, fila + k, (nf - k) * sizeof(fila[0]));
+                memmove(fila_gid, fila_gid + k, (nf - k) * sizeof(fila_gid[0]));
+                nf -= k;
+            }
+        } else if (op < 96) {
+            (void)lr_ob_flush(&ob);
+        } else {
+            (void)lr_ob_prepare(&ob);   // fila parada: apaga o próximo setor
+        }
+
+        if (f.caiu || rnd() % 200 == 0) {
+            // queda: o que só estava na RAM pode sumir; a janela some
+            for (uint32_t rid = ob.fl_last_rid + 1; rid < ob.next_rid; rid++) perdivel[rid_gid[rid]] = 1;
+            lim_rep += ob.done_rid - ob.fl_done_rid;
+            anel += ob.st_lost;
+            f.caiu = 0;
+            f.queda = 0;
+            quedas++;
+            lr_ob_mount(&ob, &fl);
+            nf = 0;
+            ultimo_lido = 0;   // a ordem vale dentro de um boot
+        }
+    }
+
+    // fim: rede boa, entrega tudo
+    uint8_t t, n;
+    uint32_t rid, g;
+    const uint8_t *p;
+    while ((p = lr_ob_read(&ob, &t, &n, &rid)) != NULL) {
+        if (!confere(p, n, &g)) { ok = 0; break; }
+        if (entregue[g]) repetidos++;
+        entregue[g]++;
+    }
+    for (uint32_t i = 0; i < nf; i++) {
+        if (entregue[fila_gid[i]]) repetidos++;
+        entregue[fila_gid[i]]++;
+    }
+
+    uint32_t sumiu = 0, sumiu_ram = 0;
+    for (uint32_t i = 1; i <= gid; i++) {
+        if (entregue[i]) continue;
+        if (perdivel[i]) sumiu_ram++;
+        else sumiu++;
+    }
+
+    printf("quedas     : %d operações, %u quedas, %u eventos: %u perdidos na RAM, %u perdidos da flash, %u repetidos (limite %u)\n",
+           rodadas, quedas, gid, sumiu_ram, sumiu, repetidos, lim_rep);
+    CHECK(ok, "quedas: leitura corrompida ou fora de ordem");
+    CHECK(sumiu == 0, "quedas: %u eventos gravados na flash sumiram", sumiu);
+    CHECK(repetidos <= lim_rep, "quedas: %u repetidos acima do limite %u", repetidos, lim_rep);
+    CHECK(anel + ob.st_lost == 0, "quedas: anel não devia encher");
+}
+
+int main(void) {
+    printf("lr_outbox_sim: página %d B, setor %d B\n\n", LR_OB_PAGE, LR_OB_SECTOR);
+    cenario_online();
+    cenario_offline(5, 2000);
+    cenario_anel();
+    cenario_quedas(60000);
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,353 @@
+/**
+ * @file lr_proto_bench.c
+ * @brief Testes no PC do protocolo binário do local_report (lr_proto.c)
+ *        contra o JSON com snprintf que ele substituiu
+ *
+ * Eventos sintéticos (start/ok/err/stop com resumo do mic variado):
+ *   - bytes por evento: binário x JSON (mesmos formatos do local_report.c
+ *     antigo, com %.1f/%.3f/%.4f)
+ *   - custo de codificação por evento (ns e, em x86, ciclos)
+ *   - tamanhos esperados do layout v1 e recusa quando não cabe no buffer
+ *   - lotes: a política da task lr_udp (flush por tamanho, prazo desde o
+ *     primeiro evento do lote ou na hora em start/stop) com o ritmo dos
+ *     modos do jogo e com a fila acumulada depois de uma travada do Wi-Fi:
+ *     datagramas por evento e atraso até o envio, para prazos de 0 (só
+ *     junta o que já estava na fila), PRAZO_MS, 500 e 2000 ms
+ *
+ * Com um argumento, grava os datagramas (u16 tamanho + bytes: 40 eventos
+ * soltos e os mesmos em lotes) para
+ * conferir o decodificador do servidor:
+ *   ./lr_proto_bench /tmp/ev.bin && python3 cubo_serve/udp_server.py --decode /tmp/ev.bin
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório):
+ *   gcc -O2 -I. -o lr_proto_bench bench/lr_proto_bench.c lr_proto.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "lr_proto.h"
+
+#define N_EV   4000
+#define REPS   50
+#define PRAZO_MS  20    // LR_BATCH_DEADLINE_MS do local_report.c
+
+static int falhas = 0;
+
+static void verifica(int ok, const char *msg) {
+    if (!ok) { printf("  FALHOU: %s\n", msg); falhas++; }
+}
+
+static uint32_t rng_state = 2024u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+static const char *MODOS[] = { "UNK", "NIVEL 1", "MEMORIA", "MEMORIA RAPIDA" };
+static const char *USERS[] = { "", "Davi", "Maria Eduarda" };
+
+static lr_event_t ev[N_EV];
+
+static void gerar(void) {
+    for (int i = 0; i < N_EV; i++) {
+        lr_event_t *e = &ev[i];
+        memset(e, 0, sizeof(*e));
+        e->tipo = (i % 20 == 0) ? LR_EV_START : (i % 20 == 19) ? LR_EV_STOP : (frand() < 0.7 ? LR_EV_OK : LR_EV_ERR);
+        e->modo = (uint8_t)(1 + i / 20 % 3);
+        e->device = 0xE66038B7u;
+        e->session = (uint16_t)(1 + i / 20);
+        e->seq = (uint32_t)i + 1;
+        e->ts_us = 12000000ull + (uint64_t)i * 1733456ull;
+        e->user = USERS[i / 20 % 3];
+
+        lr_ev_mic_t *m = &e->mic;
+        m->freq      = (float)(80.0 + frand() * 3000.0);
+        m->intensity = (float)(frand() * 0.8);
+        m->rms       = (float)(0.005 + frand() * 0.2);
+        m->centroid  = (float)(300.0 + frand() * 4000.0);
+        m->flatness  = (float)frand();
+        m->rms_max   = m->rms * 2.5f;
+        m->rms_sd    = m->rms * 0.4f;
+        m->top_type  = (uint8_t)(frand() * 4);
+        m->frames    = 40 + (uint32_t)(frand() * 3000);
+        for (int k = 0; k < 4; k++) m->hist[k] = m->frames / 4;
+
+        e->last_ms   = 300 + (uint32_t)(frand() * 3000);
+        e->avg_ms    = 900;
+        e->total_ms  = 60000 + (uint32_t)(frand() * 600000);
+        e->ok_total  = (uint16_t)(i % 20);
+        e->err_total = (uint16_t)(i % 7);
+    }
+}
+
+// JSON como o local_report.c montava antes do lr_proto
+static int json_antigo(const lr_event_t *e, char *j, size_t n) {
+    const char *user = e->user ? e->user : "";
+    const char *modo = MODOS[e->modo < 4 ? e->modo : 0];
+    unsigned ts = (unsigned)(e->ts_us / 1000);
+
+    if (e->tipo == LR_EV_START) {
+        return snprintf(j, n, "{\"event\":\"start\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\",\"ts\":%u}",
+                        user, (unsigned)e->session, modo, ts);
+    }
+
+    const lr_ev_mic_t *m = &e->mic;
+    char mic[224];
+    snprintf(mic, sizeof(mic),
+             "\"mic_freq\":%.1f,\"mic_int\":%.3f,\"mic_type\":%u,"
+             "\"mic_rms\":%.4f,\"mic_cent\":%.0f,\"mic_flat\":%.3f,"
+             "\"mic_n\":%u,\"mic_rms_max\":%.4f,\"mic_rms_sd\":%.4f,"
+             "\"mic_hist\":[%u,%u,%u,%u]",
+             m->freq, m->intensity, (unsigned)m->top_type,
+             m->rms, m->centroid, m->flatness,
+             (unsigned)m->frames, m->rms_max, m->rms_sd,
+             (unsigned)m->hist[0], (unsigned)m->hist[1], (unsigned)m->hist[2], (unsigned)m->hist[3]);
+
+    if (e->tipo == LR_EV_OK) {
+        return snprintf(j, n,
+                        "{\"event\":\"ok\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\",%s,"
+                        "\"last_ms\":%u,\"avg_ms\":%u,\"ok_total\":%u,\"err_total\":%u,\"ts\":%u}",
+                        user, (unsigned)e->session, modo, mic, (unsigned)e->last_ms, (unsigned)e->avg_ms,
+                        (unsigned)e->ok_total, (unsigned)e->err_total, ts);
+    }
+    if (e->tipo == LR_EV_ERR) {
+        return snprintf(j, n,
+                        "{\"event\":\"err\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\",%s,"
+                        "\"last_ms\":%u,\"ok_total\":%u,\"err_total\":%u,\"ts\":%u}",
+                        user, (unsigned)e->session, modo, mic, (unsigned)e->last_ms,
+                        (unsigned)e->ok_total, (unsigned)e->err_total, ts);
+    }
+    return snprintf(j, n,
+                    "{\"event\":\"stop\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\",%s,"
+                    "\"ok_total\":%u,\"err_total\":%u,\"total_ms\":%u,\"ts\":%u}",
+                    user, (unsigned)e->session, modo, mic,
+                    (unsigned)e->ok_total, (unsigned)e->err_total, (unsigned)e->total_ms, ts);
+}
+
+// ---- simulação da política de lote ----
+typedef struct {
+    uint8_t    buf[LR_PROTO_BATCH_MAX];
+    lr_batch_t b;
+    double     t0;              // chegada do primeiro evento do lote
+    double     chegada[256];
+    long       datagramas, eventos;
+    double     atraso_sum, atraso_max;
+} sim_t;
+
+static void sim_flush(sim_t *s, double t) {
+    int n = lr_batch_count(&s->b);
+    if (n == 0) return;
+    for (int i = 0; i < n; i++) {
+        double d = t - s->chegada[i];
+        s->atraso_sum += d;
+        if (d > s->atraso_max) s->atraso_max = d;
+    }
+    s->datagramas++;
+    s->eventos += n;
+    lr_batch_reset(&s->b);
+}
+
+static void sim_evento(sim_t *s, const lr_event_t *e, double t, double prazo) {
+    // prazo vencido antes deste evento chegar (prazo 0: a task envia assim
+    // que a fila esvazia, então só junta eventos que chegaram juntos)
+    if (lr_batch_count(&s->b) && (prazo > 0 ? t >= s->t0 + prazo : t > s->t0)) sim_flush(s, s->t0 + prazo);
+
+    uint8_t tmp[LR_PROTO_MAX_LEN];
+    size_t n = lr_proto_encode(e, tmp, sizeof(tmp));
+    uint8_t *slot = lr_batch_slot(&s->b, n);
+    if (!slot) {
+        sim_flush(s, t);
+        slot = lr_batch_slot(&s->b, n);
+    }
+    memcpy(slot, tmp, n);
+    int k = lr_batch_count(&s->b);
+    if (k == 1) s->t0 = t;
+    s->chegada[k - 1] = t;
+
+    if (e->tipo == LR_EV_START || e->tipo == LR_EV_STOP) sim_flush(s, t);
+}
+
+// Sessões de 30 rodadas com intervalo sorteado entre ini_ms e fim_ms.
+// grupo > 1: eventos chegam juntos de grupo em grupo, como a fila que
+// acumula enquanto o Wi-Fi/lwIP está travado e depois é drenada de uma vez.
+static void simular(const char *nome, double ini_ms, double fim_ms, int grupo) {
+    static const double prazos[] = { 0, PRAZO_MS, 500, 2000 };
+    printf("  %-22s", nome);
+    for (unsigned pz = 0; pz < sizeof(prazos) / sizeof(prazos[0]); pz++) {
+        double prazo = prazos[pz];
+        static sim_t s;
+        memset(&s, 0, sizeof(s));
+        lr_batch_init(&s.b, s.buf, sizeof(s.buf));
+        rng_state = 31337u;
+
+        double t = 0;
+        for (int sess = 0; sess < 50; sess++) {
+            lr_event_t e = ev[1];
+            e.tipo = LR_EV_START;
+            sim_evento(&s, &e, t, prazo);
+            for (int r = 0; r < 30; r++) {
+                if (r % grupo == 0) t += grupo * (ini_ms + frand() * (fim_ms - ini_ms));
+                e.tipo = (frand() < 0.8) ? LR_EV_OK : LR_EV_ERR;
+                sim_evento(&s, &e, t, prazo);
+            }
+            t += 500;
+            e.tipo = LR_EV_STOP;
+            sim_evento(&s, &e, t, prazo);
+            t += 3000;
+        }
+        sim_flush(&s, t + prazo);
+
+        printf(" | %4.0f ms: %.2f dgr/ev %4.0f ms", prazo, (double)s.datagramas / s.eventos, s.atraso_sum / s.eventos);
+        verifica(s.atraso_max <= prazo + 1e-9, "evento esperou mais que o prazo do lote");
+        if (grupo > 1) verifica(s.datagramas * 2 < s.eventos, "fila acumulada não saiu em lote");
+    }
+    printf("\n");
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+typedef int (*cod_fn)(const lr_event_t *e, void *buf, size_t n);
+
+static int cod_bin(const lr_event_t *e, void *buf, size_t n) { return (int)lr_proto_encode(e, buf, n); }
+static int cod_json(const lr_event_t *e, void *buf, size_t n) { return json_antigo(e, buf, n); }
+
+static void medir(const char *nome, cod_fn f) {
+    static uint8_t buf[512];
+    long bytes[5] = {0}, cont[5] = {0};
+    int maior = 0;
+
+    for (int i = 0; i < N_EV; i++) {
+        int n = f(&ev[i], buf, sizeof(buf));
+        bytes[ev[i].tipo] += n;
+        cont[ev[i].tipo]++;
+        if (n > maior) maior = n;
+    }
+
+    volatile uint32_t sink = 0;
+    double t0 = agora_ns();
+#if HAVE_RDTSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (int r = 0; r < REPS; r++) {
+        for (int i = 0; i < N_EV; i++) sink += (uint32_t)f(&ev[i], buf, sizeof(buf));
+    }
+#if HAVE_RDTSC
+    uint64_t c1 = __rdtsc();
+#endif
+    double t1 = agora_ns();
+    (void)sink;
+
+    printf("  %-8s bytes/evento: start %5.1f  ok %5.1f  err %5.1f  stop %5.1f  (maior %d) | %6.0f ns/evento",
+           nome,
+           (double)bytes[LR_EV_START] / cont[LR_EV_START], (double)bytes[LR_EV_OK] / cont[LR_EV_OK],
+           (double)bytes[LR_EV_ERR] / cont[LR_EV_ERR], (double)bytes[LR_EV_STOP] / cont[LR_EV_STOP],
+           maior, (t1 - t0) / ((double)REPS * N_EV));
+#if HAVE_RDTSC
+    printf(", %.0f ciclos (PC)", (double)(c1 - c0) / ((double)REPS * N_EV));
+#endif
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    gerar();
+
+    printf("lr_proto v%d: cabeçalho 22 B + user, mic 49 B; %d eventos sintéticos\n\n",
+           LR_PROTO_VERSION, N_EV);
+    medir("binário", cod_bin);
+    medir("JSON", cod_json);
+
+    // --- tamanhos do layout v1 ---
+    {
+        uint8_t buf[LR_PROTO_MAX_LEN];
+        lr_event_t e = ev[1];
+        static const size_t esperado[5] = { 0, 22, 22 + 49 + 12, 22 + 49 + 8, 22 + 49 + 8 };
+        for (int t = LR_EV_START; t <= LR_EV_STOP; t++) {
+            e.tipo = (uint8_t)t;
+            e.user = "";
+            verifica(lr_proto_encode(&e, buf, sizeof(buf)) == esperado[t] + 1, "tamanho do evento fora do layout v1");
+        }
+
+        e.tipo = LR_EV_OK;
+        e.user = "um nome bem comprido que passa do limite de 31";
+        size_t n = lr_proto_encode(&e, buf, sizeof(buf));
+        verifica(n == 22 + 1 + 31 + 49 + 12, "user não foi truncado em 31 bytes");
+        verifica(n <= LR_PROTO_MAX_LEN, "maior evento não cabe em LR_PROTO_MAX_LEN");
+        verifica(lr_proto_encode(&e, buf, n - 1) == 0, "evento aceito em buffer pequeno");
+
+        e.tipo = 99;
+        verifica(lr_proto_encode(&e, buf, sizeof(buf)) == 0, "tipo desconhecido aceito");
+    }
+
+    // --- lote: cheio por tamanho ---
+    {
+        static uint8_t buf[LR_PROTO_BATCH_MAX];
+        lr_batch_t b;
+        lr_batch_init(&b, buf, sizeof(buf));
+        int n = 0;
+        for (;; n++) {
+            uint8_t tmp[LR_PROTO_MAX_LEN];
+            size_t k = lr_proto_encode(&ev[1 + n], tmp, sizeof(tmp));
+            uint8_t *slot = lr_batch_slot(&b, k);
+            if (!slot) break;
+            memcpy(slot, tmp, k);
+        }
+        printf("\nlote de %d B: %d eventos ok/err (%zu B usados)\n", LR_PROTO_BATCH_MAX, n, b.len);
+        verifica(n == lr_batch_count(&b) && b.len <= LR_PROTO_BATCH_MAX, "lote passou do tamanho");
+        verifica(n >= 14, "menos de 14 eventos por lote");
+    }
+
+    printf("\npolítica de lote (start/stop na hora): prazo: datagramas/evento, atraso médio até o envio\n");
+    simular("memória rápida", 800, 2500, 1);
+    simular("memória normal", 2000, 6000, 1);
+    simular("fila após travada (x8)", 800, 2500, 8);
+
+    if (argc > 1) {
+        FILE *f = fopen(argv[1], "wb");
+        if (!f) { perror(argv[1]); return 1; }
+        static uint8_t lote[LR_PROTO_BATCH_MAX];
+        lr_batch_t b;
+        lr_batch_init(&b, lote, sizeof(lote));
+        for (int i = 0; i < 40; i++) {
+            uint8_t buf[LR_PROTO_MAX_LEN];
+            uint16_t n = (uint16_t)lr_proto_encode(&ev[i], buf, sizeof(buf));
+            fwrite(&n, sizeof(n), 1, f);
+            fwrite(buf, 1, n, f);
+
+            uint8_t *slot = lr_batch_slot(&b, n);
+            if (!slot) {
+                uint16_t m = (uint16_t)b.len;
+                fwrite(&m, sizeof(m), 1, f);
+                fwrite(lote, 1, m, f);
+                lr_batch_reset(&b);
+                slot = lr_batch_slot(&b, n);
+            }
+            memcpy(slot, buf, n);
+        }
+        uint16_t m = (uint16_t)b.len;
+        fwrite(&m, sizeof(m), 1, f);
+        fwrite(lote, 1, m, f);
+        fclose(f);
+        printf("\n40 eventos gravados em %s (soltos e em lotes)\n", argv[1]);
+    }
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,270 @@
+/**
+ * @file lr_rel_sim.c
+ * @brief Teste no PC da entrega confiável do local_report (lr_rel.c) contra
+ *        o udp_server.py de verdade, atrás de um proxy que perde datagramas
+ *
+ * Faz o papel da task lr_udp: gera eventos no ritmo do jogo (rajadas de
+ * ok/err e start/stop urgentes), passa pela mesma janela lr_rel_t e pela
+ * mesma política de lote (prazo PRAZO_MS, start/stop na hora), manda por
+ * UDP e aplica os ACKs que voltam. No fim:
+ *   - latência evento->ACK (média/máx), envios, retransmissões, desistências
+ *   - com --log: confere no JSONL do servidor que cada evento aparece
+ *     exatamente uma vez (só pode faltar o que o device desistiu)
+ *
+ * Com --ilegivel N o evento de seq N sai com um tipo que o servidor não
+ * conhece, e a janela não desiste (max_tries = 0, como com o outbox): o
+ * servidor tem de confirmar o seq assim mesmo (senão o teste não termina)
+ * e gravá-lo no <log>_ilegiveis.jsonl, não no JSONL dos eventos.
+ *
+ * Sai com código 1 se sobrar evento sem ACK, se houver desistência sem
+ * --perda-ok ou se o JSONL não bater.
+ *
+ * Compilar e rodar (na raiz do repositório, três terminais ou com &):
+ *   gcc -O2 -I. -o lr_rel_sim bench/lr_rel_sim.c lr_rel.c lr_proto.c
+ *   python3 cubo_serve/udp_server.py --port 5001 --log /tmp/lr.jsonl --quiet
+ *   python3 cubo_serve/lossy_proxy.py --listen 5000 --to 127.0.0.1:5001 --perda 20
+ *   ./lr_rel_sim --port 5000 --eventos 500 --log /tmp/lr.jsonl
+ *   ./lr_rel_sim --port 5000 --eventos 100 --log /tmp/lr.jsonl --ilegivel 40
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "lr_rel.h"
+
+#define PRAZO_MS     20      // LR_BATCH_DEADLINE_MS do firmware
+#define FIM_MAX_S    120     // desiste do teste se não terminar
+#define TIPO_DESCONHECIDO 0x3F
+
+static uint64_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+static uint32_t rnd_state = 12345;
+static uint32_t rnd(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+// ============================
+// Gerador: sessão = start, 8..30 rodadas (ok/err a cada 20..200 ms,
+// 1 em 5 colado no anterior), stop
+// ============================
+typedef struct {
+    int      total;      // eventos a gerar
+    int      feitos;
+    int      rodadas;    // restantes na sessão (-1 = sessão fechada)
+    uint16_t sessao;
+    uint64_t t_prox;
+} gerador_t;
+
+static size_t gerar(gerador_t *g, uint32_t seq, uint64_t agora, uint8_t *buf, int *urgente) {
+    lr_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.device = 0xC0B0C0B0u;
+    ev.seq = seq;
+    ev.ts_us = agora;
+    ev.user = "sim";
+    ev.modo = LR_MODO_MEMORIA;
+
+    if (g->rodadas < 0) {
+        ev.tipo = LR_EV_START;
+        g->sessao++;
+        g->rodadas = 8 + (int)(rnd() % 23);
+    } else if (g->rodadas == 0 || g->feitos == g->total - 1) {
+        ev.tipo = LR_EV_STOP;
+        g->rodadas = -1;
+    } else {
+        ev.tipo = (rnd() % 4) ? LR_EV_OK : LR_EV_ERR;
+        ev.mic.freq = 440.0f;
+        ev.mic.frames = rnd() % 100;
+        ev.last_ms = rnd() % 3000;
+        g->rodadas--;
+    }
+    ev.session = g->sessao;
+    *urgente = (ev.tipo == LR_EV_START || ev.tipo == LR_EV_STOP);
+
+    g->feitos++;
+    g->t_prox = agora + 20000u + (rnd() % 180000u);
+    if (rnd() % 5 == 0) g->t_prox = agora + 2000u;   // rajada
+    return lr_proto_encode(&ev, buf, LR_PROTO_MAX_LEN);
+}
+
+// ============================
+// Conferência do JSONL do servidor
+// ============================
+// Soma em vezes[] quantas vezes cada seq deste boot aparece no arquivo
+// (linhas do json.dumps com "seq": N e "boot": "xxxxxxxx")
+static void contar_seqs(const char *path, uint32_t boot, uint32_t ultimo, uint8_t *vezes) {
+    FILE *f = fopen(path, "r");
+    if (!f) return;
+
+    char alvo[32];
+    snprintf(alvo, sizeof(alvo), "\"boot\": \"%08x\"", boot);
+
+    char linha[4096];
+    while (fgets(linha, sizeof(linha), f)) {
+        if (!strstr(linha, alvo)) continue;
+        const char *p = strstr(linha, "\"seq\": ");
+        if (!p) continue;
+        unsigned long s = strtoul(p + 7, NULL, 10);
+        if (s >= 1 && s <= ultimo && vezes[s] < 255) vezes[s]++;
+    }
+    fclose(f);
+}
+
+// Cada seq exatamente uma vez; só pode faltar o que o device desistiu de
+// mandar. O ilegível (0 = nenhum) só no <log>_ilegiveis.jsonl.
+static int conferir_log(const char *path, uint32_t boot, uint32_t ultimo, uint32_t desist, uint32_t ileg) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return 0; }
+    fclose(f);
+
+    uint8_t *vezes = calloc(ultimo + 1, 1);
+    uint8_t *vezes_ileg = calloc(ultimo + 1, 1);
+    contar_seqs(path, boot, ultimo, vezes);
+
+    char path_ileg[512];
+    const char *ponto = strrchr(path, '.');
+    int base_len = (ponto && !strchr(ponto, '/')) ? (int)(ponto - path) : (int)strlen(path);
+    snprintf(path_ileg, sizeof(path_ileg), "%.*s_ilegiveis.jsonl", base_len, path);
+    contar_seqs(path_ileg, boot, ultimo, vezes_ileg);
+
+    int faltando = 0, repetidos = 0, ok = 1;
+    for (uint32_t s = 1; s <= ultimo; s++) {
+        uint8_t n = (uint8_t)(vezes[s] + vezes_ileg[s]);
+        if (n > 1) repetidos++;
+        if (n == 0) faltando++;
+    }
+    printf("JSONL      : %u eventos, faltando %d, repetidos %d\n", ultimo, faltando, repetidos);
+    if ((uint32_t)faltando > desist || repetidos) ok = 0;
+    if (ileg && ileg <= ultimo) {
+        printf("ilegível   : seq %u %s\n", ileg,
+               vezes_ileg[ileg] == 1 && vezes[ileg] == 0 ? "confirmado e separado" : "NÃO separado");
+        if (vezes_ileg[ileg] != 1 || vezes[ileg]) ok = 0;
+    }
+    free(vezes);
+    free(vezes_ileg);
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    int porta = 5000, total = 300, perda_ok = 0;
+    uint32_t ileg = 0;
+    const char *log = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) porta = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--eventos") && i + 1 < argc) total = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--log") && i + 1 < argc) log = argv[++i];
+        else if (!strcmp(argv[i], "--perda-ok")) perda_ok = 1;
+        else if (!strcmp(argv[i], "--ilegivel") && i + 1 < argc) ileg = (uint32_t)strtoul(argv[++i], NULL, 10);
+        else { fprintf(stderr, "uso: %s [--port N] [--eventos N] [--log arq.jsonl] [--perda-ok] [--ilegivel SEQ]\n", argv[0]); return 2; }
+    }
+
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    struct sockaddr_in dst = { .sin_family = AF_INET, .sin_port = htons((uint16_t)porta) };
+    inet_pton(AF_INET, "127.0.0.1", &dst.sin_addr);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&dst, sizeof(dst)) < 0) { perror("socket"); return 1; }
+
+    static lr_rel_t rel;
+    static uint8_t batch_buf[LR_PROTO_BATCH_MAX];
+    lr_batch_t batch;
+    lr_batch_init(&batch, batch_buf, sizeof(batch_buf));
+
+    srand((unsigned)time(NULL));
+    uint32_t boot = ((uint32_t)rand() << 16) ^ (uint32_t)rand() ^ (uint32_t)getpid();
+    lr_rel_init(&rel, boot);
+    if (ileg) rel.max_tries = 0;   // como com o outbox: sem ACK, manda para sempre
+
+    gerador_t g = { .total = total, .rodadas = -1 };
+    uint32_t seq = 0, datagramas = 0, acks = 0;
+    uint64_t new_t0 = 0, t_ini = agora_us();
+    int urgente = 0;
+    const uint64_t prazo = (uint64_t)PRAZO_MS * 1000u;
+
+    printf("lr_rel_sim: boot=%08x, %d eventos -> 127.0.0.1:%d\n", boot, total, porta);
+
+    for (;;) {
+        uint64_t agora = agora_us();
+        if (g.feitos >= total && rel.count == 0) break;
+        if (agora - t_ini > (uint64_t)FIM_MAX_S * 1000000u) { printf("tempo esgotado\n"); break; }
+
+        // mesma espera da task: prazo do lote novo / retransmissão / próximo evento
+        uint64_t acorda = lr_rel_next_due(&rel);
+        if (lr_rel_has_new(&rel) && new_t0 + prazo < acorda) acorda = new_t0 + prazo;
+        if (g.feitos < total && g.t_prox < acorda) acorda = g.t_prox;
+        int espera = (acorda == UINT64_MAX) ? 100 : (acorda <= agora) ? 0 : (int)((acorda - agora + 999) / 1000);
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, espera) > 0) {
+            uint8_t a[64];
+            ssize_t n;
+            while ((n = recv(fd, a, sizeof(a), MSG_DONTWAIT)) > 0) {
+                uint32_t b, s;
+                if (lr_proto_parse_ack(a, (size_t)n, &b, &s) && b == boot) {
+                    acks++;
+                    lr_rel_ack(&rel, s, agora_us());
+                }
+            }
+        }
+
+        // evento novo (janela cheia = fica para depois, como o message buffer)
+        agora = agora_us();
+        if (g.feitos < total && g.t_prox <= agora && !lr_rel_full(&rel)) {
+            int urg = 0;
+            uint8_t ev[LR_PROTO_MAX_LEN];
+            size_t n = gerar(&g, ++seq, agora, ev, &urg);
+            if (n == 0) { fprintf(stderr, "encode falhou\n"); return 1; }
+            if (seq == ileg) ev[LR_PROTO_TIPO_OFFSET] = TIPO_DESCONHECIDO;
+
+            bool tinha_novo = lr_rel_has_new(&rel);
+            memcpy(lr_rel_reserve(&rel, (uint8_t)n), ev, n);
+            lr_rel_commit(&rel, 0);   // carimba o seq (o mesmo que o gerador pôs)
+            if (!tinha_novo) new_t0 = agora;
+            urgente |= urg;
+        }
+
+        bool novo = lr_rel_has_new(&rel) && (urgente || agora - new_t0 >= prazo || g.feitos >= total);
+        if (novo || lr_rel_next_due(&rel) <= agora) {
+            for (;;) {
+                lr_batch_reset(&batch);
+                if (lr_rel_build(&rel, &batch, agora_us()) == 0) break;
+                if (send(fd, batch.buf, batch.len, 0) > 0) datagramas++;
+            }
+            urgente = 0;
+        }
+    }
+
+    double seg = (double)(agora_us() - t_ini) / 1e6;
+    printf("tempo      : %.1f s, %u datagramas, %u ACKs recebidos\n", seg, datagramas, acks);
+    printf("envios     : %u (retransmissões %u = %.1f%%), desistências %u\n",
+           rel.st_tx, rel.st_retx, rel.st_tx ? 100.0 * rel.st_retx / rel.st_tx : 0.0, rel.st_desist);
+    printf("evento->ACK: médio %.1f ms, máx %.1f ms (%u confirmados)\n",
+           rel.st_lat_n ? (double)rel.st_lat_sum_us / rel.st_lat_n / 1000.0 : 0.0,
+           rel.st_lat_max_us / 1000.0, rel.st_acked);
+
+    int ok = (g.feitos >= total && rel.count == 0);
+    if (!ok) printf("sobraram %u eventos sem ACK\n", rel.count);
+    if (rel.st_desist && !perda_ok) ok = 0;
+
+    if (log) {
+        usleep(300000);   // o servidor grava depois de mandar o ACK
+        if (!conferir_log(log, boot, seq, rel.st_desist, ileg)) ok = 0;
+    }
+
+    close(fd);
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
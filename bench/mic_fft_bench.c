@@ -0,0 +1,197 @@
+/**
+ * @file mic_fft_bench.c
+ * @brief Compara o caminho FFT float x ponto fixo do microfone (PC)
+ *
+ * Gera quadros sintéticos de ADC (tons + ruído, 12 bits centrados em 2048),
+ * passa pelo mesmo mic_dsp.c do firmware e compara com uma DFT de
+ * referência em double:
+ *   - erro espectral (SNR do módulo dos bins, em dB)
+ *   - bin dominante e sound_type iguais aos da referência (%)
+ *   - erro médio da intensidade do pico (%)
+ *   - erro das features (RMS, centroide, planura; mic_features.h)
+ *   - custo por quadro (ns e, em x86, ciclos)
+ *
+ * O custo medido no PC só serve para comparação relativa; no RP2040 o
+ * firmware imprime o tempo real por quadro no log "[MIC] ... dsp=".
+ *
+ * Compilar (na raiz do repositório), um binário por caminho:
+ *   gcc -O2 -Imicrofone -o fft_float bench/mic_fft_bench.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ *   gcc -O2 -Imicrofone -DFIXED_POINT=16 -o fft_q15 bench/mic_fft_bench.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ *   gcc -O2 -Imicrofone -DFIXED_POINT=32 -o fft_q31 bench/mic_fft_bench.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_RDTSC 1
+#else
+#define HAVE_RDTSC 0
+#endif
+
+#include "mic_dsp.h"
+
+#define N_QUADROS 400
+#define REPS      50
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static uint32_t rng_state = 12345u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+// quadro sintético: até 2 tons + ruído branco
+static void gerar_quadro(int q, uint16_t *adc) {
+    double f1 = 60.0 + frand() * 3000.0;
+    double f2 = 60.0 + frand() * 6000.0;
+    double a1 = (q % 4 == 0) ? 8.0 : 30.0 + frand() * 900.0;   // alguns quadros quase em silêncio
+    double a2 = a1 * frand() * 0.5;
+    double ruido = 2.0 + frand() * 20.0;
+    double ph = frand() * 2 * M_PI;
+
+    for (int n = 0; n < SAMPLES; n++) {
+        double t = (double)n / SAMPLE_RATE;
+        double v = 2048.0
+                 + a1 * sin(2 * M_PI * f1 * t + ph)
+                 + a2 * sin(2 * M_PI * f2 * t)
+                 + ruido * (frand() - 0.5) * 2.0;
+        long x = lround(v);
+        if (x < 0) x = 0;
+        if (x > 4095) x = 4095;
+        adc[n] = (uint16_t)x;
+    }
+}
+
+typedef struct {
+    double rms, centroid_hz, flatness;
+} feat_ref_t;
+
+// referência: mesma normalização do caminho float, DFT em double
+static void referencia(const uint16_t *adc, double *mag, int *peak, double *intensity, uint8_t *type,
+                       feat_ref_t *f) {
+    double mean = 0;
+    for (int n = 0; n < SAMPLES; n++) mean += adc[n];
+    mean /= SAMPLES;
+
+    double best = -1;
+    *peak = 1;
+    for (int k = 0; k <= SAMPLES / 2; k++) {
+        double re = 0, im = 0;
+        for (int n = 0; n < SAMPLES; n++) {
+            double x = (adc[n] - mean) / 2048.0;
+            double w = -2 * M_PI * k * n / SAMPLES;
+            re += x * cos(w);
+            im += x * sin(w);
+        }
+        mag[k] = sqrt(re * re + im * im);
+        if (k >= 1 && k < SAMPLES / 2 && mag[k] > best) { best = mag[k]; *peak = k; }
+    }
+    *intensity = best;
+    *type = mic_dsp_detect_sound_type((float)(*peak * SAMPLE_RATE) / SAMPLES, (float)best);
+
+    double e2 = 0;
+    for (int n = 0; n < SAMPLES; n++) e2 += (adc[n] - mean) * (adc[n] - mean);
+    f->rms = sqrt(e2 / SAMPLES) / 2048.0;
+
+    double tot = 0, wk = 0, lsum = 0;
+    int nb = 0;
+    for (int k = 1; k < SAMPLES / 2; k++) {
+        double p = mag[k] * mag[k];
+        tot += p; wk += k * p; lsum += log(p + 1e-30); nb++;
+    }
+    f->centroid_hz = (tot > 0) ? (wk / tot) * SAMPLE_RATE / SAMPLES : 0;
+    f->flatness    = (tot > 0) ? exp(lsum / nb) / (tot / nb) : 0;
+}
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(void) {
+#ifdef FIXED_POINT
+    printf("caminho: ponto fixo Q%d\n", FIXED_POINT == 32 ? 31 : 15);
+#else
+    printf("caminho: float\n");
+#endif
+
+    if (!mic_dsp_init()) { fprintf(stderr, "mic_dsp_init falhou\n"); return 1; }
+
+    static uint16_t quadros[N_QUADROS][SAMPLES];
+    for (int q = 0; q < N_QUADROS; q++) gerar_quadro(q, quadros[q]);
+
+    double err2 = 0, ref2 = 0;
+    int peak_ok = 0, type_ok = 0;
+    double int_err = 0;
+    double rms_err = 0, cent_err = 0, flat_err = 0;
+    static double mag_ref[SAMPLES / 2 + 1];
+
+    for (int q = 0; q < N_QUADROS; q++) {
+        int peak_ref; double int_ref; uint8_t type_ref; feat_ref_t f_ref;
+        referencia(quadros[q], mag_ref, &peak_ref, &int_ref, &type_ref, &f_ref);
+
+        mic_dsp_result_t r;
+        mic_dsp_analyze(quadros[q], &r);
+
+        const kiss_fft_cpx *X = mic_dsp_spectrum();
+        double esc = mic_dsp_spectrum_scale();
+        for (int k = 1; k < SAMPLES / 2; k++) {
+            double re = (double)X[k].r, im = (double)X[k].i;
+            double m = sqrt(re * re + im * im) * esc;
+            double d = m - mag_ref[k];
+            err2 += d * d;
+            ref2 += mag_ref[k] * mag_ref[k];
+        }
+
+        int peak = (int)lround(r.freq_hz * SAMPLES / SAMPLE_RATE);
+        if (peak == peak_ref) peak_ok++;
+        if (r.sound_type == type_ref) type_ok++;
+        int_err += fabs(r.intensity - int_ref) / int_ref;
+        rms_err  += fabs(r.feat.rms - f_ref.rms) / f_ref.rms;
+        cent_err += fabs(r.feat.centroid_hz - f_ref.centroid_hz);
+        flat_err += fabs(r.feat.flatness - f_ref.flatness);
+    }
+
+    // custo: repete todos os quadros
+    mic_dsp_result_t r;
+    volatile float sink = 0;
+    double t0 = agora_ns();
+#if HAVE_RDTSC
+    uint64_t c0 = __rdtsc();
+#endif
+    for (int rep = 0; rep < REPS; rep++) {
+        for (int q = 0; q < N_QUADROS; q++) {
+            mic_dsp_analyze(quadros[q], &r);
+            sink += r.intensity;
+        }
+    }
+#if HAVE_RDTSC
+    uint64_t c1 = __rdtsc();
+#endif
+    double t1 = agora_ns();
+    (void)sink;
+
+    double total = (double)REPS * N_QUADROS;
+    printf("quadros:          %d x %d amostras\n", N_QUADROS, SAMPLES);
+    printf("erro espectral:   %.1f dB SNR (rel. %.2e)\n", 10 * log10(ref2 / (err2 + 1e-30)), sqrt(err2 / ref2));
+    printf("bin dominante ok: %.1f %%\n", 100.0 * peak_ok / N_QUADROS);
+    printf("sound_type ok:    %.1f %%\n", 100.0 * type_ok / N_QUADROS);
+    printf("erro intensidade: %.2f %%\n", 100.0 * int_err / N_QUADROS);
+    printf("features:         rms %.2f %% | centroide %.0f Hz | planura %.3f (erro médio)\n",
+           100.0 * rms_err / N_QUADROS, cent_err / N_QUADROS, flat_err / N_QUADROS);
+    printf("custo/quadro:     %.0f ns", (t1 - t0) / total);
+#if HAVE_RDTSC
+    printf(", %.0f ciclos (PC)", (double)(c1 - c0) / total);
+#endif
+    printf("\n");
+    return 0;
+}
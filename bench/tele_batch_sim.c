@@ -0,0 +1,277 @@
+/**
+ * @file tele_batch_sim.c
+ * @brief Teste no PC dos lotes com horário da telemetria (tele_batch.c)
+ *        contra o cubo_serve/mqtt_stub.py de verdade
+ *
+ * Faz o papel do laço do MQTT (mqtt_batch_pump): gera registros de fim de
+ * rodada com as mesmas chaves da GameTask (resultado, totais, resumo do
+ * mic), passa pelo mesmo tele_batch_t e pela mesma regra de envio
+ * (tele_batch_due) e publica em QoS 1 por TCP, num cliente MQTT 3.1.1
+ * mínimo. Sem PUBACK dentro de --timeout-ms, o mesmo lote vai de novo
+ * (no firmware é o timeout do pedido no cliente do lwIP). O relógio do
+ * jogo é simulado (rodadas de --rodada-ms em média, sem esperar de
+ * verdade); só o PUBACK é esperado em tempo real. No fim:
+ *   - registros, lotes, registros por lote, bytes por publish, reenvios
+ *   - com --log: confere no JSONL do stub que cada registro chegou (ts
+ *     distintos desta execução = rodadas)
+ *
+ * Sai com código 1 se sobrar registro sem PUBACK, se algum publish passar
+ * de TELE_BATCH_MAX ou se o JSONL não bater.
+ *
+ * Compilar e rodar (na raiz do repositório, dois terminais ou com &):
+ *   gcc -O2 -I. -o tele_batch_sim bench/tele_batch_sim.c tele_batch.c json_writer.c
+ *   python3 cubo_serve/mqtt_stub.py --port 1883 --log /tmp/tb.jsonl --perda-puback 10
+ *   ./tele_batch_sim --port 1883 --rodadas 30 --log /tmp/tb.jsonl
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "tele_batch.h"
+
+#define PASSO_MS     100     // resolução do relógio simulado
+#define FILA_MAX     64      // registros à espera (o message buffer do firmware)
+#define TOPICO       "v1/devices/me/telemetry"
+
+static uint32_t rnd_state = 12345;
+static uint32_t rnd(void) {
+    rnd_state ^= rnd_state << 13;
+    rnd_state ^= rnd_state >> 17;
+    rnd_state ^= rnd_state << 5;
+    return rnd_state;
+}
+
+// ============================
+// Registro de fim de rodada (as chaves do fim de rodada da GameTask)
+// ============================
+typedef struct {
+    uint8_t buf[4 + TELE_REC_MAX];
+    size_t  len;
+} registro_t;
+
+static void gerar(registro_t *r, uint32_t ms, uint32_t ok_total, uint32_t err_total, bool ok) {
+    jw_t w;
+    jw_init(&w, (char *)&r->buf[4], sizeof(r->buf) - 4);
+    jw_obj_begin(&w);
+    jw_key(&w, "resultado");   jw_str(&w, ok ? "ok" : "err");
+    jw_key(&w, "modo");        jw_str(&w, "memoria");
+    jw_key(&w, "ok_total");    jw_u32(&w, ok_total);
+    jw_key(&w, "err_total");   jw_u32(&w, err_total);
+    jw_key(&w, "last_ms");     jw_u32(&w, 800 + rnd() % 2200);
+    jw_key(&w, "avg_ms");      jw_u32(&w, 1500 + rnd() % 500);
+    jw_key(&w, "mic_freq");    jw_fix(&w, 200.0f + (float)(rnd() % 4000) / 10.0f, 1);
+    jw_key(&w, "mic_int");     jw_fix(&w, (float)(rnd() % 1000) / 1000.0f, 3);
+    jw_key(&w, "mic_rms");     jw_fix(&w, (float)(rnd() % 10000) / 100000.0f, 4);
+    jw_key(&w, "mic_rms_max"); jw_fix(&w, (float)(rnd() % 10000) / 50000.0f, 4);
+    jw_key(&w, "mic_cent");    jw_fix(&w, (float)(300 + rnd() % 2000), 0);
+    jw_key(&w, "mic_flat");    jw_fix(&w, (float)(rnd() % 1000) / 1000.0f, 3);
+    jw_key(&w, "mic_type");    jw_u32(&w, rnd() % 3);
+    jw_key(&w, "mic_n");       jw_u32(&w, rnd() % 120);
+    jw_obj_end(&w);
+    memcpy(r->buf, &ms, 4);
+    r->len = 4 + jw_finish(&w);
+}
+
+// ============================
+// Cliente MQTT mínimo (CONNECT, PUBLISH QoS 1, PUBACK, DISCONNECT)
+// ============================
+static size_t mqtt_cab(uint8_t *p, uint8_t tipo, size_t resto) {
+    size_t n = 0;
+    p[n++] = tipo;
+    do {
+        uint8_t b = (uint8_t)(resto % 128);
+        resto /= 128;
+        p[n++] = (uint8_t)(b | (resto ? 0x80 : 0));
+    } while (resto);
+    return n;
+}
+
+// Lê n bytes esperando no máximo ms; false = tempo esgotado ou conexão fechada
+static bool ler(int fd, uint8_t *p, size_t n, int ms) {
+    while (n) {
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        if (poll(&pfd, 1, ms) <= 0) return false;
+        ssize_t r = recv(fd, p, n, 0);
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+static bool mqtt_connect(int fd) {
+    static const uint8_t corpo[] = {
+        0, 4, 'M', 'Q', 'T', 'T', 4, 0x02, 0, 60,   // 3.1.1, clean session, keepalive 60 s
+        0, 8, 'c', 'u', 'b', 'o', '_', 's', 'i', 'm',
+    };
+    uint8_t p[64];
+    size_t n = mqtt_cab(p, 0x10, sizeof(corpo));
+    memcpy(&p[n], corpo, sizeof(corpo));
+    n += sizeof(corpo);
+    if (send(fd, p, n, 0) != (ssize_t)n) return false;
+
+    uint8_t ack[4];
+    return ler(fd, ack, 4, 2000) && ack[0] == 0x20 && ack[3] == 0;
+}
+
+// Publica em QoS 1 e espera o PUBACK do mesmo id
+static bool mqtt_publish(int fd, uint16_t pid, const char *payload, size_t len, int timeout_ms) {
+    static uint8_t p[8 + 2 + sizeof(TOPICO) + 2 + TELE_BATCH_MAX + 1];
+    size_t tl = strlen(TOPICO);
+    size_t n = mqtt_cab(p, 0x32, 2 + tl + 2 + len);
+    p[n++] = (uint8_t)(tl >> 8);
+    p[n++] = (uint8_t)tl;
+    memcpy(&p[n], TOPICO, tl);
+    n += tl;
+    p[n++] = (uint8_t)(pid >> 8);
+    p[n++] = (uint8_t)pid;
+    memcpy(&p[n], payload, len);
+    n += len;
+    if (send(fd, p, n, 0) != (ssize_t)n) return false;
+
+    uint8_t ack[4];
+    while (ler(fd, ack, 4, timeout_ms)) {
+        if (ack[0] == 0x40 && ack[1] == 2 && ((uint16_t)(ack[2] << 8) | ack[3]) == pid) return true;
+        // PUBACK atrasado de um publish anterior: continua esperando
+    }
+    return false;
+}
+
+// ============================
+// Conferência do JSONL do stub
+// ============================
+// Conta os ts distintos desta execução (linhas do json.dumps com "ts": N)
+static int conferir_log(const char *path, int64_t ts_min, int64_t ts_max, int rodadas) {
+    FILE *f = fopen(path, "r");
+    if (!f) { perror(path); return 0; }
+
+    uint8_t *visto = calloc((size_t)(ts_max - ts_min + 1), 1);
+    int distintos = 0, linhas = 0;
+    char linha[4096];
+    while (fgets(linha, sizeof(linha), f)) {
+        const char *p = strstr(linha, "\"ts\": ");
+        if (!p) continue;
+        long long ts = strtoll(p + 6, NULL, 10);
+        if (ts < ts_min || ts > ts_max) continue;
+        linhas++;
+        if (!visto[ts - ts_min]) { visto[ts - ts_min] = 1; distintos++; }
+    }
+    fclose(f);
+    free(visto);
+
+    printf("JSONL      : %d registros distintos (%d linhas, com reenvios), esperados %d\n",
+           distintos, linhas, rodadas);
+    return distintos == rodadas;
+}
+
+int main(int argc, char **argv) {
+    int porta = 1883, rodadas = 30, rodada_ms = 2000, timeout_ms = 300;
+    const char *log = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--port") && i + 1 < argc) porta = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rodadas") && i + 1 < argc) rodadas = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--rodada-ms") && i + 1 < argc) rodada_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--timeout-ms") && i + 1 < argc) timeout_ms = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "--log") && i + 1 < argc) log = argv[++i];
+        else {
+            fprintf(stderr, "uso: %s [--port N] [--rodadas N] [--rodada-ms N] [--timeout-ms N] [--log arq.jsonl]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rodada_ms < 2 * PASSO_MS) rodada_ms = 2 * PASSO_MS;
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in dst = { .sin_family = AF_INET, .sin_port = htons((uint16_t)porta) };
+    inet_pton(AF_INET, "127.0.0.1", &dst.sin_addr);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&dst, sizeof(dst)) < 0) { perror("connect"); return 1; }
+    if (!mqtt_connect(fd)) { fprintf(stderr, "CONNECT sem CONNACK\n"); return 1; }
+
+    // epoch = o que o SNTP daria: relógio do PC no "boot" da simulação
+    struct timespec rt;
+    clock_gettime(CLOCK_REALTIME, &rt);
+    const int64_t epoch_off_ms = (int64_t)rt.tv_sec * 1000 + rt.tv_nsec / 1000000;
+
+    static tele_batch_t batch;
+    static registro_t fila[FILA_MAX];
+    int fila_ini = 0, fila_n = 0;
+
+    uint32_t t = 0, t_prox = (uint32_t)rodada_ms;
+    uint32_t ok_total = 0, err_total = 0;
+    int gerados = 0, confirmados = 0, descartes = 0;
+    uint32_t publishes = 0, lotes = 0, reenvios = 0, bytes = 0, maior = 0;
+    uint16_t pid = 0;
+    int ok = 1;
+
+    printf("tele_batch_sim: %d rodadas de ~%d ms -> 127.0.0.1:%d (lote até %d B, prazo %d ms)\n",
+           rodadas, rodada_ms, porta, TELE_BATCH_MAX, TELE_BATCH_MS);
+
+    while (gerados < rodadas || fila_n || batch.n) {
+        // fim de rodada: registro novo (fila cheia = descarta e conta)
+        if (gerados < rodadas && t >= t_prox) {
+            bool acerto = (rnd() % 4) != 0;
+            if (acerto) ok_total++; else err_total++;
+            if (fila_n < FILA_MAX) {
+                gerar(&fila[(fila_ini + fila_n) % FILA_MAX], t, ok_total, err_total, acerto);
+                fila_n++;
+            } else {
+                descartes++;
+            }
+            gerados++;
+            t_prox = t + (uint32_t)rodada_ms / 2 + rnd() % (uint32_t)rodada_ms;
+        }
+
+        // mesma volta do mqtt_batch_pump: esvazia a fila no lote até não caber
+        bool cheio = false;
+        while (fila_n) {
+            registro_t *r = &fila[fila_ini];
+            if (!tele_batch_add(&batch, r->buf, r->len, epoch_off_ms)) { cheio = true; break; }
+            fila_ini = (fila_ini + 1) % FILA_MAX;
+            fila_n--;
+        }
+
+        if (tele_batch_due(&batch, cheio, t)) {
+            size_t len = tele_batch_close(&batch);
+            if (len > TELE_BATCH_MAX) { printf("publish de %zu B passa de TELE_BATCH_MAX\n", len); ok = 0; }
+            if (len > maior) maior = (uint32_t)len;
+            publishes++;
+            if (++pid == 0) pid = 1;
+            if (mqtt_publish(fd, pid, batch.buf, len, timeout_ms)) {
+                lotes++;
+                bytes += (uint32_t)len;
+                confirmados += batch.n;
+                tele_batch_clear(&batch);
+            } else {
+                reenvios++;   // sem PUBACK: o mesmo lote de novo na próxima volta
+            }
+        }
+        t += PASSO_MS;
+    }
+
+    static const uint8_t fim[] = { 0xE0, 0x00 };   // DISCONNECT
+    (void)send(fd, fim, sizeof(fim), 0);
+    close(fd);
+
+    printf("registros  : %d gerados, %d confirmados, %d descartados (fila cheia)\n",
+           gerados, confirmados, descartes);
+    printf("lotes      : %u confirmados, %.1f registros/lote, %u publishes (%u reenvios)\n",
+           lotes, lotes ? (double)confirmados / lotes : 0.0, publishes, reenvios);
+    printf("bytes      : médio %u B/lote, máx %u B (limite %d); contra %d publishes de 1 registro\n",
+           lotes ? bytes / lotes : 0, maior, TELE_BATCH_MAX, confirmados);
+
+    if (confirmados != gerados - descartes) { printf("sobraram %d registros sem PUBACK\n", gerados - descartes - confirmados); ok = 0; }
+
+    if (log) {
+        if (!conferir_log(log, epoch_off_ms, epoch_off_ms + t, gerados - descartes)) ok = 0;
+    }
+
+    printf("%s\n", ok ? "OK" : "FALHOU");
+    return ok ? 0 : 1;
+}
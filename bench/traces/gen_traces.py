@@ -0,0 +1,179 @@
+"""
+Gera o corpus sintético de traces do MPU6050 usado pelo face_replay.
+
+Uso:
+    python gen_traces.py            (sobrescreve os .csv desta pasta)
+
+Formato (CSV, uma amostra por linha, mesmo período do GameTask = 40 ms):
+    t_us,ax,ay,az,gx,gy,gz,truth
+
+- ax..gz: leitura bruta do MPU6050 (accel ±2g = 16384 LSB/g,
+  gyro ±250 °/s = 131 LSB/(°/s))
+- truth:  face em que o cubo está apoiado (FRENTE/TRAS/ESQ/DIR/BASE/TOPO)
+          ou MOV enquanto está sendo girado.
+
+Os traces são determinísticos (seed fixa) para servir de regressão.
+"""
+
+import math
+import os
+import random
+
+BASE_DIR = os.path.dirname(os.path.abspath(__file__))
+
+DT_US = 40000
+SENS_ACC = 16384.0
+SENS_GYR = 131.0
+
+# vetor gravidade (em g, no referencial do sensor) para cada face
+GRAV = {
+    "ESQ":    ( 1.0,  0.0,  0.0),
+    "DIR":    (-1.0,  0.0,  0.0),
+    "FRENTE": ( 0.0,  1.0,  0.0),
+    "TRAS":   ( 0.0, -1.0,  0.0),
+    "TOPO":   ( 0.0,  0.0,  1.0),
+    "BASE":   ( 0.0,  0.0, -1.0),
+}
+
+
+def clamp16(v):
+    return max(-32768, min(32767, int(round(v))))
+
+
+def slerp(a, b, u):
+    dot = max(-1.0, min(1.0, sum(x * y for x, y in zip(a, b))))
+    ang = math.acos(dot)
+    if ang < 1e-6:
+        return a
+    s = math.sin(ang)
+    wa = math.sin((1 - u) * ang) / s
+    wb = math.sin(u * ang) / s
+    return tuple(wa * x + wb * y for x, y in zip(a, b))
+
+
+class Trace:
+    def __init__(self, seed, noise_g=0.02, gyro_noise=1.5):
+        self.rng = random.Random(seed)
+        self.t = 0
+        self.rows = []
+        self.noise_g = noise_g
+        self.gyro_noise = gyro_noise
+        self.g = GRAV["TOPO"]
+
+    def _emit(self, g, gyro_dps, truth, extra=(0.0, 0.0, 0.0)):
+        acc = [clamp16((g[i] + extra[i] + self.rng.gauss(0, self.noise_g)) * SENS_ACC) for i in range(3)]
+        gyr = [clamp16((gyro_dps[i] + self.rng.gauss(0, self.gyro_noise)) * SENS_GYR) for i in range(3)]
+        self.rows.append((self.t, *acc, *gyr, truth))
+        self.t += DT_US
+
+    def hold(self, face, ms, tremor_g=0.0, tilt=0.0):
+        g = GRAV[face]
+        self.g = g
+        n = max(1, ms * 1000 // DT_US)
+        for k in range(n):
+            ex = (0.0, 0.0, 0.0)
+            if tremor_g > 0:
+                ph = 2 * math.pi * 6.0 * k * DT_US / 1e6
+                ex = tuple(tremor_g * math.sin(ph + i) for i in range(3))
+            if tilt > 0:
+                # inclinação constante em direção a um eixo vizinho
+                ex = tuple(ex[i] + (tilt if g[(i + 1) % 3] != 0 else 0.0) for i in range(3))
+            self._emit(g, (0.0, 0.0, 0.0), face, ex)
+
+    def rotate(self, face, ms):
+        a = self.g
+        b = GRAV[face]
+        n = max(2, ms * 1000 // DT_US)
+        dps = 90.0 / (ms / 1000.0)
+        axis = self.rng.randrange(3)
+        for k in range(n):
+            u = (k + 1) / n
+            g = slerp(a, b, u)
+            gyro = [0.0, 0.0, 0.0]
+            gyro[axis] = dps * math.sin(math.pi * u) * 1.57
+            # durante o giro há aceleração linear da mão
+            shake = tuple(self.rng.gauss(0, 0.15) for _ in range(3))
+            self._emit(g, gyro, "MOV", shake)
+        self.g = b
+
+    def bump(self, face, peak_g=1.8):
+        g = GRAV[face]
+        for amp in (peak_g, -0.6 * peak_g, 0.3 * peak_g):
+            ex = tuple(amp * self.rng.uniform(-1, 1) for _ in range(3))
+            self._emit(g, (0.0, 0.0, 0.0), face, ex)
+
+    def save(self, name):
+        path = os.path.join(BASE_DIR, name)
+        with open(path, "w", encoding="utf-8", newline="\n") as f:
+            f.write("t_us,ax,ay,az,gx,gy,gz,truth\n")
+            for r in self.rows:
+                f.write(",".join(str(x) for x in r) + "\n")
+        print(f"{name}: {len(self.rows)} amostras")
+
+
+def neighbors(face):
+    if face in ("TOPO", "BASE"):
+        return ["FRENTE", "TRAS", "ESQ", "DIR"]
+    if face in ("FRENTE", "TRAS"):
+        return ["TOPO", "BASE", "ESQ", "DIR"]
+    return ["TOPO", "BASE", "FRENTE", "TRAS"]
+
+
+def gen_rotacoes_lentas():
+    tr = Trace(seed=1)
+    tr.hold("TOPO", 1200)
+    cur = "TOPO"
+    for _ in range(14):
+        nxt = tr.rng.choice(neighbors(cur))
+        tr.rotate(nxt, 700)
+        tr.hold(nxt, 1500)
+        cur = nxt
+    tr.save("rotacoes_lentas.csv")
+
+
+def gen_rotacoes_rapidas():
+    # modo memória rápida: giros curtos e pouco tempo parado
+    tr = Trace(seed=2)
+    tr.hold("TOPO", 800)
+    cur = "TOPO"
+    for _ in range(20):
+        nxt = tr.rng.choice(neighbors(cur))
+        tr.rotate(nxt, 280)
+        tr.hold(nxt, tr.rng.choice((280, 360, 480)))
+        cur = nxt
+    tr.save("rotacoes_rapidas.csv")
+
+
+def gen_tremor_mao():
+    # cubo segurado na mão: tremor fisiológico (~6 Hz) e inclinação
+    tr = Trace(seed=3, noise_g=0.04, gyro_noise=4.0)
+    tr.hold("TOPO", 1000, tremor_g=0.10)
+    cur = "TOPO"
+    for _ in range(10):
+        nxt = tr.rng.choice(neighbors(cur))
+        tr.rotate(nxt, 500)
+        tr.hold(nxt, 1400, tremor_g=0.18, tilt=tr.rng.choice((0.0, 0.35, 0.55)))
+        cur = nxt
+    tr.save("tremor_mao.csv")
+
+
+def gen_batidas_mesa():
+    # cubo apoiado na mesa com batidas (picos de aceleração)
+    tr = Trace(seed=4)
+    tr.hold("TOPO", 1000)
+    cur = "TOPO"
+    for _ in range(10):
+        nxt = tr.rng.choice(neighbors(cur))
+        tr.rotate(nxt, 450)
+        tr.hold(nxt, 600)
+        tr.bump(nxt)
+        tr.hold(nxt, 900)
+        cur = nxt
+    tr.save("batidas_mesa.csv")
+
+
+if __name__ == "__main__":
+    gen_rotacoes_lentas()
+    gen_rotacoes_rapidas()
+    gen_tremor_mao()
+    gen_batidas_mesa()
@@ -0,0 +1,148 @@
+/**
+ * @file vad_bench.c
+ * @brief Testes no PC do piso de ruído adaptativo / gate de atividade do
+ *        microfone (noise_gate.c) contra o limiar fixo (NOISE_THRESHOLD)
+ *
+ * Cenário sintético por "sala" (quadros de SAMPLES amostras a SAMPLE_RATE):
+ *   ruído de fundo (branco + zumbido de 120 Hz) e rajadas de tom de 300 ms
+ *   a cada ~1,5 s, com amplitude sorteada entre +10 e +30 dB acima do ruído.
+ *   Na sala "muda" o ruído sobe 8x no meio do trace (ventilador ligando).
+ *
+ * Métricas:
+ *   - detecção: quadros de rajada com o gate aberto
+ *   - falso: quadros só de ruído com o gate aberto (fora do hangover)
+ *   - FFT pulada: quadros em que o gate fechado evitou a análise
+ *   - limiar fixo: quadros só de ruído que o mic_dsp classifica (tipo != 0)
+ *   - readaptação: quadros até o gate fechar depois do degrau de ruído
+ *
+ * Sai com código 1 se alguma verificação falhar.
+ *
+ * Compilar (na raiz do repositório):
+ *   gcc -O2 -Imicrofone -o vad_bench bench/vad_bench.c microfone/noise_gate.c microfone/mic_dsp.c microfone/mic_features.c microfone/kiss_fft.c microfone/kiss_fftr.c -lm
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <math.h>
+
+#include "noise_gate.h"
+#include "mic_dsp.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define N_QUADROS      1200                 // ~15 s a 20 kHz / 256
+#define RAJADA_QUADROS 23                   // ~300 ms
+#define PERIODO_QUADROS 117                 // ~1,5 s
+#define QUADROS_AQUEC  100                  // piso convergindo
+
+static int falhas = 0;
+
+static void verifica(int ok, const char *msg) {
+    if (!ok) { printf("  FALHOU: %s\n", msg); falhas++; }
+}
+
+static uint32_t rng_state = 99u;
+static double frand(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return (rng_state >> 8) / 16777216.0;
+}
+
+// gaussiana aproximada (soma de 4 uniformes), desvio 1
+static double grand(void) {
+    return (frand() + frand() + frand() + frand() - 2.0) * 1.7320508;
+}
+
+typedef struct {
+    const char *nome;
+    double ruido_lsb;        // rms do ruído de fundo
+    double ruido_depois;     // rms depois do degrau (0 = sem degrau)
+} sala_t;
+
+static const sala_t SALAS[] = {
+    { "quieta",   3.0,  0.0 },
+    { "ruidosa", 25.0,  0.0 },
+    { "muda",     3.0, 24.0 },   // degrau no meio
+};
+
+static void rodar(const sala_t *sala) {
+    noise_gate_t g;
+    noise_gate_init(&g);
+
+    int raj_total = 0, raj_det = 0;
+    int ruido_total = 0, ruido_falso = 0, ruido_fixo = 0;
+    int puladas = 0, desde_rajada = 1000;
+    int degrau = (sala->ruido_depois > 0) ? N_QUADROS / 2 : -1;
+    int readapt = -1;
+
+    double amp = 0, f = 0;
+    static uint16_t q[SAMPLES];
+
+    for (int k = 0; k < N_QUADROS; k++) {
+        double ruido = (degrau >= 0 && k >= degrau) ? sala->ruido_depois : sala->ruido_lsb;
+
+        int fase = k % PERIODO_QUADROS;
+        bool rajada = (k >= QUADROS_AQUEC) && fase >= 40 && fase < 40 + RAJADA_QUADROS;
+        if (rajada && fase == 40) {
+            amp = ruido * sqrt(2.0) * pow(10.0, (10.0 + frand() * 20.0) / 20.0);
+            f = 100.0 + frand() * 2900.0;
+        }
+
+        for (int n = 0; n < SAMPLES; n++) {
+            double t = (double)(k * SAMPLES + n) / SAMPLE_RATE;
+            double v = ruido * grand() * 0.9 + ruido * 0.6 * sin(2 * M_PI * 120.0 * t);
+            if (rajada) v += amp * sin(2 * M_PI * f * t);
+            long x = lround(2048.0 + 37.0 + v);   // offset do microfone
+            if (x < 0) x = 0;
+            if (x > 4095) x = 4095;
+            q[n] = (uint16_t)x;
+        }
+
+        bool ativo = noise_gate_update(&g, noise_gate_frame_energy(q, SAMPLES));
+        if (!ativo) puladas++;
+
+        desde_rajada = rajada ? 0 : desde_rajada + 1;
+        if (k < QUADROS_AQUEC) continue;
+
+        if (degrau >= 0 && k >= degrau && readapt < 0 && !rajada && !ativo) readapt = k - degrau;
+
+        if (rajada) {
+            raj_total++;
+            if (ativo) raj_det++;
+        } else if (desde_rajada > NG_HANGOVER + 1 && !(degrau >= 0 && k >= degrau && readapt < 0)) {
+            ruido_total++;
+            if (ativo) ruido_falso++;
+
+            mic_dsp_result_t r;
+            mic_dsp_analyze(q, &r);
+            if (r.sound_type != 0) ruido_fixo++;
+        }
+    }
+
+    double det = 100.0 * raj_det / raj_total;
+    double falso = 100.0 * ruido_falso / ruido_total;
+    printf("  %-8s ruído %4.0f%s LSB | detecção %5.1f %% | falso %4.1f %% | FFT pulada %5.1f %% | limiar fixo: %5.1f %% do ruído classificado",
+           sala->nome, sala->ruido_lsb, sala->ruido_depois > 0 ? "->24" : "    ",
+           det, falso, 100.0 * puladas / N_QUADROS, 100.0 * ruido_fixo / ruido_total);
+    if (degrau >= 0) printf(" | readapta em %d quadros", readapt);
+    printf("\n");
+
+    verifica(det >= 90.0, "rajadas não detectadas");
+    verifica(falso <= 5.0, "gate abrindo com ruído de fundo");
+    if (degrau >= 0) verifica(readapt >= 0 && readapt < 400, "piso não readaptou ao degrau de ruído");
+}
+
+int main(void) {
+    if (!mic_dsp_init()) { fprintf(stderr, "mic_dsp_init falhou\n"); return 1; }
+
+    printf("gate: abre +%.1f dB, fecha +%.1f dB, hangover %d quadros, mínimo %d LSB²\n",
+           10 * log10(NG_ON_RATIO_Q8 / 256.0), 10 * log10(NG_OFF_RATIO_Q8 / 256.0),
+           NG_HANGOVER, NG_MIN_ENERGY);
+
+    for (unsigned i = 0; i < sizeof(SALAS) / sizeof(SALAS[0]); i++) rodar(&SALAS[i]);
+
+    printf("\n%s\n", falhas ? "FALHOU" : "OK");
+    return falhas ? 1 : 0;
+}
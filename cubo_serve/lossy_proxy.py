@@ -0,0 +1,79 @@
+"""
+Proxy UDP com perda, atraso e jitter, entre o device (ou o bench) e o
+udp_server.py, para testar a entrega confiável do local_report (lr_rel.h):
+
+    python3 cubo_serve/udp_server.py --port 5001 &
+    python3 cubo_serve/lossy_proxy.py --listen 5000 --to 127.0.0.1:5001 --perda 20
+
+A perda vale nos dois sentidos (lotes e ACKs). Com jitter > 0 os datagramas
+também chegam fora de ordem.
+"""
+import argparse
+import heapq
+import random
+import select
+import socket
+import time
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Proxy UDP com perda/atraso")
+    ap.add_argument("--listen", type=int, default=5000, help="porta onde o device manda")
+    ap.add_argument("--to", default="127.0.0.1:5001", help="servidor (host:porta)")
+    ap.add_argument("--perda", type=float, default=10.0, help="%% de datagramas descartados")
+    ap.add_argument("--atraso", type=float, default=5.0, help="atraso fixo (ms)")
+    ap.add_argument("--jitter", type=float, default=5.0, help="atraso extra aleatório até (ms)")
+    ap.add_argument("--seed", type=int, default=None)
+    args = ap.parse_args()
+
+    rnd = random.Random(args.seed)
+    host, porta = args.to.rsplit(":", 1)
+    servidor = (host, int(porta))
+
+    lado_dev = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    lado_dev.bind(("0.0.0.0", args.listen))
+    lado_srv = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    lado_srv.bind(("0.0.0.0", 0))
+
+    cliente = None
+    fila = []   # (instante, ordem, socket, dados, destino)
+    ordem = 0
+    cont = {"ida": 0, "volta": 0, "perdidos": 0}
+
+    print(f"[PROXY] :{args.listen} -> {servidor}  perda={args.perda}% "
+          f"atraso={args.atraso}+{args.jitter} ms")
+
+    while True:
+        agora = time.monotonic()
+        timeout = max(0.0, fila[0][0] - agora) if fila else 1.0
+        prontos, _, _ = select.select([lado_dev, lado_srv], [], [], timeout)
+
+        for s in prontos:
+            data, addr = s.recvfrom(2048)
+            if s is lado_dev:
+                cliente = addr
+                sock, dest = lado_srv, servidor
+                cont["ida"] += 1
+            else:
+                if cliente is None:
+                    continue
+                sock, dest = lado_dev, cliente
+                cont["volta"] += 1
+            if rnd.random() * 100.0 < args.perda:
+                cont["perdidos"] += 1
+                continue
+            t = time.monotonic() + (args.atraso + rnd.random() * args.jitter) / 1000.0
+            ordem += 1
+            heapq.heappush(fila, (t, ordem, sock, data, dest))
+
+        agora = time.monotonic()
+        while fila and fila[0][0] <= agora:
+            _, _, sock, data, dest = heapq.heappop(fila)
+            sock.sendto(data, dest)
+
+        if prontos and (cont["ida"] + cont["volta"]) % 200 == 0:
+            print(f"[PROXY] ida={cont['ida']} volta={cont['volta']} perdidos={cont['perdidos']}")
+
+
+if __name__ == "__main__":
+    main()
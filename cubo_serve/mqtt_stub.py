@@ -0,0 +1,241 @@
+"""
+Broker MQTT mínimo no lugar do ThingsBoard, para conferir a telemetria do
+cubo sem nuvem (mqtt.c). No secrets.h:
+
+    #define MQTT_SERVER_HOST "192.168.0.10"   // IP do PC
+    #define MQTT_SERVER_PORT 1883
+
+    python3 cubo_serve/mqtt_stub.py --port 1883 --user Davi --log /tmp/tb.jsonl
+
+Fala o suficiente do MQTT 3.1.1 para o cliente do lwIP: CONNECT, SUBSCRIBE,
+PUBLISH QoS 0/1 (com PUBACK), PINGREQ, DISCONNECT. O pedido de atributo
+(v1/devices/me/attributes/request/N) recebe {"shared":{"active_user":..}}.
+
+Em v1/devices/me/telemetry confere os dois formatos:
+  - objeto: delta da telemetria (só as chaves que mudaram)
+  - lote [{"ts":..,"values":{..}},..]: ts em epoch ms, crescente, values
+    não vazio; ts repetido = lote reenviado (PUBACK perdido)
+e mostra publishes, registros por lote, bytes e leituras do socket
+(~segmentos TCP). --perda-puback descarta PUBACKs para ver o reenvio.
+"""
+import argparse
+import json
+import random
+import socketserver
+import struct
+import threading
+
+TOPICO_TELEMETRIA = "v1/devices/me/telemetry"
+TOPICO_ATTR_REQ = "v1/devices/me/attributes/request/"
+TOPICO_ATTR_RESP = "v1/devices/me/attributes/response/"
+TS_MIN = 1_600_000_000_000   # epoch ms plausível (2020+)
+
+_trava = threading.Lock()
+_cont = {"publishes": 0, "deltas": 0, "lotes": 0, "registros": 0, "bytes": 0,
+         "leituras": 0, "repetidos": 0, "erros": 0, "pubacks_perdidos": 0}
+_ts_vistos = set()
+
+
+def conferir_telemetria(payload: bytes, log):
+    """Valida um publish de telemetria; retorna uma linha de resumo."""
+    try:
+        obj = json.loads(payload.decode("utf-8"))
+    except (UnicodeDecodeError, json.JSONDecodeError) as e:
+        _cont["erros"] += 1
+        return f"JSON inválido: {e}"
+
+    if isinstance(obj, dict):
+        _cont["deltas"] += 1
+        if log:
+            log.write(json.dumps({"delta": obj}, ensure_ascii=False) + "\n")
+        return f"delta {len(obj)} chaves, {len(payload)} B: {sorted(obj)}"
+
+    if not isinstance(obj, list) or not obj:
+        _cont["erros"] += 1
+        return "formato inesperado"
+
+    avisos = []
+    anterior = 0
+    repetidos = 0
+    for reg in obj:
+        ts = reg.get("ts") if isinstance(reg, dict) else None
+        vals = reg.get("values") if isinstance(reg, dict) else None
+        if not isinstance(ts, int) or ts < TS_MIN or not isinstance(vals, dict) or not vals:
+            avisos.append(f"registro inválido {reg!r:.80}")
+            continue
+        if ts < anterior:
+            avisos.append(f"ts fora de ordem ({ts} < {anterior})")
+        anterior = ts
+        if ts in _ts_vistos:
+            repetidos += 1
+        _ts_vistos.add(ts)
+        if log:
+            log.write(json.dumps(reg, ensure_ascii=False) + "\n")
+
+    _cont["lotes"] += 1
+    _cont["registros"] += len(obj)
+    _cont["repetidos"] += repetidos
+    _cont["erros"] += len(avisos)
+    linha = f"lote {len(obj)} registros, {len(payload)} B ({len(payload) // len(obj)} B/registro)"
+    if repetidos:
+        linha += f", {repetidos} ts repetidos (reenvio)"
+    for a in avisos:
+        linha += f"\n[STUB]   ERRO: {a}"
+    return linha
+
+
+def resumo():
+    c = _cont
+    por_lote = c["registros"] / c["lotes"] if c["lotes"] else 0.0
+    return (f"publishes={c['publishes']} deltas={c['deltas']} lotes={c['lotes']} "
+            f"registros={c['registros']} ({por_lote:.1f}/lote) bytes={c['bytes']} "
+            f"leituras={c['leituras']} repetidos={c['repetidos']} "
+            f"pubacks_perdidos={c['pubacks_perdidos']} erros={c['erros']}")
+
+
+def pacote(tipo_flags: int, corpo: bytes) -> bytes:
+    n = len(corpo)
+    rl = bytearray()
+    while True:
+        b = n % 128
+        n //= 128
+        rl.append(b | (0x80 if n else 0))
+        if not n:
+            break
+    return bytes([tipo_flags]) + bytes(rl) + corpo
+
+
+def mqtt_str(s: str) -> bytes:
+    b = s.encode("utf-8")
+    return struct.pack(">H", len(b)) + b
+
+
+class Sessao(socketserver.BaseRequestHandler):
+    def setup(self):
+        self.buf = b""
+
+    def ler(self, n):
+        while len(self.buf) < n:
+            dados = self.request.recv(4096)
+            if not dados:
+                raise ConnectionError
+            with _trava:
+                _cont["leituras"] += 1
+            self.buf += dados
+        out, self.buf = self.buf[:n], self.buf[n:]
+        return out
+
+    def handle(self):
+        srv = self.server
+        quem = f"{self.client_address[0]}:{self.client_address[1]}"
+        print(f"[STUB] conexão de {quem}")
+        try:
+            while True:
+                cab = self.ler(1)[0]
+                n, mult = 0, 1
+                while True:
+                    b = self.ler(1)[0]
+                    n += (b & 0x7F) * mult
+                    mult *= 128
+                    if not b & 0x80:
+                        break
+                corpo = self.ler(n)
+                if not self.pacote(cab >> 4, cab & 0x0F, corpo, srv, quem):
+                    break
+        except (ConnectionError, OSError):
+            pass
+        print(f"[STUB] {quem} desconectou | {resumo()}")
+
+    def pacote(self, tipo, flags, corpo, srv, quem):
+        if tipo == 1:      # CONNECT
+            off = 2 + struct.unpack_from(">H", corpo, 0)[0] + 4   # nome, nível, flags, keepalive
+            cflags = corpo[off - 3]
+            (n,) = struct.unpack_from(">H", corpo, off)
+            cid = corpo[off + 2:off + 2 + n].decode(errors="replace")
+            off += 2 + n
+            user = ""
+            if cflags & 0x80:
+                (n,) = struct.unpack_from(">H", corpo, off)
+                user = corpo[off + 2:off + 2 + n].decode(errors="replace")
+            print(f"[STUB] CONNECT client_id={cid} user={user!r}")
+            self.request.sendall(pacote(0x20, b"\x00\x00"))
+        elif tipo == 3:    # PUBLISH
+            qos = (flags >> 1) & 3
+            (n,) = struct.unpack_from(">H", corpo, 0)
+            topico = corpo[2:2 + n].decode(errors="replace")
+            off = 2 + n
+            pid = None
+            if qos:
+                (pid,) = struct.unpack_from(">H", corpo, off)
+                off += 2
+            payload = corpo[off:]
+            self.publish(topico, payload, qos, srv)
+            if qos:
+                if random.random() * 100.0 < srv.perda_puback:
+                    with _trava:
+                        _cont["pubacks_perdidos"] += 1
+                else:
+                    self.request.sendall(pacote(0x40, struct.pack(">H", pid)))
+        elif tipo == 8:    # SUBSCRIBE
+            (pid,) = struct.unpack_from(">H", corpo, 0)
+            off, qos = 2, []
+            while off < len(corpo):
+                (n,) = struct.unpack_from(">H", corpo, off)
+                print(f"[STUB] SUBSCRIBE {corpo[off + 2:off + 2 + n].decode(errors='replace')}")
+                off += 2 + n + 1
+                qos.append(0)
+            self.request.sendall(pacote(0x90, struct.pack(">H", pid) + bytes(qos)))
+        elif tipo == 12:   # PINGREQ
+            self.request.sendall(pacote(0xD0, b""))
+        elif tipo == 14:   # DISCONNECT
+            return False
+        else:
+            print(f"[STUB] {quem}: pacote tipo {tipo} ignorado")
+        return True
+
+    def publish(self, topico, payload, qos, srv):
+        with _trava:
+            _cont["publishes"] += 1
+            _cont["bytes"] += len(payload)
+            if topico == TOPICO_TELEMETRIA:
+                linha = conferir_telemetria(payload, srv.log)
+                if srv.log:
+                    srv.log.flush()
+            elif topico.startswith(TOPICO_ATTR_REQ):
+                linha = f"pedido de atributo {payload!r}"
+                resp = json.dumps({"shared": {"active_user": srv.user}}).encode()
+                corpo = mqtt_str(TOPICO_ATTR_RESP + topico[len(TOPICO_ATTR_REQ):]) + resp
+                self.request.sendall(pacote(0x30, corpo))
+            else:
+                linha = f"{len(payload)} B"
+        print(f"[STUB] {topico} (QoS {qos}): {linha}")
+
+
+class Servidor(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Broker MQTT mínimo no lugar do ThingsBoard")
+    ap.add_argument("--port", type=int, default=1883)
+    ap.add_argument("--user", default="", help="active_user devolvido no pedido de atributo")
+    ap.add_argument("--log", default=None, help="JSONL com cada registro/delta recebido")
+    ap.add_argument("--perda-puback", type=float, default=0.0, help="%% de PUBACKs descartados")
+    ap.add_argument("--seed", type=int, default=None)
+    args = ap.parse_args()
+
+    random.seed(args.seed)
+    srv = Servidor(("0.0.0.0", args.port), Sessao)
+    srv.user = args.user
+    srv.perda_puback = args.perda_puback
+    srv.log = open(args.log, "a", encoding="utf-8") if args.log else None
+    print(f"[STUB] escutando em :{args.port} (active_user={args.user!r})")
+    try:
+        srv.serve_forever()
+    except KeyboardInterrupt:
+        print(f"[STUB] {resumo()}")
+
+
+if __name__ == "__main__":
+    main()
@@ -18,6 +18,11 @@ INDEX_HTML = os.path.join(OUT_DIR, "index.html")
 EVENTS_OK = {"start", "ok", "err", "stop"}
 EVENTS_MIC = {"telemetry"}  # se existir
 
+# estado do microfone pelo RMS do quadro (mic_rms, escala ADC/2048).
+# Eventos antigos sem mic_rms caem na média da freq dominante.
+MIC_RMS_CALMO = 0.02
+MIC_RMS_NORMAL = 0.08
+
 def now_str():
     return datetime.now().strftime("%Y-%m-%d %H:%M:%S")
 
@@ -117,6 +122,7 @@ def summarize_session(events):
 
     mic_freqs = []
     mic_ints = []
+    mic_rms = []
     last_mic = {"freq": None, "int": None, "type": None}
 
     for x in events:
@@ -146,8 +152,22 @@ def summarize_session(events):
         except Exception:
             pass
 
+        try:
+            if x.get("mic_rms") is not None:
+                mic_rms.append(float(x.get("mic_rms")))
+        except Exception:
+            pass
+
     estado = "NÃO INFORMADO"
-    if mic_freqs:
+    if mic_rms:
+        avg = sum(mic_rms)/len(mic_rms)
+        if avg < MIC_RMS_CALMO:
+            estado = "CALMO"
+        elif avg < MIC_RMS_NORMAL:
+            estado = "NORMAL"
+        else:
+            estado = "AGITADO"
+    elif mic_freqs:
         avg = sum(mic_freqs)/len(mic_freqs)
         if avg < 80:
             estado = "CALMO"
@@ -164,6 +184,7 @@ def summarize_session(events):
         "avg_int": (sum(mic_ints)/len(mic_ints)) if mic_ints else None,
         "min_int": min(mic_ints) if mic_ints else None,
         "max_int": max(mic_ints) if mic_ints else None,
+        "avg_rms": (sum(mic_rms)/len(mic_rms)) if mic_rms else None,
         "last": last_mic,
         "estado": estado,
     }
@@ -272,6 +293,7 @@ def build_user_page(user, sessions, generated_dt):
             <div><div style="color:#9aa4c3;font-size:12px">Microfone</div>
               <div style="font-weight:800">{html_escape(summ.get("mic",{}).get("estado","NÃO INFORMADO"))}</div>
               <div style="color:#9aa4c3;font-size:12px">leituras: {to_int(summ.get("mic",{}).get("count"),0)}</div>
+              <div style="color:#9aa4c3;font-size:12px">RMS médio: {html_escape(("-" if summ.get("mic",{}).get("avg_rms") is None else f"{summ['mic']['avg_rms']:.3f}"))}</div>
             </div>
             <div><div style="color:#9aa4c3;font-size:12px">Freq média</div><div>{html_escape(("-" if not summ.get("mic",{}).get("avg_hz") else f"{summ['mic']['avg_hz']:.1f} Hz"))}</div></div>
             <div><div style="color:#9aa4c3;font-size:12px">Freq mín</div><div>{html_escape(("-" if not summ.get("mic",{}).get("min_hz") else f"{summ['mic']['min_hz']:.1f} Hz"))}</div></div>
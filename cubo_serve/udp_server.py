@@ -1,6 +1,10 @@
 import os
+import sys
 import json
+import argparse
 import socket
+import struct
+import time
 from datetime import datetime
 
 BASE_DIR = os.path.dirname(os.path.abspath(__file__))
@@ -8,6 +12,7 @@ LOG_DIR = os.path.join(BASE_DIR, "logs")
 os.makedirs(LOG_DIR, exist_ok=True)
 
 JSONL_PATH = os.path.join(LOG_DIR, "udp_log.jsonl")
+ILEGIVEIS_PATH = os.path.join(LOG_DIR, "udp_log_ilegiveis.jsonl")   # ao lado do --log
 
 HOST = "0.0.0.0"
 PORT = 5000  # precisa bater com LOCAL_SERVER_PORT no secrets.h
@@ -15,46 +20,327 @@ PORT = 5000  # precisa bater com LOCAL_SERVER_PORT no secrets.h
 def now_dt():
     return datetime.now().strftime("%Y-%m-%d %H:%M:%S")
 
-def append_jsonl(obj: dict):
-    with open(JSONL_PATH, "a", encoding="utf-8") as f:
+def append_jsonl(obj: dict, path=None):
+    with open(path or JSONL_PATH, "a", encoding="utf-8") as f:
         f.write(json.dumps(obj, ensure_ascii=False) + "\n")
 
+# ============================
+# Eventos binários do Pico (lr_proto.h)
+# ============================
+# Cabeçalho: magic, versão, tipo, modo, device, sessão, seq, ts_us.
+# Mudou o layout no firmware (LR_PROTO_VERSION)? Acrescentar a versão aqui.
+LR_MAGIC = 0xCB
+LR_BATCH_MAGIC = 0xCC   # lote: magic, versão, n, [boot, base (v2)], n x [len + evento]
+LR_BATCH_V2 = struct.Struct("<II")
+LR_ACK = struct.Struct("<BBII")   # magic 0xCA, versão 1, boot, seq cumulativo
+LR_ACK_MAGIC = 0xCA
+LR_HDR = struct.Struct("<BBBBIHIQ")
+LR_ENVELOPE = struct.Struct("<BBBBIHI")   # até o seq: o mesmo em toda versão
+LR_MIC = struct.Struct("<7fBI4I")
+
+LR_EVENTOS = {1: "start", 2: "ok", 3: "err", 4: "stop", 5: "net"}
+LR_FLAG_BOOT_ANT = 0x80   # no tipo: evento do outbox gravado no boot anterior
+LR_MODOS = {1: "NIVEL 1", 2: "MEMORIA", 3: "MEMORIA RAPIDA"}
+
+# campos depois do mic, por tipo (nome, formato)
+LR_CAMPOS_V1 = {
+    "start": (),
+    "ok":    (("last_ms", "I"), ("avg_ms", "I"), ("ok_total", "H"), ("err_total", "H")),
+    "err":   (("last_ms", "I"), ("ok_total", "H"), ("err_total", "H")),
+    "stop":  (("ok_total", "H"), ("err_total", "H"), ("total_ms", "I")),
+    # link Wi-Fi (sem mic): 1 = subiu, 0 = caiu; fora_ms/tentativas só ao subir
+    "net":   (("link", "B"), ("rssi", "b"), ("tentativas", "H"), ("fora_ms", "I")),
+}
+LR_COM_MIC = ("ok", "err", "stop")
+
+def lr_mic_dict(vals):
+    freq, inten, rms, cent, flat, rms_max, rms_sd, tipo, n, h0, h1, h2, h3 = vals
+    # mesmas chaves/precisão do JSON antigo (report.py não muda)
+    return {
+        "mic_freq": round(freq, 1),
+        "mic_int": round(inten, 3),
+        "mic_type": tipo,
+        "mic_rms": round(rms, 4),
+        "mic_cent": round(cent),
+        "mic_flat": round(flat, 3),
+        "mic_n": n,
+        "mic_rms_max": round(rms_max, 4),
+        "mic_rms_sd": round(rms_sd, 4),
+        "mic_hist": [h0, h1, h2, h3],
+    }
+
+def decode_lr(data: bytes):
+    """Evento binário -> dict no formato do JSON antigo (None se inválido)."""
+    if len(data) < LR_HDR.size + 1 or data[0] != LR_MAGIC:
+        return None
+    _, ver, tipo, modo, dev, sess, seq, ts_us = LR_HDR.unpack_from(data, 0)
+    if ver != 1:
+        return None
+    boot_ant = bool(tipo & LR_FLAG_BOOT_ANT)
+    ev = LR_EVENTOS.get(tipo & ~LR_FLAG_BOOT_ANT)
+    if ev is None:
+        return None
+
+    off = LR_HDR.size
+    n = data[off]
+    user = data[off + 1:off + 1 + n].decode("utf-8", errors="replace")
+    off += 1 + n
+
+    obj = {"event": ev, "user": user, "session": sess, "modo": LR_MODOS.get(modo, "UNK")}
+    try:
+        if ev in LR_COM_MIC:
+            obj.update(lr_mic_dict(LR_MIC.unpack_from(data, off)))
+            off += LR_MIC.size
+        for nome, fmt in LR_CAMPOS_V1[ev]:
+            obj[nome] = struct.unpack_from("<" + fmt, data, off)[0]
+            off += struct.calcsize(fmt)
+    except struct.error:
+        return None
+
+    obj["ts"] = ts_us // 1000
+    obj["ts_us"] = ts_us
+    obj["seq"] = seq
+    obj["dev"] = f"{dev:08x}"
+    obj["v"] = ver
+    if boot_ant:
+        # ts_us é do relógio do boot anterior; "dt" é só a hora da chegada
+        obj["boot_anterior"] = True
+    return obj
+
+def decode_batch(data: bytes):
+    """Lote -> (eventos, boot, base); cada evento leva "lote" = eventos no datagrama.
+    v1 (sem entrega confiável) vem com boot/base None."""
+    if len(data) < 3 or data[0] != LR_BATCH_MAGIC or data[1] not in (1, 2):
+        return None
+    n = data[2]
+    out = []
+    off = 3
+    boot = base = None
+    if data[1] == 2:
+        if len(data) < 3 + LR_BATCH_V2.size:
+            return None
+        boot, base = LR_BATCH_V2.unpack_from(data, 3)
+        off += LR_BATCH_V2.size
+    for _ in range(n):
+        if off >= len(data):
+            break
+        tam = data[off]
+        ev = data[off + 1:off + 1 + tam]
+        off += 1 + tam
+        obj = decode_lr(ev)
+        if obj is None and boot is not None:
+            obj = ilegivel(ev)
+        if obj is not None:
+            obj["lote"] = n
+            out.append(obj)
+    return out, boot, base
+
+def ilegivel(ev: bytes):
+    """Evento de lote v2 que não decodifica (tipo/versão desconhecidos):
+    só o seq e o device, para o ACK cobrir o seq (senão o device, que com
+    o outbox não desiste, manda o lote para sempre). Vai para
+    ILEGIVEIS_PATH com o hex, não para o JSONL dos relatórios."""
+    if len(ev) < LR_ENVELOPE.size or ev[0] != LR_MAGIC:
+        return None
+    _, ver, tipo, _, dev, _, seq = LR_ENVELOPE.unpack_from(ev, 0)
+    return {"ilegivel": True, "v": ver, "tipo": tipo, "seq": seq,
+            "dev": f"{dev:08x}", "hex": ev.hex()}
+
+def decode_payload(data: bytes):
+    """Lote ou evento binário (firmware novo) ou JSON/texto (antigo) ->
+    (lista de eventos, boot, base); boot/base só no lote v2."""
+    lote = decode_batch(data)
+    if lote is not None:
+        return lote
+
+    obj = decode_lr(data)
+    if obj is not None:
+        return [obj], None, None
+
+    payload = data.decode("utf-8", errors="ignore").strip()
+    if not payload:
+        return [], None, None
+    try:
+        return [json.loads(payload)], None, None
+    except Exception:
+        return [{"raw": payload}], None, None
+
+# ============================
+# Entrega confiável (lr_rel.h no firmware)
+# ============================
+# Por (device, boot): seq contíguo já recebido ("cum") + os recebidos acima
+# dele. Cada lote v2 recebe um ACK cumulativo; duplicados (retransmissão
+# cujo ACK se perdeu) não vão para o JSONL. Lacuna = seq pulado; fecha quando
+# a retransmissão chega ou quando o "base" do device passa dela (desistiu).
+class Fluxo:
+    def __init__(self, base):
+        self.cum = base - 1
+        self.acima = set()
+        self.novos = 0
+        self.dups = 0
+        self.perdidos = 0
+        self.lacunas = 0
+
+    def avancar(self):
+        while self.cum + 1 in self.acima:
+            self.cum += 1
+            self.acima.discard(self.cum)
+
+    def fechar_ate(self, base):
+        """device não manda mais nada abaixo de base"""
+        if base - 1 <= self.cum:
+            return 0
+        faltando = sum(1 for q in range(self.cum + 1, base) if q not in self.acima)
+        self.perdidos += faltando
+        self.acima = {q for q in self.acima if q >= base}
+        self.cum = base - 1
+        self.avancar()
+        return faltando
+
+    def receber(self, seq):
+        """True se o evento é novo (grava), False se duplicado."""
+        if seq <= self.cum or seq in self.acima:
+            self.dups += 1
+            return False
+        if seq > self.cum + 1 and seq - 1 not in self.acima:
+            self.lacunas += 1
+        self.acima.add(seq)
+        self.novos += 1
+        self.avancar()
+        return True
+
+_fluxos = {}
+
+def confiavel(objs, boot, base, origem):
+    """Filtra duplicados e atualiza o estado; devolve (novos, fluxo, log).
+    Todo lote v2 tem fluxo (e ACK), mesmo sem evento legível: a chave é o
+    device do 1º evento ou, sem ele, o fluxo já aberto com esse boot ou o
+    endereço de origem."""
+    if boot is None:
+        return objs, None, []
+    dev = objs[0].get("dev") if objs else None
+    if dev is None:
+        dev = next((d for (d, b) in _fluxos if b == boot), origem)
+    fl = _fluxos.get((dev, boot))
+    if fl is None:
+        fl = _fluxos[(dev, boot)] = Fluxo(base)
+
+    log = []
+    perdidos = fl.fechar_ate(base)
+    if perdidos:
+        log.append(f"{perdidos} evento(s) perdidos antes do seq {base} (device desistiu)")
+
+    novos = []
+    for obj in objs:
+        seq = obj.get("seq", 0)
+        lacunas = fl.lacunas
+        if fl.receber(seq):
+            if fl.lacunas != lacunas:
+                log.append(f"lacuna antes do seq {seq} (cum={fl.cum})")
+            obj["boot"] = f"{boot:08x}"
+            novos.append(obj)
+    return novos, fl, log
+
+def estatistica_fluxos():
+    for (dev, boot), fl in _fluxos.items():
+        print(f"[UDP] {dev} boot={boot:08x}: {fl.novos} eventos, cum={fl.cum}, "
+              f"{fl.dups} duplicados, {fl.lacunas} lacunas, {fl.perdidos} perdidos, "
+              f"{len(fl.acima)} fora de ordem")
+
+# Atraso ponta a ponta sem relógio comum: por device, (chegada - ts_us) tem
+# um deslocamento fixo (boot do Pico) + o atraso. O menor valor visto é a
+# referência; atraso_ms = quanto cada evento chegou acima dela (lote + fila
+# + Wi-Fi), bom para comparar, não absoluto.
+_ref_atraso = {}
+_contagem = {"eventos": 0, "datagramas": 0}
+
+def instrumentar(objs, chegada_us):
+    if not objs:
+        return
+    _contagem["datagramas"] += 1
+    _contagem["eventos"] += len(objs)
+    for obj in objs:
+        if "ts_us" not in obj or obj.get("boot_anterior"):
+            continue
+        dif = chegada_us - obj["ts_us"]
+        dev = obj.get("dev", "")
+        ref = min(_ref_atraso.get(dev, dif), dif)
+        _ref_atraso[dev] = ref
+        obj["atraso_ms"] = round((dif - ref) / 1000.0, 1)
+
+def decode_file(path):
+    """Decodifica um dump do bench/lr_proto_bench (u16 tamanho + datagrama)."""
+    with open(path, "rb") as f:
+        buf = f.read()
+    off = 0
+    while off + 2 <= len(buf):
+        (n,) = struct.unpack_from("<H", buf, off)
+        off += 2
+        for obj in decode_payload(buf[off:off + n])[0]:
+            print(json.dumps(obj, ensure_ascii=False))
+        off += n
+
 def main():
+    global JSONL_PATH, ILEGIVEIS_PATH
+    ap = argparse.ArgumentParser(description="Recebe os eventos UDP do local_report")
+    ap.add_argument("--port", type=int, default=PORT)
+    ap.add_argument("--log", default=JSONL_PATH, help="arquivo JSONL de saída")
+    ap.add_argument("--decode", metavar="ARQ", help="decodifica um dump (len u16 + datagrama) e sai")
+    ap.add_argument("--quiet", action="store_true", help="sem uma linha por evento")
+    args = ap.parse_args()
+
+    if args.decode:
+        decode_file(args.decode)
+        return
+    JSONL_PATH = args.log
+    ILEGIVEIS_PATH = os.path.splitext(args.log)[0] + "_ilegiveis.jsonl"
+
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-    sock.bind((HOST, PORT))
-    print(f"[UDP] Escutando em {HOST}:{PORT}")
+    sock.bind((HOST, args.port))
+    print(f"[UDP] Escutando em {HOST}:{args.port}")
     print(f"[UDP] Gravando em: {JSONL_PATH}")
 
     while True:
         data, addr = sock.recvfrom(2048)
         src_ip, src_port = addr[0], addr[1]
 
-        try:
-            payload = data.decode("utf-8", errors="ignore").strip()
-        except Exception:
-            continue
+        objs, boot, base = decode_payload(data)
+        instrumentar(objs, time.monotonic_ns() // 1000)
+        objs, fl, avisos = confiavel(objs, boot, base, src_ip)
+        for a in avisos:
+            print(f"[UDP] {src_ip} {a}")
 
-        if not payload:
-            continue
+        # ACK cumulativo em todo lote v2, mesmo se tudo era duplicado (o
+        # anterior se perdeu) ou ilegível
+        if fl is not None:
+            sock.sendto(LR_ACK.pack(LR_ACK_MAGIC, 1, boot, fl.cum & 0xFFFFFFFF), addr)
 
-        # tenta entender JSON vindo do Pico
-        try:
-            obj = json.loads(payload)
-        except Exception:
-            obj = {"raw": payload}
+        for obj in objs:
+            obj["dt"] = now_dt()
+            obj["src_ip"] = src_ip
+            obj["src_port"] = src_port
 
-        obj["dt"] = now_dt()
-        obj["src_ip"] = src_ip
-        obj["src_port"] = src_port
+            if obj.get("ilegivel"):
+                append_jsonl(obj, ILEGIVEIS_PATH)
+                print(f"[UDP] {src_ip} evento ilegível seq={obj['seq']} v={obj['v']} tipo={obj['tipo']} "
+                      f"(confirmado, gravado em {ILEGIVEIS_PATH})")
+                continue
+            append_jsonl(obj)
+            if args.quiet:
+                continue
 
-        append_jsonl(obj)
+            # log simples
+            ev = obj.get("event") or obj.get("raw") or "?"
+            user = obj.get("user", "")
+            sess = obj.get("session", "")
+            modo = obj.get("modo", "")
+            extra = f" lote={obj['lote']} atraso={obj.get('atraso_ms', '-')}ms" if "lote" in obj else ""
+            print(f"[UDP] {src_ip} ev={ev} user={user} session={sess} modo={modo}{extra}")
 
-        # log simples
-        ev = obj.get("event") or obj.get("raw") or "?"
-        user = obj.get("user", "")
-        sess = obj.get("session", "")
-        modo = obj.get("modo", "")
-        print(f"[UDP] {src_ip} ev={ev} user={user} session={sess} modo={modo}")
+        if _contagem["eventos"] and _contagem["datagramas"] % 50 == 0:
+            print(f"[UDP] {_contagem['eventos']} eventos em {_contagem['datagramas']} datagramas "
+                  f"({_contagem['datagramas'] / _contagem['eventos']:.2f} dgram/evento)")
+            estatistica_fluxos()
 
 if __name__ == "__main__":
     main()
@@ -0,0 +1,62 @@
+#include "face_detect.h"
+
+#include <math.h>
+
+face_t face_classificar(const int16_t accel[3]) {
+    float ax = accel[0] / FACE_SENS_2G;
+    float ay = accel[1] / FACE_SENS_2G;
+    float az = accel[2] / FACE_SENS_2G;
+
+    float abs_ax = fabsf(ax);
+    float abs_ay = fabsf(ay);
+    float abs_az = fabsf(az);
+
+    if (abs_ax > abs_ay && abs_ax > abs_az && abs_ax > FACE_LIMIAR_G) {
+        return (ax > 0) ? FACE_ESQ : FACE_DIR;
+    } else if (abs_ay > abs_ax && abs_ay > abs_az && abs_ay > FACE_LIMIAR_G) {
+        return (ay > 0) ? FACE_FRENTE : FACE_TRAS;
+    } else if (abs_az > abs_ax && abs_az > abs_ay && abs_az > FACE_LIMIAR_G) {
+        return (az > 0) ? FACE_TOPO : FACE_BASE;
+    }
+    return FACE_MOVENDO;
+}
+
+void face_filtro_reset(face_filtro_t *f) {
+    if (!f) return;
+    f->last_lida = FACE_MOVENDO;
+    f->cont = 0;
+    f->estavel = FACE_MOVENDO;
+}
+
+face_t face_filtro_atualizar(face_filtro_t *f, face_t lida) {
+    if (lida == FACE_MOVENDO) {
+        f->cont = 0;
+        f->last_lida = FACE_MOVENDO;
+        f->estavel = FACE_MOVENDO;
+        return f->estavel;
+    }
+
+    if (lida == f->last_lida) {
+        if (f->cont < 100) f->cont++;
+    } else {
+        f->cont = 0;
+        f->last_lida = lida;
+    }
+
+    if (f->cont >= FACE_ESTABILIDADE_MIN) {
+        f->estavel = lida;
+    }
+    return f->estavel;
+}
+
+const char* face_nome(face_t f) {
+    switch (f) {
+        case FACE_FRENTE: return "FRENTE";
+        case FACE_TRAS:   return "TRAS";
+        case FACE_ESQ:    return "ESQ";
+        case FACE_DIR:    return "DIR";
+        case FACE_BASE:   return "BASE";
+        case FACE_TOPO:   return "TOPO";
+        default:          return "MOV";
+    }
+}
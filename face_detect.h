@@ -0,0 +1,49 @@
+#ifndef FACE_DETECT_H
+#define FACE_DETECT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// FACE DETECT - classificador de face + filtro de estabilidade
+// =====================================================
+//
+// Não depende do SDK da Pico: o mesmo código roda no firmware
+// (mpu6050_freertos.c) e no replay de traces no PC (bench/face_replay.c).
+//
+// Fluxo:
+//   accel bruto (±2g) -> face_classificar() -> face "lida"
+//   face lida         -> face_filtro_atualizar() -> face estável
+// =====================================================
+
+typedef enum {
+    FACE_MOVENDO = -1,
+    FACE_FRENTE = 0,
+    FACE_TRAS,
+    FACE_ESQ,
+    FACE_DIR,
+    FACE_BASE,
+    FACE_TOPO
+} face_t;
+
+#define FACE_SENS_2G          16384.0f  // LSB/g (mesmo valor de ACCEL_SENS_2G)
+#define FACE_LIMIAR_G         0.60f
+#define FACE_ESTABILIDADE_MIN 6
+
+typedef struct {
+    face_t last_lida;
+    int    cont;
+    face_t estavel;
+} face_filtro_t;
+
+// Classifica uma leitura bruta do acelerômetro (range ±2g)
+face_t face_classificar(const int16_t accel[3]);
+
+void   face_filtro_reset(face_filtro_t *f);
+
+// Alimenta o filtro com a face lida no ciclo e retorna a face estável
+face_t face_filtro_atualizar(face_filtro_t *f, face_t lida);
+
+const char* face_nome(face_t f);
+
+#endif // FACE_DETECT_H
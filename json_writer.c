@@ -0,0 +1,182 @@
+#include "json_writer.h"
+
+#include <string.h>
+
+// ============================
+// Saída limitada
+// ============================
+// Sempre sobra 1 byte para o '\0' do jw_finish
+static inline void put(jw_t *w, char c) {
+    if (w->err) return;
+    if ((uint32_t)w->len + 1u >= w->cap) { w->err = true; return; }
+    w->buf[w->len++] = c;
+}
+
+static inline void put_n(jw_t *w, const char *s, size_t n) {
+    if (w->err) return;
+    if ((uint32_t)w->len + n >= w->cap) { w->err = true; return; }
+    memcpy(&w->buf[w->len], s, n);
+    w->len = (uint16_t)(w->len + n);
+}
+
+static inline void val_begin(jw_t *w) {
+    if (w->virgula) put(w, ',');
+}
+
+// dígitos de trás para frente num buffer pequeno (divisão u32: no RP2040
+// vai para o divisor de hardware)
+static void put_u32(jw_t *w, uint32_t v) {
+    char t[10];
+    int i = 10;
+    do {
+        t[--i] = (char)('0' + v % 10u);
+        v /= 10u;
+    } while (v);
+    put_n(w, &t[i], (size_t)(10 - i));
+}
+
+// exatamente 'casas' dígitos, com zeros à esquerda
+static void put_u32_casas(jw_t *w, uint32_t v, uint8_t casas) {
+    char s[10];
+    for (int i = casas - 1; i >= 0; i--) {
+        s[i] = (char)('0' + v % 10u);
+        v /= 10u;
+    }
+    put_n(w, s, casas);
+}
+
+// u64 em pedaços de 9 dígitos: uma divisão de 64 bits por pedaço, o resto em u32
+static void put_u64(jw_t *w, uint64_t v) {
+    if (v <= UINT32_MAX) { put_u32(w, (uint32_t)v); return; }
+    put_u64(w, v / 1000000000u);
+    put_u32_casas(w, (uint32_t)(v % 1000000000u), 9);
+}
+
+// ============================
+// API
+// ============================
+void jw_init(jw_t *w, char *buf, size_t cap) {
+    w->buf = buf;
+    w->cap = (cap > UINT16_MAX) ? UINT16_MAX : (uint16_t)cap;
+    w->len = 0;
+    w->err = (cap == 0);
+    w->virgula = false;
+}
+
+void jw_obj_begin(jw_t *w) { val_begin(w); put(w, '{'); w->virgula = false; }
+void jw_obj_end(jw_t *w)   { put(w, '}'); w->virgula = true; }
+void jw_arr_begin(jw_t *w) { val_begin(w); put(w, '['); w->virgula = false; }
+void jw_arr_end(jw_t *w)   { put(w, ']'); w->virgula = true; }
+
+void jw_key(jw_t *w, const char *key) {
+    val_begin(w);
+    put(w, '"');
+    put_n(w, key, strlen(key));
+    put_n(w, "\":", 2);
+    w->virgula = false;
+}
+
+void jw_str(jw_t *w, const char *s) {
+    static const char HEX[] = "0123456789abcdef";
+
+    val_begin(w);
+    put(w, '"');
+    for (; *s; s++) {
+        uint8_t c = (uint8_t)*s;
+        if (c == '"' || c == '\\') {
+            put(w, '\\');
+            put(w, (char)c);
+        } else if (c < 0x20) {
+            switch (c) {
+                case '\n': put_n(w, "\\n", 2); break;
+                case '\r': put_n(w, "\\r", 2); break;
+                case '\t': put_n(w, "\\t", 2); break;
+                default: {
+                    char u[6] = { '\\', 'u', '0', '0', HEX[c >> 4], HEX[c & 0x0F] };
+                    put_n(w, u, sizeof(u));
+                }
+            }
+        } else {
+            put(w, (char)c);   // UTF-8 passa como está
+        }
+    }
+    put(w, '"');
+    w->virgula = true;
+}
+
+void jw_u32(jw_t *w, uint32_t v) {
+    val_begin(w);
+    put_u32(w, v);
+    w->virgula = true;
+}
+
+void jw_i32(jw_t *w, int32_t v) {
+    val_begin(w);
+    if (v < 0) put(w, '-');
+    put_u32(w, (v < 0) ? 0u - (uint32_t)v : (uint32_t)v);
+    w->virgula = true;
+}
+
+void jw_i64(jw_t *w, int64_t v) {
+    val_begin(w);
+    if (v < 0) put(w, '-');
+    put_u64(w, (v < 0) ? 0u - (uint64_t)v : (uint64_t)v);
+    w->virgula = true;
+}
+
+void jw_bool(jw_t *w, bool v) {
+    val_begin(w);
+    if (v) put_n(w, "true", 4);
+    else   put_n(w, "false", 5);
+    w->virgula = true;
+}
+
+void jw_null(jw_t *w) {
+    val_begin(w);
+    put_n(w, "null", 4);
+    w->virgula = true;
+}
+
+void jw_fix(jw_t *w, float v, uint8_t casas) {
+    static const uint32_t POT10[JW_FIX_MAX_CASAS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+    if (v != v || v > 3.4e38f || v < -3.4e38f) { jw_null(w); return; }   // NaN/inf
+    if (casas > JW_FIX_MAX_CASAS) casas = JW_FIX_MAX_CASAS;
+
+    bool neg = (v < 0.0f);
+    float a = (neg ? -v : v) * (float)POT10[casas] + 0.5f;
+    if (a >= 1.8e19f) { jw_null(w); return; }   // não cabe nem em u64
+
+    val_begin(w);
+    if (a < 4294967040.0f) {
+        // caminho normal: tudo em u32
+        uint32_t q = (uint32_t)a;
+        if (neg && q) put(w, '-');
+        put_u32(w, q / POT10[casas]);
+        if (casas) {
+            put(w, '.');
+            put_u32_casas(w, q % POT10[casas], casas);
+        }
+    } else {
+        uint64_t q = (uint64_t)a;
+        if (neg) put(w, '-');
+        put_u64(w, q / POT10[casas]);
+        if (casas) {
+            put(w, '.');
+            put_u32_casas(w, (uint32_t)(q % POT10[casas]), casas);
+        }
+    }
+    w->virgula = true;
+}
+
+void jw_raw(jw_t *w, const char *json, size_t n) {
+    val_begin(w);
+    put_n(w, json, n);
+    w->virgula = true;
+}
+
+size_t jw_finish(jw_t *w) {
+    if (w->cap == 0) return 0;
+    w->buf[w->len] = '\0';
+    return w->err ? 0 : w->len;
+}
@@ -0,0 +1,64 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// =====================================================
+// JSON_WRITER - JSON em streaming num buffer fixo
+// =====================================================
+//
+// Para a telemetria do MQTT (mqtt.c), no lugar do snprintf:
+//   - sem heap e sem printf: números em inteiro (u32/i64) e float em ponto
+//     fixo (jw_fix: escala por 10^casas e imprime como inteiro), nada de
+//     %f em soft-float no M0+
+//   - strings com escape (nome do usuário vem do Serial/ThingsBoard: aspas,
+//     barra e controle viram \", \\, \uXXXX)
+//   - nunca escreve além de cap: o que não cabe liga err e o resto vira
+//     no-op. Para desfazer um item que não coube, guardar uma cópia do
+//     jw_t antes e restaurar (o conteúdo além de len não importa)
+//   - vírgulas automáticas entre itens de objeto/array
+//
+// NaN/inf (não existem em JSON) saem como null.
+// bench/json_bench.c compara com o caminho snprintf no PC; no alvo, o
+// hot_bench (HOT_BENCH=1) mede os dois.
+// =====================================================
+
+#define JW_FIX_MAX_CASAS 6
+
+typedef struct {
+    char    *buf;
+    uint16_t cap;       // bytes do buffer, contando o '\0'
+    uint16_t len;
+    bool     err;       // algo não coube
+    bool     virgula;   // o próximo item leva ',' antes
+} jw_t;
+
+void jw_init(jw_t *w, char *buf, size_t cap);
+
+void jw_obj_begin(jw_t *w);
+void jw_obj_end(jw_t *w);
+void jw_arr_begin(jw_t *w);
+void jw_arr_end(jw_t *w);
+
+// "chave": (a chave não passa pelo escape: usar literais)
+void jw_key(jw_t *w, const char *key);
+
+void jw_str(jw_t *w, const char *s);
+void jw_u32(jw_t *w, uint32_t v);
+void jw_i32(jw_t *w, int32_t v);
+void jw_i64(jw_t *w, int64_t v);
+void jw_bool(jw_t *w, bool v);
+void jw_null(jw_t *w);
+
+// v com 'casas' decimais (0..JW_FIX_MAX_CASAS), arredondado como o %.Nf
+void jw_fix(jw_t *w, float v, uint8_t casas);
+
+// Valor já em JSON (ex.: montado antes por outro jw_t)
+void jw_raw(jw_t *w, const char *json, size_t n);
+
+// Fecha com '\0'. Retorna o tamanho (sem o '\0') ou 0 se não coube.
+size_t jw_finish(jw_t *w);
+
+#endif // JSON_WRITER_H
@@ -5,21 +5,40 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include <ctype.h>
 
 #include "pico/stdlib.h"
-#include "pico/cyw43_arch.h"
+#include "pico/unique_id.h"
+#include "pico/rand.h"
 
 #include "FreeRTOS.h"
 #include "task.h"
-#include "queue.h"
+#include "message_buffer.h"
 
 #include "lwip/pbuf.h"
 #include "lwip/udp.h"
 #include "lwip/ip_addr.h"
 
+// 0 = sem outbox na flash (eventos além da janela esperam no message buffer)
+#ifndef LR_OUTBOX_ENABLE
+#define LR_OUTBOX_ENABLE 1
+#endif
+
+#if LR_OUTBOX_ENABLE
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#endif
+
 // Se seu mic_get_last estiver em outro header, ajuste aqui:
 #include "mic.h"
+#include "lr_proto.h"
+#include "lr_rel.h"
+#include "net_sup.h"
+#include "net_io.h"
+#if LR_OUTBOX_ENABLE
+#include "lr_outbox.h"
+#endif
 
 // ============================
 // Config
@@ -32,26 +51,87 @@
 #define LOCAL_SERVER_PORT 5000
 #endif
 
-#define LR_QUEUE_LEN     24
-#define LR_PAYLOAD_MAX   256
-#define LR_USER_MAX      32
+// Eventos codificados (lr_proto.h) vão em dois message buffers de tamanho
+// variável (4 B de cabeçalho por mensagem, ~90 B por evento típico):
+//   - normal: ok/err (~22 eventos)
+//   - prioridade: start/stop, que fecham a sessão no relatório e não podem
+//     ficar sem espaço por causa de uma rajada de ok/err
+// Cheio = o evento novo é descartado e contado (o message buffer só tem um
+// leitor, o produtor não pode tirar o mais antigo).
+// Os eventos do link (net_sup.h) vêm da NetSup: buffer próprio, para cada
+// buffer continuar com um escritor só (regra do FreeRTOS).
+#define LR_MB_BYTES      2048
+#define LR_MB_PRIO_BYTES 512
+#define LR_MB_NET_BYTES  192
+
+// Envio em lote: vários eventos por datagrama (lr_proto.h), até o tamanho
+// de um MTU. Sai quando o próximo não cabe, LR_BATCH_DEADLINE_MS depois do
+// primeiro evento do lote, ou na hora se entrou um start/stop.
+// As rodadas ficam a 1 s ou mais uma da outra: quase todo o ganho vem de
+// juntar a fila que acumula numa travada do Wi-Fi, que sai junta com
+// qualquer prazo. Prazo longo só atrasa (bench/lr_proto_bench.c); 20 ms
+// junta os eventos da mesma volta do laço do jogo (LOOP_MS = 40).
+#ifndef LR_BATCH_DEADLINE_MS
+#define LR_BATCH_DEADLINE_MS 20
+#endif
+#define LR_STATS_LOG_MS      10000
+#define LR_USER_MAX      LR_PROTO_USER_MAX
 #define LR_SERIAL_BUF    64
 
-#define LR_TASK_STACK    2048
-#define LR_TASK_PRIO     (tskIDLE_PRIORITY + 2)
+// Outbox na flash (lr_outbox.h): o que não cabe na janela de retransmissão
+// espera no fim da flash (256 KB = ~2.500 eventos) e sai em ordem quando o
+// servidor volta, inclusive depois de um reboot. Gravar/apagar para os dois
+// núcleos (flash_safe_execute): ~0,4 ms por página, ~45 ms por setor. Acontece
+// com a rede fora e também com ela no ar e a janela cheia (lr_take). O setor
+// seguinte é apagado logo depois de cada flush (lr_ob_prepare), fora do
+// append; os ~45 ms são mais que 3 blocos do DMA do microfone, que fica
+// parado durante o apagamento (mic_capture_pause, blocos contados como
+// overruns). A página em RAM vai para a flash LR_OB_FLUSH_MS depois do
+// primeiro registro (perde no máximo isso numa queda de energia).
+#if LR_OUTBOX_ENABLE
+#define LR_OB_BYTES       (256u * 1024u)
+#define LR_OB_OFFSET      (PICO_FLASH_SIZE_BYTES - LR_OB_BYTES)
+#define LR_OB_FLUSH_MS    2000
+#define LR_FLASH_TIMEOUT_MS 1000   // para conseguir parar o outro núcleo
+#endif
 
-// ============================
-// Tipos
-// ============================
-typedef struct {
-    char json[LR_PAYLOAD_MAX];
-} lr_msg_t;
+#define LR_TASK_STACK    2048   // palavras; até medir o [STACK] LocalUDP
+#define LR_TASK_PRIO     (tskIDLE_PRIORITY + 2)
+#define LR_TASK_CORES    (1u << 0)   // rede no core 0, junto do cyw43/lwIP
 
 // ============================
 // Estado interno
 // ============================
-static QueueHandle_t g_lr_q = NULL;
-static TaskHandle_t  g_lr_task = NULL;
+static MessageBufferHandle_t g_lr_mb = NULL;
+static MessageBufferHandle_t g_lr_mb_prio = NULL;
+static MessageBufferHandle_t g_lr_mb_net = NULL;
+static TaskHandle_t          g_lr_task = NULL;
+static uint32_t              g_lr_drops_cheio = 0;   // GameTask: buffer sem espaço
+
+// tudo estático: buffers e pilha da task não saem do heap
+static StaticMessageBuffer_t g_lr_mb_buf, g_lr_mb_prio_buf, g_lr_mb_net_buf;
+static uint8_t               g_lr_mb_store[LR_MB_BYTES + 1];
+static uint8_t               g_lr_mb_prio_store[LR_MB_PRIO_BYTES + 1];
+static uint8_t               g_lr_mb_net_store[LR_MB_NET_BYTES + 1];
+static StaticTask_t          g_lr_tcb;
+static StackType_t           g_lr_stack[LR_TASK_STACK];
+
+// janela de retransmissão (lr_rel.h) e lote em montagem: só a task
+// lr_udp mexe; o callback de recepção só escreve g_ack_rx
+static lr_rel_t          g_rel;
+static uint8_t           g_batch_buf[LR_PROTO_BATCH_MAX];
+static lr_batch_t        g_batch;
+static uint64_t          g_new_t0_us = 0;   // chegada do evento novo mais antigo
+static volatile uint32_t g_ack_rx = 0;      // maior ACK cumulativo recebido
+static uint32_t          g_st_datagramas = 0;
+static uint32_t          g_st_envio_us = 0, g_st_envio_max_us = 0;   // net_io_call do lote
+
+#if LR_OUTBOX_ENABLE
+static lr_outbox_t       g_ob;
+static bool              g_ob_ok = false;
+static uint64_t          g_ob_t0_us = 0;    // algo só na RAM desde (0 = nada)
+static uint32_t          g_ob_erros = 0;
+#endif
 
 static struct udp_pcb *g_pcb = NULL;
 static ip_addr_t g_dst_ip;
@@ -62,6 +142,8 @@ static bool     g_session_open = false;
 static uint32_t g_session_id = 0;
 static uint32_t g_session_start_ts = 0;
 
+static uint32_t g_device_id = 0;
+
 // ============================
 // Utils
 // ============================
@@ -74,26 +156,68 @@ static const char* safe_user(void) {
     return (g_user[0] == '\0') ? "" : g_user;
 }
 
-static void lr_send_json(const char *json) {
-    if (!g_lr_q || !json) return;
+// Preenche o cabeçalho comum, codifica e envia para o message buffer.
+// Um escritor só por buffer (regra do FreeRTOS): os eventos do jogo saem
+// da GameTask, os do link (LR_EV_NET) da NetSup.
+static void lr_send_event(lr_event_t *ev) {
+    if (!g_lr_mb) return;
+
+    ev->device = g_device_id;
+    ev->session = (uint16_t)g_session_id;
+    ev->seq = 0;   // carimbado ao entrar na janela de retransmissão
+    ev->ts_us = time_us_64();
+    ev->user = (ev->tipo == LR_EV_NET) ? "" : safe_user();   // g_user é da GameTask
 
-    lr_msg_t m;
-    memset(&m, 0, sizeof(m));
-    strncpy(m.json, json, sizeof(m.json) - 1);
-    m.json[sizeof(m.json) - 1] = '\0';
+    uint8_t buf[LR_PROTO_MAX_LEN];
+    size_t n = lr_proto_encode(ev, buf, sizeof(buf));
+    if (n == 0) return;
 
-    if (xQueueSend(g_lr_q, &m, 0) != pdTRUE) {
-        // fila cheia: descarta 1 item e tenta de novo (não perde STOP)
-        lr_msg_t drop;
-        (void)xQueueReceive(g_lr_q, &drop, 0);
-        (void)xQueueSend(g_lr_q, &m, 0);
+    MessageBufferHandle_t mb = g_lr_mb;
+    if (ev->tipo == LR_EV_START || ev->tipo == LR_EV_STOP) mb = g_lr_mb_prio;
+    else if (ev->tipo == LR_EV_NET) mb = g_lr_mb_net;
+    if (xMessageBufferSend(mb, buf, n, 0) != n) {
+        g_lr_drops_cheio++;
+        return;
     }
+    xTaskNotifyGive(g_lr_task);
+}
+
+// ACK do servidor: chega no contexto do lwIP (tcpip_thread, ou IRQ do
+// cyw43 sem LWIP_SYS_FREERTOS), só guarda o maior seq e acorda a task
+static void lr_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p,
+                        const ip_addr_t *addr, u16_t port) {
+    (void)arg; (void)pcb; (void)addr; (void)port;
+
+    uint8_t  buf[LR_PROTO_ACK_LEN];
+    uint32_t boot, seq;
+    if (p->tot_len == LR_PROTO_ACK_LEN &&
+        pbuf_copy_partial(p, buf, LR_PROTO_ACK_LEN, 0) == LR_PROTO_ACK_LEN &&
+        lr_proto_parse_ack(buf, LR_PROTO_ACK_LEN, &boot, &seq) &&
+        boot == g_rel.boot) {
+        if (lr_seq_before(g_ack_rx, seq)) g_ack_rx = seq;
+
+        if (portCHECK_IF_IN_ISR()) {
+            BaseType_t woken = pdFALSE;
+            vTaskNotifyGiveFromISR(g_lr_task, &woken);
+            portYIELD_FROM_ISR(woken);
+        } else {
+            xTaskNotifyGive(g_lr_task);
+        }
+    }
+    pbuf_free(p);
+}
+
+// net_io (dono do lwIP)
+static void lr_udp_open_fn(void *arg) {
+    (void)arg;
+    g_pcb = udp_new();
+    if (g_pcb) udp_recv(g_pcb, lr_udp_recv, NULL);   // ACKs voltam na mesma porta
 }
 
 static void lr_udp_init_once(void) {
     if (g_pcb) return;
 
-    g_pcb = udp_new();
+    (void)net_io_call(lr_udp_open_fn, NULL);
     if (!g_pcb) {
         printf("[LOCAL] ERRO: udp_new falhou\n");
         return;
@@ -103,20 +227,213 @@ static void lr_udp_init_once(void) {
     printf("[LOCAL] UDP pronto -> %s:%d\n", LOCAL_SERVER_IP, LOCAL_SERVER_PORT);
 }
 
-static void lr_udp_send_now(const char *json) {
-    if (!g_pcb) return;
-    if (!json) return;
+// Manda o lote como está. O pbuf aponta para g_batch_buf (PBUF_REF): sem
+// cópia e sem tirar ~1,4 KB do heap do lwIP (MEM_SIZE); o cyw43 copia o
+// quadro ao transmitir e o etharp clona pbufs REF se precisar enfileirar.
+// net_io_call só volta depois do envio, então o próximo lote pode
+// reaproveitar g_batch_buf. Se falhar, a janela de retransmissão manda de novo.
+static void lr_batch_send_fn(void *arg) {
+    (void)arg;
+    struct pbuf *p = g_pcb ? pbuf_alloc(PBUF_TRANSPORT, (u16_t)g_batch.len, PBUF_REF) : NULL;
+    if (p) {
+        p->payload = g_batch_buf;
+        if (udp_sendto(g_pcb, p, &g_dst_ip, LOCAL_SERVER_PORT) == ERR_OK) g_st_datagramas++;
+        pbuf_free(p);
+    }
+}
 
-    size_t n = strlen(json);
-    if (n == 0) return;
-    if (n > (LR_PAYLOAD_MAX - 1)) n = (LR_PAYLOAD_MAX - 1);
+static void lr_batch_send(void) {
+    uint32_t t0 = time_us_32();
+    (void)net_io_call(lr_batch_send_fn, NULL);
+    uint32_t dt = time_us_32() - t0;
+    g_st_envio_us += dt;
+    if (dt > g_st_envio_max_us) g_st_envio_max_us = dt;
+}
 
-    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, (u16_t)n, PBUF_RAM);
-    if (!p) return;
+// Envia tudo que venceu (eventos novos + retransmissões), em quantos lotes
+// forem precisos
+static void lr_send_due(void) {
+    for (;;) {
+        lr_batch_reset(&g_batch);
+        if (lr_rel_build(&g_rel, &g_batch, time_us_64()) == 0) break;
+        lr_batch_send();
+    }
+}
 
-    memcpy(p->payload, json, n);
-    udp_sendto(g_pcb, p, &g_dst_ip, LOCAL_SERVER_PORT);
-    pbuf_free(p);
+#if LR_OUTBOX_ENABLE
+// ============================
+// Flash do outbox
+// ============================
+typedef struct {
+    uint32_t       off;
+    const uint8_t *data;
+} lr_flash_op_t;
+
+static void lr_flash_erase_fn(void *param) {
+    const lr_flash_op_t *op = param;
+    flash_range_erase(op->off, FLASH_SECTOR_SIZE);
+}
+
+static void lr_flash_prog_fn(void *param) {
+    const lr_flash_op_t *op = param;
+    flash_range_program(op->off, op->data, LR_OB_PAGE);
+}
+
+// flash_safe_execute para o outro núcleo (MicTask) enquanto a XIP está fora;
+// no apagamento a parada passa de um bloco do DMA, então a captura para antes
+static bool lr_flash_erase(void *ctx, uint32_t off) {
+    (void)ctx;
+    lr_flash_op_t op = { LR_OB_OFFSET + off, NULL };
+    mic_capture_pause();
+    bool ok = flash_safe_execute(lr_flash_erase_fn, &op, LR_FLASH_TIMEOUT_MS) == PICO_OK;
+    mic_capture_resume();
+    return ok;
+}
+
+static bool lr_flash_prog(void *ctx, uint32_t off, const uint8_t *page) {
+    (void)ctx;
+    lr_flash_op_t op = { LR_OB_OFFSET + off, page };
+    return flash_safe_execute(lr_flash_prog_fn, &op, LR_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+static void lr_ob_init(void) {
+    extern char __flash_binary_end;
+    if ((uintptr_t)&__flash_binary_end - XIP_BASE > LR_OB_OFFSET) {
+        printf("[LOCAL] outbox desligado: firmware invade a região da flash\n");
+        return;
+    }
+
+    const lr_ob_flash_t fl = {
+        .mem = (const uint8_t *)(XIP_BASE + LR_OB_OFFSET),
+        .size = LR_OB_BYTES,
+        .erase = lr_flash_erase,
+        .prog = lr_flash_prog,
+    };
+    g_ob_ok = lr_ob_mount(&g_ob, &fl);
+    if (!g_ob_ok) return;
+
+    // com o outbox atrás, a janela não desiste: espera o servidor voltar
+    g_rel.max_tries = 0;
+    printf("[LOCAL] outbox: %lu eventos pendentes na flash\n",
+           (unsigned long)(g_ob.next_rid - g_ob.rd_rid));
+}
+
+// Grava a página em RAM / o cursor LR_OB_FLUSH_MS depois de sujar, e já
+// apaga o setor seguinte (o append não para no meio de uma rajada)
+static void lr_ob_tick(uint64_t agora) {
+    if (!g_ob_ok) return;
+    lr_ob_consume(&g_ob, g_rel.done_tag);
+
+    if (!lr_ob_dirty(&g_ob)) {
+        g_ob_t0_us = 0;
+    } else if (!g_ob_t0_us) {
+        g_ob_t0_us = agora;
+    } else if (agora - g_ob_t0_us >= (uint64_t)LR_OB_FLUSH_MS * 1000u) {
+        if (!lr_ob_flush(&g_ob)) g_ob_erros++;
+        lr_ob_prepare(&g_ob);
+        g_ob_t0_us = 0;
+    }
+}
+
+// Tira do outbox para a janela, em ordem, enquanto houver espaço
+static bool lr_replay(void) {
+    bool algum = false;
+
+    while (g_ob_ok && !lr_rel_full(&g_rel)) {
+        uint8_t type, n;
+        uint32_t rid;
+        const uint8_t *src = lr_ob_read(&g_ob, &type, &n, &rid);
+        if (!src) break;
+
+        uint8_t *dst = (type == LR_OB_T_EVENT) ? lr_rel_reserve(&g_rel, n) : NULL;
+        if (!dst) {
+            lr_ob_consume(&g_ob, rid);   // registro inválido: pula
+            continue;
+        }
+        memcpy(dst, src, n);
+        if (rid < g_ob.boot_rid) dst[LR_PROTO_TIPO_OFFSET] |= LR_EV_FLAG_BOOT_ANT;
+
+        if (!lr_rel_has_new(&g_rel)) g_new_t0_us = time_us_64();
+        lr_rel_commit(&g_rel, rid);
+        algum = true;
+    }
+    return algum;
+}
+#endif
+
+// Tira uma mensagem do buffer direto para a janela de retransmissão.
+// Com o outbox, sem link (ou se já há fila na flash, ou a janela está
+// cheia) a mensagem vai para o fim dela: o que foi gerado offline chega à
+// flash no próximo flush (LR_OB_FLUSH_MS) e sobrevive a um reboot; o
+// lr_replay a devolve à janela, na ordem. Sem outbox, retorna false com a
+// janela cheia (a mensagem fica no buffer até um ACK liberar espaço).
+static bool lr_take(MessageBufferHandle_t mb) {
+    size_t n = xMessageBufferNextLengthBytes(mb);
+    if (n == 0) return false;
+
+#if LR_OUTBOX_ENABLE
+    if (g_ob_ok && (!net_sup_is_up() || lr_ob_pending(&g_ob) || lr_rel_full(&g_rel))) {
+        uint8_t buf[LR_PROTO_MAX_LEN];
+        (void)xMessageBufferReceive(mb, buf, sizeof(buf), 0);
+        if (!lr_ob_append(&g_ob, LR_OB_T_EVENT, buf, (uint8_t)n)) g_ob_erros++;
+        return true;
+    }
+#endif
+
+    bool tinha_novo = lr_rel_has_new(&g_rel);
+    uint8_t *dst = lr_rel_reserve(&g_rel, (uint8_t)n);
+    if (!dst) return false;
+    (void)xMessageBufferReceive(mb, dst, n, 0);
+    lr_rel_commit(&g_rel, 0);
+
+    if (!tinha_novo) g_new_t0_us = time_us_64();
+    return true;
+}
+
+static void lr_stats_log(void) {
+    static uint64_t ultimo_us = 0;
+    static uint32_t drops_log = 0;   // descartes já mostrados
+
+    uint64_t agora = time_us_64();
+    if (agora - ultimo_us < (uint64_t)LR_STATS_LOG_MS * 1000u) return;
+    ultimo_us = agora;
+
+    lr_rel_t *r = &g_rel;
+    if (r->st_tx) {
+        printf("[LOCAL] %lu envios em %lu datagramas (udp_sendto médio %lu us, máx %lu us) | entregues %lu (evento->ACK médio %lu ms, máx %lu ms) | retx %lu, desistiu %lu\n",
+               (unsigned long)r->st_tx, (unsigned long)g_st_datagramas,
+               (unsigned long)(g_st_datagramas ? g_st_envio_us / g_st_datagramas : 0),
+               (unsigned long)g_st_envio_max_us, (unsigned long)r->st_acked,
+               (unsigned long)(r->st_lat_n ? r->st_lat_sum_us / r->st_lat_n / 1000u : 0),
+               (unsigned long)(r->st_lat_max_us / 1000u),
+               (unsigned long)r->st_retx, (unsigned long)r->st_desist);
+        r->st_tx = r->st_acked = r->st_retx = r->st_desist = 0;
+        r->st_lat_n = 0;
+        r->st_lat_sum_us = 0;
+        r->st_lat_max_us = 0;
+        g_st_datagramas = 0;
+        g_st_envio_us = g_st_envio_max_us = 0;
+    }
+
+#if LR_OUTBOX_ENABLE
+    lr_outbox_t *ob = &g_ob;
+    if (g_ob_ok && (ob->st_append || ob->st_read || ob->st_lost)) {
+        printf("[LOCAL] outbox: +%lu eventos (%lu B), replay %lu, pendentes %lu | flash: %lu páginas, %lu apagamentos, ampl %lu%% | perdidos %lu, erros %lu\n",
+               (unsigned long)ob->st_append, (unsigned long)ob->st_append_bytes,
+               (unsigned long)ob->st_read, (unsigned long)(ob->next_rid - ob->rd_rid),
+               (unsigned long)ob->st_pages, (unsigned long)ob->st_erases,
+               (unsigned long)(ob->st_append_bytes ? (uint64_t)ob->st_pages * LR_OB_PAGE * 100u / ob->st_append_bytes : 0),
+               (unsigned long)ob->st_lost, (unsigned long)g_ob_erros);
+        ob->st_append = ob->st_append_bytes = ob->st_read = 0;
+        ob->st_pages = ob->st_erases = ob->st_dropped = ob->st_lost = 0;
+    }
+#endif
+
+    uint32_t cheio = g_lr_drops_cheio;
+    if (cheio != drops_log) {
+        drops_log = cheio;
+        printf("[LOCAL] eventos descartados (buffer cheio): %lu\n", (unsigned long)cheio);
+    }
 }
 
 // ============================
@@ -124,13 +441,63 @@ static void lr_udp_send_now(const char *json) {
 // ============================
 static void lr_task_fn(void *p) {
     (void)p;
+    lr_batch_init(&g_batch, g_batch_buf, sizeof(g_batch_buf));
+#if LR_OUTBOX_ENABLE
+    lr_ob_init();   // varre a flash (~0,3 s); aqui para não atrasar o boot
+#endif
+    // o lwIP só existe depois do cyw43_arch_init da NetSup; até lá os
+    // eventos esperam nos message buffers
+    net_sup_wait(NET_SUP_BIT_STACK, portMAX_DELAY);
     lr_udp_init_once();
 
+    const uint64_t prazo_us = (uint64_t)LR_BATCH_DEADLINE_MS * 1000u;
+
     for (;;) {
-        lr_msg_t m;
-        if (xQueueReceive(g_lr_q, &m, portMAX_DELAY) == pdTRUE) {
-            lr_udp_send_now(m.json);
+        // dorme até o prazo do lote novo ou a próxima retransmissão. Sem
+        // link não envia nada (nem gasta tentativas da janela): só acorda
+        // para o flush do outbox, para eventos novos e quando o link volta
+        // (o evento LR_EV_NET acorda a task)
+        bool link = net_sup_is_up();
+        uint64_t agora = time_us_64();
+        uint64_t acorda = link ? lr_rel_next_due(&g_rel) : UINT64_MAX;
+        if (link && lr_rel_has_new(&g_rel) && g_new_t0_us + prazo_us < acorda) acorda = g_new_t0_us + prazo_us;
+#if LR_OUTBOX_ENABLE
+        if (g_ob_t0_us && g_ob_t0_us + (uint64_t)LR_OB_FLUSH_MS * 1000u < acorda) {
+            acorda = g_ob_t0_us + (uint64_t)LR_OB_FLUSH_MS * 1000u;
+        }
+#endif
+
+        TickType_t espera = portMAX_DELAY;
+        if (acorda != UINT64_MAX) {
+            espera = (acorda <= agora) ? 0 : pdMS_TO_TICKS((uint32_t)((acorda - agora + 999) / 1000));
+        }
+        (void)ulTaskNotifyTake(pdTRUE, espera);
+
+        lr_rel_ack(&g_rel, g_ack_rx, time_us_64());
+
+        // o que esperava na flash entra antes dos eventos novos
+        bool urgente = false;
+#if LR_OUTBOX_ENABLE
+        urgente = lr_replay();
+#endif
+
+        // prioridade (e link) primeiro, e de novo entre cada evento normal
+        for (;;) {
+            if (lr_take(g_lr_mb_prio) || lr_take(g_lr_mb_net)) { urgente = true; continue; }
+            if (!lr_take(g_lr_mb)) break;
         }
+#if LR_OUTBOX_ENABLE
+        if (lr_replay()) urgente = true;   // o que acabou de ir para o outbox
+#endif
+
+        agora = time_us_64();
+        bool novo = lr_rel_has_new(&g_rel) && (urgente || agora - g_new_t0_us >= prazo_us);
+        if (net_sup_is_up() && (novo || lr_rel_next_due(&g_rel) <= agora)) lr_send_due();
+
+#if LR_OUTBOX_ENABLE
+        lr_ob_tick(agora);
+#endif
+        lr_stats_log();
     }
 }
 
@@ -138,22 +505,28 @@ static void lr_task_fn(void *p) {
 // API pública
 // ============================
 void local_report_init(void) {
-    if (g_lr_q) return;
+    if (g_lr_mb) return;
 
-    g_lr_q = xQueueCreate(LR_QUEUE_LEN, sizeof(lr_msg_t));
-    if (!g_lr_q) {
-        printf("[LOCAL] ERRO: xQueueCreate falhou\n");
-        return;
+    // id do device: os 8 bytes do id único da flash dobrados em 32 bits
+    pico_unique_board_id_t id;
+    pico_get_unique_board_id(&id);
+    for (int i = 0; i < PICO_UNIQUE_BOARD_ID_SIZE_BYTES; i++) {
+        g_device_id ^= (uint32_t)id.id[i] << (8 * (i & 3));
     }
 
-    BaseType_t ok = xTaskCreate(lr_task_fn, "lr_udp", LR_TASK_STACK, NULL, LR_TASK_PRIO, &g_lr_task);
-    if (ok != pdPASS) {
-        printf("[LOCAL] ERRO: xTaskCreate falhou\n");
-        g_lr_task = NULL;
-        return;
-    }
+    // boot sorteado: o servidor separa o seq deste boot do anterior; a
+    // sessão também começa num número sorteado, para não misturar no
+    // relatório com as do boot anterior que saírem do outbox
+    lr_rel_init(&g_rel, get_rand_32());
+    g_session_id = get_rand_32() & 0xFFFFu;
+
+    g_lr_mb      = xMessageBufferCreateStatic(LR_MB_BYTES, g_lr_mb_store, &g_lr_mb_buf);
+    g_lr_mb_prio = xMessageBufferCreateStatic(LR_MB_PRIO_BYTES, g_lr_mb_prio_store, &g_lr_mb_prio_buf);
+    g_lr_mb_net  = xMessageBufferCreateStatic(LR_MB_NET_BYTES, g_lr_mb_net_store, &g_lr_mb_net_buf);
+    g_lr_task = xTaskCreateStaticAffinitySet(lr_task_fn, "lr_udp", LR_TASK_STACK, NULL, LR_TASK_PRIO,
+                                             g_lr_stack, &g_lr_tcb, LR_TASK_CORES);
 
-    printf("[LOCAL] init OK\n");
+    printf("[LOCAL] init OK (device %08lx)\n", (unsigned long)g_device_id);
 }
 
 void local_report_new_session(void) {
@@ -246,7 +619,7 @@ void local_report_process_serial(void) {
 // =====================
 // Eventos do jogo
 // =====================
-void local_report_event_start(const char *modo) {
+void local_report_event_start(lr_modo_t modo) {
     uint32_t ts = lr_now_ms();
 
     if (g_session_open) {
@@ -257,92 +630,82 @@ void local_report_event_start(const char *modo) {
     g_session_open = true;
     g_session_id++;
     g_session_start_ts = ts;
+    mic_reset_stats(MIC_STATS_SESSION);
 
-    char j[LR_PAYLOAD_MAX];
-    snprintf(j, sizeof(j),
-             "{\"event\":\"start\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\",\"ts\":%u}",
-             safe_user(), (unsigned)g_session_id, modo ? modo : "", (unsigned)ts);
-
-    lr_send_json(j);
+    lr_event_t ev = { .tipo = LR_EV_START, .modo = (uint8_t)modo };
+    lr_send_event(&ev);
 }
 
-static void lr_get_mic(float *mf, float *mi, uint8_t *mt) {
-    if (mf) *mf = 0.0f;
-    if (mi) *mi = 0.0f;
-    if (mt) *mt = 0;
-
-    // Se sua função tiver outro nome, ajuste aqui
-    mic_get_last(mf, mi, mt);
+// resumo do microfone no intervalo (rodada ou sessão), em vez do último quadro:
+// médias + contagem, pico/desvio do rms e histograma do sound_type
+static void lr_fill_mic(lr_ev_mic_t *m, mic_stats_scope_t scope) {
+    mic_stats_t s;
+    mic_get_stats(scope, &s, scope == MIC_STATS_ROUND);
+
+    m->freq      = s.freq.mean;
+    m->intensity = s.intensity.mean;
+    m->rms       = s.rms.mean;
+    m->centroid  = s.centroid.mean;
+    m->flatness  = s.flatness.mean;
+    m->rms_max   = s.rms.max;
+    m->rms_sd    = sqrtf(mic_welford_var(&s.rms));
+    m->top_type  = mic_stats_top_type(&s);
+    m->frames    = s.frames;
+    for (int i = 0; i < 4; i++) m->hist[i] = s.type_hist[i];
 }
 
 void local_report_event_ok(uint32_t last_ms, uint32_t avg_ms,
                            uint32_t ok_total, uint32_t err_total,
-                           const char *modo) {
+                           lr_modo_t modo) {
     if (!g_session_open) return;
 
-    float mf, mi; uint8_t mt;
-    lr_get_mic(&mf, &mi, &mt);
-
-    char j[LR_PAYLOAD_MAX];
-    snprintf(j, sizeof(j),
-             "{\"event\":\"ok\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\","
-             "\"mic_freq\":%.1f,\"mic_int\":%.3f,\"mic_type\":%u,"
-             "\"last_ms\":%u,\"avg_ms\":%u,\"ok_total\":%u,\"err_total\":%u,\"ts\":%u}",
-             safe_user(), (unsigned)g_session_id, modo ? modo : "",
-             mf, mi, (unsigned)mt,
-             (unsigned)last_ms, (unsigned)avg_ms,
-             (unsigned)ok_total, (unsigned)err_total,
-             (unsigned)lr_now_ms());
-
-    lr_send_json(j);
+    lr_event_t ev = {
+        .tipo = LR_EV_OK, .modo = (uint8_t)modo,
+        .last_ms = last_ms, .avg_ms = avg_ms,
+        .ok_total = (uint16_t)ok_total, .err_total = (uint16_t)err_total,
+    };
+    lr_fill_mic(&ev.mic, MIC_STATS_ROUND);
+    lr_send_event(&ev);
 }
 
 void local_report_event_err(uint32_t last_ms,
                             uint32_t ok_total, uint32_t err_total,
-                            const char *modo) {
+                            lr_modo_t modo) {
     if (!g_session_open) return;
 
-    float mf, mi; uint8_t mt;
-    lr_get_mic(&mf, &mi, &mt);
-
-    char j[LR_PAYLOAD_MAX];
-    snprintf(j, sizeof(j),
-             "{\"event\":\"err\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\","
-             "\"mic_freq\":%.1f,\"mic_int\":%.3f,\"mic_type\":%u,"
-             "\"last_ms\":%u,\"ok_total\":%u,\"err_total\":%u,\"ts\":%u}",
-             safe_user(), (unsigned)g_session_id, modo ? modo : "",
-             mf, mi, (unsigned)mt,
-             (unsigned)last_ms,
-             (unsigned)ok_total, (unsigned)err_total,
-             (unsigned)lr_now_ms());
-
-    lr_send_json(j);
+    lr_event_t ev = {
+        .tipo = LR_EV_ERR, .modo = (uint8_t)modo,
+        .last_ms = last_ms,
+        .ok_total = (uint16_t)ok_total, .err_total = (uint16_t)err_total,
+    };
+    lr_fill_mic(&ev.mic, MIC_STATS_ROUND);
+    lr_send_event(&ev);
 }
 
 void local_report_event_stop(uint32_t ok_total, uint32_t err_total,
-                             const char *modo) {
+                             lr_modo_t modo) {
     uint32_t ts = lr_now_ms();
     if (!g_session_open) return;
 
-    uint32_t total_ms = (ts >= g_session_start_ts) ? (ts - g_session_start_ts) : 0;
-
-    float mf, mi; uint8_t mt;
-    lr_get_mic(&mf, &mi, &mt);
-
-    char j[LR_PAYLOAD_MAX];
-    snprintf(j, sizeof(j),
-             "{\"event\":\"stop\",\"user\":\"%s\",\"session\":%u,\"modo\":\"%s\","
-             "\"mic_freq\":%.1f,\"mic_int\":%.3f,\"mic_type\":%u,"
-             "\"ok_total\":%u,\"err_total\":%u,\"total_ms\":%u,\"ts\":%u}",
-             safe_user(), (unsigned)g_session_id, modo ? modo : "",
-             mf, mi, (unsigned)mt,
-             (unsigned)ok_total, (unsigned)err_total,
-             (unsigned)total_ms, (unsigned)ts);
-
-    lr_send_json(j);
+    lr_event_t ev = {
+        .tipo = LR_EV_STOP, .modo = (uint8_t)modo,
+        .total_ms = (ts >= g_session_start_ts) ? (ts - g_session_start_ts) : 0,
+        .ok_total = (uint16_t)ok_total, .err_total = (uint16_t)err_total,
+    };
+    lr_fill_mic(&ev.mic, MIC_STATS_SESSION);
+    lr_send_event(&ev);
 
     g_session_open = false;
     g_session_start_ts = 0;
 }
 
+void local_report_event_net(bool up, int8_t rssi, uint16_t tentativas, uint32_t fora_ms) {
+    lr_event_t ev = {
+        .tipo = LR_EV_NET,
+        .link = up ? 1u : 0u, .rssi = rssi,
+        .tentativas = tentativas, .fora_ms = fora_ms,
+    };
+    lr_send_event(&ev);
+}
+
 #endif // LOCAL_REPORT_ENABLE
@@ -7,12 +7,17 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include "lr_proto.h"
+
 // =====================================================
 // LOCAL REPORT - Sessões por usuário (UDP -> PC)
 // =====================================================
 //
 // Regras (anti-mistura):
-// 1) start abre sessão e envia JSON.
+// Eventos vão em binário (lr_proto.h); o udp_server.py decodifica e grava
+// o mesmo JSONL de antes.
+//
+// 1) start abre sessão e envia o evento.
 //    - Se user não estiver definido, envia user="" (vazio) para o /live mapear.
 // 2) ok/err só são enviados se sessão estiver aberta.
 // 3) stop fecha sessão e envia total_ms (tempo total da sessão).
@@ -48,18 +53,22 @@ void local_report_clear_user(void);
 void local_report_process_serial(void);
 
 // Eventos do jogo
-void local_report_event_start(const char *modo);
+void local_report_event_start(lr_modo_t modo);
 
 void local_report_event_ok(uint32_t last_ms, uint32_t avg_ms,
                            uint32_t ok_total, uint32_t err_total,
-                           const char *modo);
+                           lr_modo_t modo);
 
 void local_report_event_err(uint32_t last_ms,
                             uint32_t ok_total, uint32_t err_total,
-                            const char *modo);
+                            lr_modo_t modo);
 
 void local_report_event_stop(uint32_t ok_total, uint32_t err_total,
-                             const char *modo);
+                             lr_modo_t modo);
+
+// Link Wi-Fi subiu/caiu (chamado pela NetSup, net_sup.h; fora de sessão
+// também). Sai quando o link voltar, com o ts de quando aconteceu.
+void local_report_event_net(bool up, int8_t rssi, uint16_t tentativas, uint32_t fora_ms);
 
 // Debug/stack no HealthTask (opcional)
 TaskHandle_t local_report_get_task_handle(void);
@@ -0,0 +1,334 @@
+#include "lr_outbox.h"
+
+#include <string.h>
+
+#define OB_MAGIC       0x4F42u   // "BO"
+#define PAGES_PER_SEC  (LR_OB_SECTOR / LR_OB_PAGE)
+
+// cabeçalho da página:
+//   u16 magic, u16 bytes de registros, u32 pseq, u32 rid0, u16 crc, u16 0xFFFF
+// crc16-CCITT sobre os 12 primeiros bytes + registros
+
+static uint16_t crc16(uint16_t crc, const uint8_t *p, uint32_t n) {
+    while (n--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (int i = 0; i < 8; i++) crc = (crc & 0x8000u) ? (uint16_t)((crc << 1) ^ 0x1021u) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+static inline void wr16(uint8_t *p, uint16_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static inline void wr32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24);
+}
+
+static inline const uint8_t *page_mem(const lr_outbox_t *ob, uint32_t p) {
+    return ob->fl.mem + p * LR_OB_PAGE;
+}
+
+static inline uint32_t next_page(const lr_outbox_t *ob, uint32_t p) {
+    return (p + 1u == ob->npages) ? 0u : p + 1u;
+}
+
+// Página gravada e íntegra? Devolve bytes de registros, pseq e rid0.
+// crc = false: página já conferida (gravada não muda até ser apagada).
+static bool page_ok(const lr_outbox_t *ob, uint32_t p, uint16_t *len, uint32_t *pseq, uint32_t *rid0, bool crc) {
+    const uint8_t *m = page_mem(ob, p);
+    if (rd16(m) != OB_MAGIC) return false;
+    uint16_t n = rd16(m + 2);
+    if (n > LR_OB_PAGE - LR_OB_HDR) return false;
+    if (crc && crc16(crc16(0xFFFFu, m, 12), m + LR_OB_HDR, n) != rd16(m + 12)) return false;
+    if (len) *len = n;
+    if (pseq) *pseq = rd32(m + 4);
+    if (rid0) *rid0 = rd32(m + 8);
+    return true;
+}
+
+static bool blank(const uint8_t *m, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        if (m[i] != 0xFF) return false;
+    }
+    return true;
+}
+
+static void open_page(lr_outbox_t *ob) {
+    ob->pg_len = 0;
+    ob->pg_rid0 = ob->next_rid;
+    ob->pg_done = 0;
+}
+
+// cursor da RAM à frente do gravado, com registro na flash que ele cobre
+static inline bool cursor_dirty(const lr_outbox_t *ob) {
+    return ob->done_rid > ob->fl_done_rid && ob->fl_last_rid > ob->fl_done_rid;
+}
+
+static inline bool fits(const lr_outbox_t *ob, uint8_t len) {
+    return ob->pg_len + 2u + len <= LR_OB_PAGE - LR_OB_HDR;
+}
+
+static void stage(lr_outbox_t *ob, uint8_t type, const uint8_t *data, uint8_t len) {
+    uint8_t *p = ob->pg + LR_OB_HDR + ob->pg_len;
+    p[0] = type;
+    p[1] = len;
+    memcpy(p + 2, data, len);
+    ob->pg_len = (uint16_t)(ob->pg_len + 2u + len);
+}
+
+static void stage_cursor(lr_outbox_t *ob) {
+    uint8_t v[4];
+    wr32(v, ob->done_rid);
+    stage(ob, LR_OB_T_CURSOR, v, sizeof(v));
+    ob->pg_done = ob->done_rid;
+}
+
+// Apaga o setor que começa em p. Se a leitura estava nele, pula para o
+// setor seguinte (o que não foi lido aqui se perde; conta ao entrar lá).
+static bool erase_sector(lr_outbox_t *ob, uint32_t p, bool rd_na_ram) {
+    if (!rd_na_ram && ob->rd_page >= p && ob->rd_page < p + PAGES_PER_SEC) {
+        ob->rd_page = (p + PAGES_PER_SEC) % ob->npages;
+        ob->rd_off = 0;
+    }
+    if (!ob->fl.erase(ob->fl.ctx, p * LR_OB_PAGE)) return false;
+    ob->st_erases++;
+    return true;
+}
+
+// A escrita passa para a página seguinte. Se a leitura (uma volta atrás)
+// estava nela, pula junto: essa página vai ser apagada/regravada.
+static void advance_wr(lr_outbox_t *ob, bool rd_na_ram) {
+    ob->wr_page = next_page(ob, ob->wr_page);
+    if (rd_na_ram) {
+        ob->rd_page = ob->wr_page;
+    } else if (ob->rd_page == ob->wr_page) {
+        ob->rd_page = next_page(ob, ob->rd_page);
+        ob->rd_off = 0;
+    }
+}
+
+// Grava a página em RAM na próxima página livre do anel
+static bool prog_page(lr_outbox_t *ob) {
+    bool rd_na_ram = (ob->rd_page == ob->wr_page);
+    uint8_t *h = ob->pg;
+
+    wr16(h, OB_MAGIC);
+    wr16(h + 2, ob->pg_len);
+    wr32(h + 4, ob->wr_pseq);
+    wr32(h + 8, ob->pg_rid0);
+    wr16(h + 12, crc16(crc16(0xFFFFu, h, 12), h + LR_OB_HDR, ob->pg_len));
+    wr16(h + 14, 0xFFFFu);
+    memset(h + LR_OB_HDR + ob->pg_len, 0xFF, LR_OB_PAGE - LR_OB_HDR - ob->pg_len);
+
+    // pula página que não está em branco (gravação interrompida antes do
+    // reboot); no começo do setor, apaga (se precisar)
+    for (uint32_t tent = 0; tent < ob->npages; tent++) {
+        uint32_t p = ob->wr_page;
+        bool ok = true;
+
+        if (p % PAGES_PER_SEC == 0 && !blank(page_mem(ob, p), LR_OB_SECTOR)) {
+            ok = erase_sector(ob, p, rd_na_ram);
+        }
+        if (ok && blank(page_mem(ob, p), LR_OB_PAGE) && ob->fl.prog(ob->fl.ctx, p * LR_OB_PAGE, ob->pg)) {
+            if (rd_na_ram) ob->rd_page = p;
+            advance_wr(ob, false);
+            ob->wr_pseq++;
+            ob->st_pages++;
+            return true;
+        }
+
+        advance_wr(ob, rd_na_ram);
+    }
+    return false;
+}
+
+// Fecha a página em RAM: grava, ou descarta se tudo nela já foi entregue
+static bool close_page(lr_outbox_t *ob) {
+    if (ob->pg_len == 0) return true;
+
+    bool dados = ob->next_rid > ob->pg_rid0;
+    if (dados && ob->done_rid >= ob->next_rid - 1u) {
+        if (ob->rd_page == ob->wr_page) ob->rd_off = 0;
+        ob->st_dropped++;
+        open_page(ob);
+        if (!cursor_dirty(ob)) return true;
+        stage_cursor(ob);   // a flash ainda tem registros que ele cobre
+        dados = false;
+    } else if (!ob->pg_done && ob->done_rid > ob->fl_done_rid && fits(ob, 4)) {
+        stage_cursor(ob);   // de carona (cobre também páginas descartadas)
+    }
+
+    if (!prog_page(ob)) return false;
+    if (dados) ob->fl_last_rid = ob->next_rid - 1u;
+    if (ob->pg_done) ob->fl_done_rid = ob->pg_done;
+    open_page(ob);
+    return true;
+}
+
+// ============================
+// API
+// ============================
+bool lr_ob_mount(lr_outbox_t *ob, const lr_ob_flash_t *fl) {
+    memset(ob, 0, sizeof(*ob));
+    if (!fl->mem || fl->size % LR_OB_SECTOR || fl->size < 2u * LR_OB_SECTOR) return false;
+    ob->fl = *fl;
+    ob->npages = fl->size / LR_OB_PAGE;
+
+    // página mais nova e mais velha
+    bool achou = false;
+    uint32_t p_old = 0, p_new = 0, s_old = 0, s_new = 0;
+    for (uint32_t p = 0; p < ob->npages; p++) {
+        uint32_t s;
+        if (!page_ok(ob, p, NULL, &s, NULL, true)) continue;
+        if (!achou || s > s_new) { s_new = s; p_new = p; }
+        if (!achou || s < s_old) { s_old = s; p_old = p; }
+        achou = true;
+    }
+
+    uint32_t last_rid = 0, done = 0;
+    if (achou) {
+        ob->wr_page = next_page(ob, p_new);
+        ob->wr_pseq = s_new + 1u;
+
+        // do mais velho ao mais novo: último rid e último cursor
+        for (uint32_t p = p_old;; p = next_page(ob, p)) {
+            uint16_t n;
+            uint32_t rid;
+            if (page_ok(ob, p, &n, NULL, &rid, true)) {
+                const uint8_t *r = page_mem(ob, p) + LR_OB_HDR;
+                for (uint16_t off = 0; off + 2u <= n && off + 2u + r[off + 1] <= n; off = (uint16_t)(off + 2u + r[off + 1])) {
+                    if (r[off] == LR_OB_T_CURSOR) {
+                        if (r[off + 1] == 4 && rd32(r + off + 2) > done) done = rd32(r + off + 2);
+                    } else {
+                        last_rid = rid++;
+                    }
+                }
+            }
+            if (p == p_new) break;
+        }
+        ob->rd_page = p_old;
+    } else {
+        ob->wr_page = 0;
+        ob->wr_pseq = 1;
+        ob->rd_page = 0;
+    }
+
+    ob->next_rid = (last_rid > done ? last_rid : done) + 1u;
+    ob->boot_rid = ob->next_rid;
+    ob->done_rid = ob->fl_done_rid = done;
+    ob->fl_last_rid = last_rid;
+    ob->rd_off = 0;
+    ob->rd_rid = done + 1u;
+    open_page(ob);
+
+    // anel cheio: a página mais velha é a próxima a ser escrita
+    if (achou && ob->rd_page == ob->wr_page) ob->rd_page = next_page(ob, ob->rd_page);
+    return true;
+}
+
+bool lr_ob_append(lr_outbox_t *ob, uint8_t type, const uint8_t *data, uint8_t len) {
+#if LR_OB_REC_MAX < 255
+    if (len > LR_OB_REC_MAX) return false;
+#endif
+    if (type == LR_OB_T_CURSOR) return false;
+    if (!fits(ob, len) && !close_page(ob)) return false;
+
+    stage(ob, type, data, len);
+    ob->next_rid++;
+    ob->st_append++;
+    ob->st_append_bytes += len;
+    return true;
+}
+
+const uint8_t *lr_ob_read(lr_outbox_t *ob, uint8_t *type, uint8_t *len, uint32_t *rid) {
+    for (uint32_t guarda = 0; guarda <= ob->npages && lr_ob_pending(ob); ) {
+        const uint8_t *r;
+        uint16_t n;
+        uint32_t rid0;
+
+        if (ob->rd_page == ob->wr_page) {
+            r = ob->pg + LR_OB_HDR;
+            n = ob->pg_len;
+            rid0 = ob->pg_rid0;
+        } else if (page_ok(ob, ob->rd_page, &n, NULL, &rid0, ob->rd_off == 0)) {
+            r = page_mem(ob, ob->rd_page) + LR_OB_HDR;
+        } else {
+            ob->rd_page = next_page(ob, ob->rd_page);   // em branco / interrompida
+            ob->rd_off = 0;
+            guarda++;
+            continue;
+        }
+
+        // entrando na página: o rid dela diz se algo ficou para trás
+        if (ob->rd_off == 0) {
+            ob->rd_cur = rid0;
+            if (rid0 > ob->rd_rid) {
+                ob->st_lost += rid0 - ob->rd_rid;
+                ob->rd_rid = rid0;
+            }
+        }
+
+        while (ob->rd_off + 2u <= n) {
+            const uint8_t *rec = r + ob->rd_off;
+            if (ob->rd_off + 2u + rec[1] > n) break;   // corrompido: próxima página
+            ob->rd_off = (uint16_t)(ob->rd_off + 2u + rec[1]);
+            if (rec[0] == LR_OB_T_CURSOR) continue;
+
+            uint32_t esta = ob->rd_cur++;
+            if (esta < ob->rd_rid) continue;   // entregue antes do reboot
+            ob->rd_rid = esta + 1u;
+            ob->st_read++;
+            *type = rec[0];
+            *len = rec[1];
+            *rid = esta;
+            return rec + 2;
+        }
+
+        if (ob->rd_page == ob->wr_page) return NULL;   // alcançou a escrita
+        ob->rd_page = next_page(ob, ob->rd_page);
+        ob->rd_off = 0;
+        guarda++;
+    }
+    return NULL;
+}
+
+// Setor s pode ser apagado antes da hora? Só o que já foi entregue e está
+// coberto pelo cursor gravado (um reboot não precisa de nada dele), e sem o
+// próprio cursor gravado (ele fica numa página mais nova). A leitura que
+// ainda aponte para ele só pularia registros já entregues.
+static bool sector_free(const lr_outbox_t *ob, uint32_t s) {
+    for (uint32_t p = s; p < s + PAGES_PER_SEC; p++) {
+        uint16_t n;
+        uint32_t rid;
+        if (!page_ok(ob, p, &n, NULL, &rid, true)) continue;
+        const uint8_t *r = page_mem(ob, p) + LR_OB_HDR;
+        for (uint16_t off = 0; off + 2u <= n && off + 2u + r[off + 1] <= n; off = (uint16_t)(off + 2u + r[off + 1])) {
+            if (r[off] == LR_OB_T_CURSOR) {
+                if (r[off + 1] == 4 && rd32(r + off + 2) >= ob->fl_done_rid) return false;
+            } else if (rid++ > ob->fl_done_rid) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool lr_ob_prepare(lr_outbox_t *ob) {
+    uint32_t s = ob->wr_page;
+    if (s % PAGES_PER_SEC) s = (s - s % PAGES_PER_SEC + PAGES_PER_SEC) % ob->npages;
+    if (blank(page_mem(ob, s), LR_OB_SECTOR) || !sector_free(ob, s)) return false;
+    return erase_sector(ob, s, ob->rd_page == ob->wr_page);
+}
+
+void lr_ob_consume(lr_outbox_t *ob, uint32_t rid) {
+    if (rid > ob->done_rid) ob->done_rid = rid;
+}
+
+bool lr_ob_flush(lr_outbox_t *ob) {
+    if (!close_page(ob)) return false;
+    if (!cursor_dirty(ob)) return true;
+    stage_cursor(ob);   // não coube de carona
+    return close_page(ob);
+}
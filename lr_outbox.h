@@ -0,0 +1,128 @@
+#ifndef LR_OUTBOX_H
+#define LR_OUTBOX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// =====================================================
+// LR_OUTBOX - fila de eventos na flash (sem rede / sem servidor)
+// =====================================================
+//
+// Log só de acréscimo numa região reservada da flash, em anel. O
+// local_report manda para cá o que não cabe na janela de retransmissão
+// (lr_rel.h) e tira de volta, na ordem, quando os ACKs liberam espaço.
+// Com a rede normal a janela não enche e a flash nem é tocada.
+//
+// Formato (sem FreeRTOS nem SDK; o bench/lr_outbox_sim.c roda o mesmo
+// código sobre uma flash simulada):
+//   - a região é dividida em páginas de LR_OB_PAGE bytes, gravadas uma
+//     vez cada, em ordem; o setor (LR_OB_SECTOR) só é apagado quando a
+//     escrita chega nele e ele não está em branco. O anel gasta todos os
+//     setores por igual
+//   - página: cabeçalho (magic, bytes usados, pseq crescente, rid do
+//     primeiro registro, crc16) + registros [u8 tipo, u8 len, dados]
+//   - cada registro de dados ganha um rid (u32 crescente, implícito pela
+//     posição na página); o registro CURSOR guarda até onde a fila já foi
+//     entregue, e sobrevive ao reboot
+//   - página incompleta (queda de energia no meio da gravação) falha no
+//     crc e é pulada
+//
+// Os registros ficam numa página em RAM até ela encher ou lr_ob_flush():
+// uma gravação por página, não por evento. A leitura enxerga a página em
+// RAM também; se tudo nela já foi consumido quando chega a hora de gravar,
+// ela é descartada sem tocar a flash.
+//
+// Anel cheio: apagar o setor mais antigo perde os registros dele que não
+// foram lidos (contados em st_lost).
+// =====================================================
+
+#ifndef LR_OB_PAGE
+#define LR_OB_PAGE     256       // unidade de gravação (FLASH_PAGE_SIZE ou múltiplo)
+#endif
+#define LR_OB_SECTOR   4096      // unidade de apagamento (FLASH_SECTOR_SIZE)
+#define LR_OB_HDR      16
+#define LR_OB_REC_MAX  (LR_OB_PAGE - LR_OB_HDR - 2)   // maior registro
+
+// tipos de registro
+#define LR_OB_T_CURSOR 0         // u32: rids até aqui já foram entregues
+#define LR_OB_T_EVENT  1         // evento do lr_proto.h, como foi codificado
+
+// Acesso à flash: leitura direta (XIP no Pico) e duas operações
+typedef struct {
+    const uint8_t *mem;          // região mapeada para leitura
+    uint32_t       size;         // múltiplo de LR_OB_SECTOR (>= 2 setores)
+    void          *ctx;
+    bool (*erase)(void *ctx, uint32_t off);                       // 1 setor
+    bool (*prog)(void *ctx, uint32_t off, const uint8_t *page);   // LR_OB_PAGE bytes
+} lr_ob_flash_t;
+
+typedef struct {
+    lr_ob_flash_t fl;
+    uint32_t      npages;
+
+    // escrita: página em montagem na RAM, que vai para wr_page
+    uint8_t       pg[LR_OB_PAGE];
+    uint16_t      pg_len;        // bytes de registros
+    uint32_t      pg_rid0;
+    uint32_t      pg_done;       // cursor que vai nesta página (0 = nenhum)
+    uint32_t      wr_page;
+    uint32_t      wr_pseq;
+    uint32_t      next_rid;      // rid do próximo registro de dados
+    uint32_t      boot_rid;      // primeiro rid deste boot (antes = boot anterior)
+
+    // leitura (rd_page == wr_page: na página em RAM)
+    uint32_t      rd_page;
+    uint16_t      rd_off;
+    uint32_t      rd_cur;        // rid do registro em rd_off
+    uint32_t      rd_rid;        // rid do próximo registro de dados a ler
+
+    // cursor de entrega
+    uint32_t      done_rid;      // entregue (RAM)
+    uint32_t      fl_done_rid;   // último cursor gravado
+    uint32_t      fl_last_rid;   // último rid gravado na flash
+
+    // estatística (quem chama zera quando quiser)
+    uint32_t      st_append;     // registros de dados
+    uint32_t      st_append_bytes;
+    uint32_t      st_read;
+    uint32_t      st_pages;      // páginas gravadas
+    uint32_t      st_erases;
+    uint32_t      st_dropped;    // páginas descartadas (já consumidas na RAM)
+    uint32_t      st_lost;       // registros perdidos no anel cheio
+} lr_outbox_t;
+
+// Varre a região e retoma do cursor gravado. false = região inválida.
+bool lr_ob_mount(lr_outbox_t *ob, const lr_ob_flash_t *fl);
+
+// Acrescenta um registro (grava a página anterior se esta não tiver
+// espaço). false = grande demais ou erro de flash.
+bool lr_ob_append(lr_outbox_t *ob, uint8_t type, const uint8_t *data, uint8_t len);
+
+// Próximo registro de dados não lido, em ordem (NULL se não há). O
+// ponteiro vale até a próxima chamada que mexa no outbox.
+const uint8_t *lr_ob_read(lr_outbox_t *ob, uint8_t *type, uint8_t *len, uint32_t *rid);
+
+// Tudo até rid foi entregue (vai para a flash no próximo lr_ob_flush)
+void lr_ob_consume(lr_outbox_t *ob, uint32_t rid);
+
+// Grava a página em RAM e o cursor, se houver o que gravar
+bool lr_ob_flush(lr_outbox_t *ob);
+
+// Apaga já o próximo setor que a escrita vai usar, se ele não está em
+// branco e nada nele ainda é preciso (tudo entregue e coberto pelo cursor
+// gravado). Para quem chama tirar o apagamento (o mais lento) do caminho
+// do append/flush e fazê-lo quando a fila está parada. true = apagou.
+bool lr_ob_prepare(lr_outbox_t *ob);
+
+// Há registro não lido?
+static inline bool lr_ob_pending(const lr_outbox_t *ob) {
+    return ob->rd_rid < ob->next_rid;
+}
+
+// Há algo só na RAM (registros ou cursor) que lr_ob_flush() gravaria?
+static inline bool lr_ob_dirty(const lr_outbox_t *ob) {
+    return ob->next_rid > ob->pg_rid0 ||
+           (ob->done_rid > ob->fl_done_rid && ob->fl_last_rid > ob->fl_done_rid);
+}
+
+#endif // LR_OUTBOX_H
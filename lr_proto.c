@@ -0,0 +1,159 @@
+#include "lr_proto.h"
+
+#include <string.h>
+
+// ============================
+// Escrita little-endian sem alinhamento
+// ============================
+typedef struct {
+    uint8_t *p;
+    uint8_t *end;
+    int      ovf;
+} lr_wr_t;
+
+static inline void wr_u8(lr_wr_t *w, uint8_t v) {
+    if (w->p >= w->end) { w->ovf = 1; return; }
+    *w->p++ = v;
+}
+
+static inline void wr_u16(lr_wr_t *w, uint16_t v) {
+    if (w->end - w->p < 2) { w->ovf = 1; return; }
+    w->p[0] = (uint8_t)v;
+    w->p[1] = (uint8_t)(v >> 8);
+    w->p += 2;
+}
+
+static inline void wr_u32(lr_wr_t *w, uint32_t v) {
+    if (w->end - w->p < 4) { w->ovf = 1; return; }
+    w->p[0] = (uint8_t)v;
+    w->p[1] = (uint8_t)(v >> 8);
+    w->p[2] = (uint8_t)(v >> 16);
+    w->p[3] = (uint8_t)(v >> 24);
+    w->p += 4;
+}
+
+static inline void wr_u64(lr_wr_t *w, uint64_t v) {
+    wr_u32(w, (uint32_t)v);
+    wr_u32(w, (uint32_t)(v >> 32));
+}
+
+// bits do float como estão (RP2040 e PC são little-endian)
+static inline void wr_f32(lr_wr_t *w, float v) {
+    uint32_t u;
+    memcpy(&u, &v, sizeof(u));
+    wr_u32(w, u);
+}
+
+static void wr_str(lr_wr_t *w, const char *s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > LR_PROTO_USER_MAX - 1) n = LR_PROTO_USER_MAX - 1;
+    wr_u8(w, (uint8_t)n);
+    if ((size_t)(w->end - w->p) < n) { w->ovf = 1; return; }
+    memcpy(w->p, s, n);
+    w->p += n;
+}
+
+static void wr_mic(lr_wr_t *w, const lr_ev_mic_t *m) {
+    wr_f32(w, m->freq);
+    wr_f32(w, m->intensity);
+    wr_f32(w, m->rms);
+    wr_f32(w, m->centroid);
+    wr_f32(w, m->flatness);
+    wr_f32(w, m->rms_max);
+    wr_f32(w, m->rms_sd);
+    wr_u8(w, m->top_type);
+    wr_u32(w, m->frames);
+    for (int i = 0; i < 4; i++) wr_u32(w, m->hist[i]);
+}
+
+static uint32_t rd_u32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// ============================
+// API
+// ============================
+size_t lr_proto_encode(const lr_event_t *ev, uint8_t *buf, size_t cap) {
+    lr_wr_t w = { buf, buf + cap, 0 };
+
+    wr_u8(&w, LR_PROTO_MAGIC);
+    wr_u8(&w, LR_PROTO_VERSION);
+    wr_u8(&w, ev->tipo);
+    wr_u8(&w, ev->modo);
+    wr_u32(&w, ev->device);
+    wr_u16(&w, ev->session);
+    wr_u32(&w, ev->seq);
+    wr_u64(&w, ev->ts_us);
+    wr_str(&w, ev->user);
+
+    switch (ev->tipo) {
+        case LR_EV_START:
+            break;
+        case LR_EV_OK:
+            wr_mic(&w, &ev->mic);
+            wr_u32(&w, ev->last_ms);
+            wr_u32(&w, ev->avg_ms);
+            wr_u16(&w, ev->ok_total);
+            wr_u16(&w, ev->err_total);
+            break;
+        case LR_EV_ERR:
+            wr_mic(&w, &ev->mic);
+            wr_u32(&w, ev->last_ms);
+            wr_u16(&w, ev->ok_total);
+            wr_u16(&w, ev->err_total);
+            break;
+        case LR_EV_STOP:
+            wr_mic(&w, &ev->mic);
+            wr_u16(&w, ev->ok_total);
+            wr_u16(&w, ev->err_total);
+            wr_u32(&w, ev->total_ms);
+            break;
+        case LR_EV_NET:
+            wr_u8(&w, ev->link);
+            wr_u8(&w, (uint8_t)ev->rssi);
+            wr_u16(&w, ev->tentativas);
+            wr_u32(&w, ev->fora_ms);
+            break;
+        default:
+            return 0;
+    }
+
+    return w.ovf ? 0 : (size_t)(w.p - buf);
+}
+
+uint32_t lr_proto_ev_seq(const uint8_t *ev) {
+    return rd_u32(ev + LR_PROTO_SEQ_OFFSET);
+}
+
+void lr_proto_ev_set_seq(uint8_t *ev, uint32_t seq) {
+    lr_wr_t w = { ev + LR_PROTO_SEQ_OFFSET, ev + LR_PROTO_SEQ_OFFSET + 4, 0 };
+    wr_u32(&w, seq);
+}
+
+uint64_t lr_proto_ev_ts_us(const uint8_t *ev) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) v = (v << 8) | ev[LR_PROTO_TS_OFFSET + i];
+    return v;
+}
+
+void lr_batch_set_hdr(lr_batch_t *b, uint32_t boot, uint32_t base) {
+    lr_wr_t w = { b->buf + 3, b->buf + LR_PROTO_BATCH_HDR, 0 };
+    wr_u32(&w, boot);
+    wr_u32(&w, base);
+}
+
+size_t lr_proto_encode_ack(uint32_t boot, uint32_t seq, uint8_t *buf, size_t cap) {
+    lr_wr_t w = { buf, buf + cap, 0 };
+    wr_u8(&w, LR_PROTO_ACK_MAGIC);
+    wr_u8(&w, 1);
+    wr_u32(&w, boot);
+    wr_u32(&w, seq);
+    return w.ovf ? 0 : (size_t)(w.p - buf);
+}
+
+int lr_proto_parse_ack(const uint8_t *buf, size_t n, uint32_t *boot, uint32_t *seq) {
+    if (n != LR_PROTO_ACK_LEN || buf[0] != LR_PROTO_ACK_MAGIC || buf[1] != 1) return 0;
+    *boot = rd_u32(buf + 2);
+    *seq  = rd_u32(buf + 6);
+    return 1;
+}
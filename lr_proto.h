@@ -0,0 +1,185 @@
+#ifndef LR_PROTO_H
+#define LR_PROTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// =====================================================
+// LR_PROTO - eventos do local_report em binário (UDP)
+// =====================================================
+//
+// Substitui o JSON montado com snprintf (floats %.1f/%.3f em soft-float no
+// M0+, ~330 bytes por evento) por um datagrama empacotado, little-endian,
+// sem alinhamento:
+//
+//   cabeçalho (22 bytes)
+//     u8  magic   LR_PROTO_MAGIC
+//     u8  versão  LR_PROTO_VERSION
+//     u8  tipo    lr_ev_tipo_t (| LR_EV_FLAG_BOOT_ANT)
+//     u8  modo    lr_modo_t (id, não string)
+//     u32 device  id da placa
+//     u16 sessão
+//     u32 seq     ordem de entrega no boot (carimbado ao entrar na janela
+//                 de retransmissão, lr_rel.h)
+//     u64 ts_us   tempo desde o boot em µs (do boot em que o evento nasceu)
+//   u8 len + user (sem '\0', até LR_PROTO_USER_MAX-1 bytes)
+//   campos do tipo:
+//     START  -
+//     OK     mic, u32 last_ms, u32 avg_ms, u16 ok_total, u16 err_total
+//     ERR    mic, u32 last_ms, u16 ok_total, u16 err_total
+//     STOP   mic, u16 ok_total, u16 err_total, u32 total_ms
+//     NET    u8 link (1 = subiu, 0 = caiu), i8 rssi, u16 tentativas,
+//            u32 fora_ms (net_sup.h; user vazio)
+//   mic (49 bytes):
+//     f32 freq, intensidade, rms, centroide, planura, rms_max, rms_sd
+//     u8  tipo dominante
+//     u32 quadros, hist[4]
+//
+// Lote (vários eventos num datagrama), versão LR_PROTO_BATCH_VERSION:
+//   u8 LR_PROTO_BATCH_MAGIC, u8 versão, u8 n,
+//   u32 boot   número sorteado no boot (seq recomeça junto com ele)
+//   u32 base   menor seq que o device ainda retransmite; abaixo disso ou
+//              já foi confirmado ou o device desistiu (o servidor fecha
+//              a lacuna)
+//   e n vezes [u8 len + evento]
+//
+// ACK (servidor -> device, cumulativo):
+//   u8 LR_PROTO_ACK_MAGIC, u8 versão, u32 boot, u32 seq: recebeu tudo <= seq
+//
+// Floats vão como IEEE-754 (cópia, sem conversão). O decodificador fica em
+// cubo_serve/udp_server.py, que grava o mesmo JSONL de antes; mudar o
+// layout = subir LR_PROTO_VERSION e acrescentar a versão nova lá.
+// =====================================================
+
+#define LR_PROTO_MAGIC     0xCB
+#define LR_PROTO_VERSION   1
+#define LR_PROTO_USER_MAX  32
+#define LR_PROTO_MAX_LEN   128   // maior evento (OK com user cheio) = 115
+
+#define LR_PROTO_BATCH_MAGIC   0xCC
+#define LR_PROTO_BATCH_VERSION 2
+#define LR_PROTO_BATCH_HDR     11
+#define LR_PROTO_BATCH_MAX     1472  // MTU 1500 - IP - UDP: sem fragmentar
+
+#define LR_PROTO_ACK_MAGIC     0xCA
+#define LR_PROTO_ACK_LEN       10
+
+#define LR_PROTO_TIPO_OFFSET   2     // u8 tipo dentro do evento
+#define LR_PROTO_SEQ_OFFSET    10    // u32 seq dentro do evento
+#define LR_PROTO_TS_OFFSET     14    // u64 ts_us dentro do evento
+
+typedef enum {
+    LR_EV_START = 1,
+    LR_EV_OK,
+    LR_EV_ERR,
+    LR_EV_STOP,
+    LR_EV_NET,     // mudança do link Wi-Fi (NetSup)
+} lr_ev_tipo_t;
+
+// ids dos modos do jogo (o servidor traduz para "NIVEL 1", ...)
+typedef enum {
+    LR_MODO_UNK = 0,
+    LR_MODO_NIVEL1,
+    LR_MODO_MEMORIA,
+    LR_MODO_MEMORIA_RAPIDA,
+} lr_modo_t;
+
+typedef struct {
+    float    freq;
+    float    intensity;
+    float    rms;
+    float    centroid;
+    float    flatness;
+    float    rms_max;
+    float    rms_sd;
+    uint8_t  top_type;
+    uint32_t frames;
+    uint32_t hist[4];
+} lr_ev_mic_t;
+
+typedef struct {
+    uint8_t     tipo;        // lr_ev_tipo_t
+    uint8_t     modo;        // lr_modo_t
+    uint16_t    session;
+    uint32_t    device;
+    uint32_t    seq;
+    uint64_t    ts_us;
+    const char *user;        // NULL = ""
+
+    // OK / ERR / STOP
+    lr_ev_mic_t mic;
+    uint32_t    last_ms;
+    uint32_t    avg_ms;
+    uint32_t    total_ms;
+    uint16_t    ok_total;
+    uint16_t    err_total;
+
+    // NET
+    uint8_t     link;
+    int8_t      rssi;
+    uint16_t    tentativas;
+    uint32_t    fora_ms;
+} lr_event_t;
+
+// Codifica ev em buf. Retorna o tamanho, ou 0 se não couber em cap.
+size_t lr_proto_encode(const lr_event_t *ev, uint8_t *buf, size_t cap);
+
+// Evento guardado no outbox (lr_outbox.h) e enviado depois de um reboot:
+// ts_us e sessão são do boot anterior
+#define LR_EV_FLAG_BOOT_ANT 0x80
+
+// Campos do cabeçalho de um evento já codificado
+uint32_t lr_proto_ev_seq(const uint8_t *ev);
+void     lr_proto_ev_set_seq(uint8_t *ev, uint32_t seq);
+uint64_t lr_proto_ev_ts_us(const uint8_t *ev);
+
+// ACK: codifica (LR_PROTO_ACK_LEN bytes) / decodifica (false se inválido)
+size_t lr_proto_encode_ack(uint32_t boot, uint32_t seq, uint8_t *buf, size_t cap);
+int    lr_proto_parse_ack(const uint8_t *buf, size_t n, uint32_t *boot, uint32_t *seq);
+
+// seq com volta (u32): a vem antes de b
+static inline int lr_seq_before(uint32_t a, uint32_t b) {
+    return (int32_t)(a - b) < 0;
+}
+
+// --------- lote ---------
+// Os eventos são escritos direto no buffer do lote: lr_batch_slot() reserva
+// o lugar de um evento de n bytes (já com o prefixo de tamanho) e devolve
+// onde escrever, ou NULL se não couber.
+typedef struct {
+    uint8_t *buf;
+    size_t   cap;
+    size_t   len;
+} lr_batch_t;
+
+static inline void lr_batch_reset(lr_batch_t *b) {
+    memset(b->buf, 0, LR_PROTO_BATCH_HDR);
+    b->buf[0] = LR_PROTO_BATCH_MAGIC;
+    b->buf[1] = LR_PROTO_BATCH_VERSION;
+    b->len = LR_PROTO_BATCH_HDR;
+}
+
+// boot/base vão no cabeçalho na hora de enviar
+void lr_batch_set_hdr(lr_batch_t *b, uint32_t boot, uint32_t base);
+
+static inline void lr_batch_init(lr_batch_t *b, uint8_t *buf, size_t cap) {
+    b->buf = buf;
+    b->cap = cap;
+    lr_batch_reset(b);
+}
+
+static inline uint8_t lr_batch_count(const lr_batch_t *b) {
+    return b->buf[2];
+}
+
+static inline uint8_t *lr_batch_slot(lr_batch_t *b, size_t n) {
+    if (n == 0 || n > 255 || b->buf[2] == 255 || b->len + 1 + n > b->cap) return NULL;
+    uint8_t *p = b->buf + b->len;
+    p[0] = (uint8_t)n;
+    b->len += 1 + n;
+    b->buf[2]++;
+    return p + 1;
+}
+
+#endif // LR_PROTO_H
@@ -0,0 +1,124 @@
+#include "lr_rel.h"
+
+#include <string.h>
+
+static inline lr_rel_slot_t *slot_at(lr_rel_t *r, unsigned i) {
+    return &r->slot[(r->head + i) % LR_REL_WINDOW];
+}
+
+// tira do início os já confirmados e os abandonados
+static void lr_rel_pop(lr_rel_t *r) {
+    while (r->count) {
+        lr_rel_slot_t *s = &r->slot[r->head];
+        if (s->vivo && lr_seq_before(r->ack, s->seq)) break;
+        if (s->tag) r->done_tag = s->tag;
+        r->head = (uint8_t)((r->head + 1) % LR_REL_WINDOW);
+        r->count--;
+    }
+}
+
+// menor seq que o device ainda vai mandar
+static uint32_t lr_rel_base(lr_rel_t *r) {
+    for (unsigned i = 0; i < r->count; i++) {
+        lr_rel_slot_t *s = slot_at(r, i);
+        if (s->vivo) return s->seq;
+    }
+    return r->next_seq;
+}
+
+void lr_rel_init(lr_rel_t *r, uint32_t boot) {
+    memset(r, 0, sizeof(*r));
+    r->boot = boot;
+    r->next_seq = 1;
+    r->max_tries = LR_REL_MAX_TRIES;
+}
+
+uint8_t *lr_rel_reserve(lr_rel_t *r, uint8_t n) {
+    if (lr_rel_full(r) || n == 0 || n > LR_PROTO_MAX_LEN) return NULL;
+    lr_rel_slot_t *s = slot_at(r, r->count);
+    s->len = n;
+    return s->data;
+}
+
+void lr_rel_commit(lr_rel_t *r, uint32_t tag) {
+    lr_rel_slot_t *s = slot_at(r, r->count);
+    s->seq = r->next_seq++;
+    lr_proto_ev_set_seq(s->data, s->seq);
+    s->tries = 0;
+    s->vivo = true;
+    s->tag = tag;
+    s->t_next_us = 0;
+    r->count++;
+}
+
+void lr_rel_ack(lr_rel_t *r, uint32_t ack, uint64_t now_us) {
+    if (!lr_seq_before(r->ack, ack)) return;   // velho ou repetido
+    r->ack = ack;
+
+    for (unsigned i = 0; i < r->count; i++) {
+        lr_rel_slot_t *s = slot_at(r, i);
+        if (lr_seq_before(ack, s->seq)) break;
+        if (s->vivo && s->tries) {
+            r->st_acked++;
+            // ts_us de um boot anterior é de outro relógio: fora da latência
+            if (s->data[LR_PROTO_TIPO_OFFSET] & LR_EV_FLAG_BOOT_ANT) continue;
+            uint64_t ts = lr_proto_ev_ts_us(s->data);
+            uint64_t lat = (now_us > ts) ? now_us - ts : 0;
+            if (lat > UINT32_MAX) lat = UINT32_MAX;
+            r->st_lat_n++;
+            r->st_lat_sum_us += lat;
+            if (lat > r->st_lat_max_us) r->st_lat_max_us = (uint32_t)lat;
+        }
+    }
+    lr_rel_pop(r);
+}
+
+bool lr_rel_has_new(const lr_rel_t *r) {
+    for (unsigned i = 0; i < r->count; i++) {
+        const lr_rel_slot_t *s = &r->slot[(r->head + i) % LR_REL_WINDOW];
+        if (s->vivo && s->tries == 0) return true;
+    }
+    return false;
+}
+
+uint64_t lr_rel_next_due(const lr_rel_t *r) {
+    uint64_t t = UINT64_MAX;
+    for (unsigned i = 0; i < r->count; i++) {
+        const lr_rel_slot_t *s = &r->slot[(r->head + i) % LR_REL_WINDOW];
+        if (s->vivo && s->tries && s->t_next_us < t) t = s->t_next_us;
+    }
+    return t;
+}
+
+int lr_rel_build(lr_rel_t *r, lr_batch_t *b, uint64_t now_us) {
+    int n = 0;
+
+    for (unsigned i = 0; i < r->count; i++) {
+        lr_rel_slot_t *s = slot_at(r, i);
+        if (!s->vivo) continue;
+        if (s->tries && s->t_next_us > now_us) continue;
+
+        if (r->max_tries && s->tries >= r->max_tries) {
+            s->vivo = false;
+            r->st_desist++;
+            continue;
+        }
+
+        uint8_t *dst = lr_batch_slot(b, s->len);
+        if (!dst) break;   // lote cheio: o resto vai no próximo
+        memcpy(dst, s->data, s->len);
+
+        if (s->tries) r->st_retx++;
+        r->st_tx++;
+
+        uint32_t rto = (s->tries < 5) ? LR_REL_RTO_US << s->tries : LR_REL_RTO_MAX_US;
+        if (rto > LR_REL_RTO_MAX_US) rto = LR_REL_RTO_MAX_US;
+        if (s->tries < UINT8_MAX) s->tries++;
+        s->t_next_us = now_us + rto;
+        n++;
+    }
+
+    lr_rel_pop(r);
+    lr_batch_set_hdr(b, r->boot, lr_rel_base(r));
+    return n;
+}
@@ -0,0 +1,94 @@
+#ifndef LR_REL_H
+#define LR_REL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "lr_proto.h"
+
+// =====================================================
+// LR_REL - entrega confiável dos eventos do local_report
+// =====================================================
+//
+// Janela de retransmissão no device, sem FreeRTOS nem lwIP (o mesmo código
+// roda no bench/lr_rel_sim.c contra o servidor de verdade):
+//   - cada evento (já codificado, com seq crescente) ocupa um slot até o
+//     ACK cumulativo do servidor cobrir o seq dele
+//   - envio: evento novo sai no próximo lote; sem ACK, volta depois de
+//     LR_REL_RTO_US, dobrando a cada tentativa até LR_REL_RTO_MAX_US
+//   - o seq é carimbado no evento quando ele entra na janela (ordem de
+//     entrega), junto com uma etiqueta de quem chama (ex.: rid do outbox)
+//   - depois de max_tries envios o device desiste do evento (o "base" no
+//     cabeçalho do lote avisa o servidor para não esperar mais); com
+//     max_tries = 0 não desiste: a janela parada vira a sonda que descobre
+//     quando o servidor volta, e o resto espera no outbox (lr_outbox.h)
+//   - janela cheia: quem chama para de tirar eventos da fila (a pressão
+//     volta para o message buffer, que descarta e conta)
+//
+// Tudo em tempo absoluto (µs) passado por quem chama.
+// =====================================================
+
+#ifndef LR_REL_WINDOW
+#define LR_REL_WINDOW      24
+#endif
+#define LR_REL_RTO_US      250000u     // LAN: o ACK volta em poucos ms
+#define LR_REL_RTO_MAX_US  4000000u
+#define LR_REL_MAX_TRIES   6           // ~8 s tentando (padrão de max_tries)
+
+typedef struct {
+    uint32_t seq;
+    uint8_t  len;
+    uint8_t  tries;          // envios feitos (0 = ainda não saiu)
+    bool     vivo;           // false = desistiu (espera o ACK passar)
+    uint32_t tag;            // de quem chama (0 = nenhuma)
+    uint64_t t_next_us;      // próximo envio (se tries > 0)
+    uint8_t  data[LR_PROTO_MAX_LEN];
+} lr_rel_slot_t;
+
+typedef struct {
+    lr_rel_slot_t slot[LR_REL_WINDOW];
+    uint8_t       head;      // mais antigo
+    uint8_t       count;
+    uint32_t      boot;
+    uint32_t      ack;       // maior ACK cumulativo recebido
+    uint32_t      next_seq;  // seq do próximo evento aceito (base com a janela vazia)
+    uint8_t       max_tries; // 0 = nunca desiste
+    uint32_t      done_tag;  // etiqueta do último evento que saiu da janela
+
+    // estatística (quem chama zera quando quiser)
+    uint32_t      st_acked;
+    uint32_t      st_tx;          // envios, inclusive retransmissões
+    uint32_t      st_retx;
+    uint32_t      st_desist;
+    uint32_t      st_lat_n;       // ACKs na latência (sem os de boot anterior)
+    uint64_t      st_lat_sum_us;  // ts_us do evento -> ACK (mesmo relógio)
+    uint32_t      st_lat_max_us;
+} lr_rel_t;
+
+void lr_rel_init(lr_rel_t *r, uint32_t boot);
+
+static inline bool lr_rel_full(const lr_rel_t *r) {
+    return r->count >= LR_REL_WINDOW;
+}
+
+// Reserva o slot do próximo evento (n bytes): devolve onde escrever (NULL
+// se a janela estiver cheia). Depois de escrever, lr_rel_commit(), que
+// carimba o seq no evento.
+uint8_t *lr_rel_reserve(lr_rel_t *r, uint8_t n);
+void     lr_rel_commit(lr_rel_t *r, uint32_t tag);
+
+// ACK cumulativo: libera tudo com seq <= ack
+void lr_rel_ack(lr_rel_t *r, uint32_t ack, uint64_t now_us);
+
+// Há evento que ainda não saiu nenhuma vez?
+bool lr_rel_has_new(const lr_rel_t *r);
+
+// Próximo instante em que uma retransmissão vence (UINT64_MAX se nenhuma)
+uint64_t lr_rel_next_due(const lr_rel_t *r);
+
+// Põe no lote os eventos vencidos (novos e retransmissões), na ordem de seq,
+// até o lote encher. Preenche boot/base no cabeçalho. Retorna quantos
+// entraram (0 = nada a enviar agora).
+int lr_rel_build(lr_rel_t *r, lr_batch_t *b, uint64_t now_us);
+
+#endif // LR_REL_H
@@ -2,16 +2,35 @@
 #define __LWIPOPTS_H__
 
 // =======================================================
-// lwIP options para Pico W + cyw43 threadsafe_background
-// (RAW API, sem sys_arch / sem sockets)
+// lwIP options para Pico W + cyw43
+// (RAW API, sem sockets; toda chamada passa pelo net_io.h)
 // =======================================================
 
+#if PICO_CYW43_ARCH_FREERTOS
+// lwip_sys_freertos (LWIP_SYS_FREERTOS=ON): sys_arch do FreeRTOS e a
+// tcpip_thread como única dona do lwIP
+#define NO_SYS                      0
+#define LWIP_TIMEVAL_PRIVATE        0
+#define TCPIP_THREAD_NAME           "tcpip"
+// sys_thread_new do port do FreeRTOS lê os tamanhos em bytes (divide por
+// sizeof(StackType_t)); 4 KB: corpo dos net_io_call (udp_sendto até o
+// cyw43, mqtt_publish/connect, DNS) e callbacks com printf (MQTT/SNTP/DNS)
+#define TCPIP_THREAD_STACKSIZE      4096   // bytes
+#define TCPIP_THREAD_PRIO           4      // acima dos clientes (MQTTTask 3, lr_udp 2, NetSup 1)
+#define TCPIP_MBOX_SIZE             16     // quadros do cyw43 + pedidos do net_io_call
+#define DEFAULT_THREAD_STACKSIZE    512    // bytes (nenhuma outra thread do lwIP é criada)
+#define DEFAULT_RAW_RECVMBOX_SIZE   4
+#define DEFAULT_UDP_RECVMBOX_SIZE   4
+#define DEFAULT_TCP_RECVMBOX_SIZE   4
+#define DEFAULT_ACCEPTMBOX_SIZE     4
+#else
 // threadsafe_background usa lwIP NO_SYS (RAW API)
 #ifndef NO_SYS
 #define NO_SYS                      1
 #endif
+#endif
 
-// Sem NETCONN e sem SOCKETS (evita exigir sys_arch.h)
+// Sem NETCONN e sem SOCKETS (só a RAW API, pela tcpip_thread)
 #ifndef LWIP_NETCONN
 #define LWIP_NETCONN                0
 #endif
@@ -70,6 +89,19 @@
 #define MEMP_NUM_SYS_TIMEOUT  (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 8)
 #endif
 
+// MQTT: o publish é copiado para este anel até sair no TCP; cabe um lote
+// com horário (TELE_BATCH_MAX) + o delta da telemetria + cabeçalhos
+#define MQTT_OUTPUT_RINGBUF_SIZE    2048
+
+// SNTP: horário (epoch) dos lotes de telemetria do mqtt.c
+#define SNTP_SERVER_DNS             1
+#define SNTP_UPDATE_DELAY           (60 * 60 * 1000)   // 1 h
+#define SNTP_SET_SYSTEM_TIME_US(sec, us)  mqtt_sntp_set_time((uint32_t)(sec), (uint32_t)(us))
+#if !defined(__ASSEMBLER__)
+#include <stdint.h>
+void mqtt_sntp_set_time(uint32_t sec, uint32_t us);
+#endif
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
 #define LWIP_STATS                  1
@@ -0,0 +1,185 @@
+"""
+Relatório de RAM do firmware por subsistema, a partir do .map do linker.
+
+Uso (o CMake roda isto depois do link e grava build/mem_report.txt):
+    python mem_report.py <firmware.elf.map> [-o saida.txt]
+
+Lê a tabela "Memory Configuration" (RAM, SCRATCH_X, SCRATCH_Y) e todas as
+seções de entrada colocadas nessas regiões (.data, .bss, .time_critical,
+.scratch_x/y, pilhas), e soma por arquivo objeto -> subsistema:
+    jogo/IMU/OLED, mic (DSP/LED), rede (app), FreeRTOS, lwIP, cyw43,
+    SDK/runtime, libc/libgcc
+Também lista os maiores objetos e o heap do FreeRTOS (ucHeap), que com a
+alocação estática deve ser só a reserva pequena do FreeRTOSConfig.h.
+"""
+
+import re
+import sys
+
+REGIOES_RAM = ("RAM", "SCRATCH_X", "SCRATCH_Y")
+
+# Fontes do projeto: caminho relativo dentro de CMakeFiles/<alvo>.dir/
+# (todo objeto tem "mpu6050_freertos.dir" no caminho, então não dá para
+# casar pelo nome do alvo). Primeira regra que casar vence.
+APP = (
+    ("microfone/",          "mic (DSP/LED)"),
+    ("generated/",          "mic (DSP/LED)"),
+    ("local_report.c",      "rede (app)"),
+    ("lr_proto.c",          "rede (app)"),
+    ("lr_rel.c",            "rede (app)"),
+    ("lr_outbox.c",         "rede (app)"),
+    ("json_writer.c",       "rede (app)"),
+    ("net_sup.c",           "rede (app)"),
+    ("net_io.c",            "rede (app)"),
+    ("net_bench.c",         "rede (app)"),
+    ("mqtt.c",              "rede (app)"),
+    ("tele_batch.c",        "rede (app)"),
+    ("mpu6050_freertos.c",  "jogo/IMU/OLED"),
+    ("face_detect.c",       "jogo/IMU/OLED"),
+    ("lib/",                "jogo/IMU/OLED"),
+)
+
+# Resto (SDK, bibliotecas): trecho em qualquer lugar do caminho
+EXTERNOS = (
+    ("FreeRTOS",  "FreeRTOS"),
+    ("/lwip/",    "lwIP"),
+    ("cyw43",     "cyw43"),
+    ("libc.a",    "libc/libgcc"),
+    ("libm.a",    "libc/libgcc"),
+    ("libgcc",    "libc/libgcc"),
+)
+
+RE_REGIAO = re.compile(r"^(\w+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+RE_SECAO = re.compile(r"^ (\.\S+|COMMON)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+RE_SECAO_NOME = re.compile(r"^ (\.\S+|COMMON)\s*$")
+RE_SECAO_RESTO = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def subsistema(obj):
+    o = obj.replace("\\", "/")
+    k = o.find(".dir/")
+    rel = o[k + 5:] if k >= 0 else o
+    for pref, nome in APP:
+        if rel.startswith(pref):
+            return nome
+    for chave, nome in EXTERNOS:
+        if chave in o:
+            return nome
+    return "SDK/runtime"
+
+
+def ler_map(linhas):
+    regioes = {}
+    secoes = []   # (nome, endereço, tamanho, objeto)
+
+    i = 0
+    n = len(linhas)
+
+    # tabela de regiões
+    while i < n and not linhas[i].startswith("Memory Configuration"):
+        i += 1
+    while i < n and not linhas[i].startswith("Linker script and memory map"):
+        m = RE_REGIAO.match(linhas[i])
+        if m and m.group(1) in REGIOES_RAM:
+            regioes[m.group(1)] = (int(m.group(2), 16), int(m.group(3), 16))
+        i += 1
+
+    # seções de entrada (nome longo quebra a linha)
+    while i < n:
+        linha = linhas[i].rstrip("\n")
+        m = RE_SECAO.match(linha)
+        if m:
+            secoes.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()))
+        else:
+            m = RE_SECAO_NOME.match(linha)
+            if m and i + 1 < n:
+                r = RE_SECAO_RESTO.match(linhas[i + 1].rstrip("\n"))
+                if r:
+                    secoes.append((m.group(1), int(r.group(1), 16), int(r.group(2), 16), r.group(3).strip()))
+                    i += 1
+        i += 1
+
+    return regioes, secoes
+
+
+def regiao_de(regioes, addr):
+    for nome, (origem, tam) in regioes.items():
+        if origem <= addr < origem + tam:
+            return nome
+    return None
+
+
+def simbolo(nome_secao):
+    for pref in (".bss.", ".data.", ".time_critical.", ".scratch_x.", ".scratch_y.", ".sdata.", ".sbss."):
+        if nome_secao.startswith(pref):
+            return nome_secao[len(pref):]
+    return nome_secao
+
+
+def relatorio(regioes, secoes, top=15):
+    por_sub = {}
+    por_regiao = {r: 0 for r in regioes}
+    itens = []
+    uc_heap = 0
+
+    for nome, addr, tam, obj in secoes:
+        if tam == 0:
+            continue
+        reg = regiao_de(regioes, addr)
+        if reg is None:
+            continue
+        sub = subsistema(obj)
+        por_sub.setdefault(sub, {r: 0 for r in regioes})
+        por_sub[sub][reg] += tam
+        por_regiao[reg] += tam
+        itens.append((tam, simbolo(nome), sub, reg))
+        if simbolo(nome) == "ucHeap":
+            uc_heap += tam
+
+    ordem = [r for r in REGIOES_RAM if r in regioes]
+    out = []
+    out.append("RAM por região")
+    for r in ordem:
+        origem, tam = regioes[r]
+        out.append("  %-10s %7d / %7d bytes (%5.1f %%)" % (r, por_regiao[r], tam, 100.0 * por_regiao[r] / tam))
+
+    out.append("")
+    out.append("RAM por subsistema (bytes)")
+    out.append("  %-16s" % "" + "".join("%11s" % r for r in ordem) + "%11s" % "total")
+    for sub, regs in sorted(por_sub.items(), key=lambda kv: -sum(kv[1].values())):
+        out.append("  %-16s" % sub + "".join("%11d" % regs[r] for r in ordem) + "%11d" % sum(regs.values()))
+
+    out.append("")
+    out.append("Maiores objetos")
+    for tam, nome, sub, reg in sorted(itens, reverse=True)[:top]:
+        out.append("  %7d  %-28s %-16s %s" % (tam, nome, sub, reg))
+
+    out.append("")
+    out.append("heap do FreeRTOS (ucHeap): %d bytes" % uc_heap)
+    return "\n".join(out) + "\n"
+
+
+def main():
+    args = sys.argv[1:]
+    saida = None
+    if "-o" in args:
+        k = args.index("-o")
+        saida = args[k + 1]
+        del args[k:k + 2]
+    if len(args) != 1:
+        raise SystemExit("uso: mem_report.py <firmware.elf.map> [-o saida.txt]")
+
+    with open(args[0], "r", encoding="utf-8", errors="replace") as f:
+        regioes, secoes = ler_map(f.readlines())
+    if not regioes:
+        raise SystemExit("mem_report: tabela 'Memory Configuration' não encontrada")
+
+    texto = relatorio(regioes, secoes)
+    if saida:
+        with open(saida, "w", encoding="utf-8") as f:
+            f.write(texto)
+    sys.stdout.write(texto)
+
+
+if __name__ == "__main__":
+    main()
@@ -31,6 +31,15 @@ struct kiss_fft_state{
     kiss_fft_cpx twiddles[1];
 };
 
+struct kiss_fftr_state{
+    kiss_fft_cfg substate;
+    kiss_fft_cpx * tmpbuf;
+    kiss_fft_cpx * super_twiddles;
+#ifdef USE_SIMD
+    void * pad;
+#endif
+};
+
 /*
   Explanation of macros dealing with complex math:
 
@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "biquad.h"
+#include "hot_func.h"
+
+#define SIG_MAX  32767    // sinal interno: ADC ±2048 << BIQUAD_GUARD
+#define SIG_MIN  (-32768)
+
+bool biquad_cascade_init(biquad_cascade_t *c, const biquad_coef_t *coef, int n_stages)
+{
+    if (!c || n_stages < 0 || n_stages > BIQUAD_MAX_STAGES || (n_stages > 0 && !coef)) return false;
+
+    c->coef = coef;
+    c->n_stages = n_stages;
+    biquad_cascade_reset(c);
+    return true;
+}
+
+void biquad_cascade_reset(biquad_cascade_t *c)
+{
+    memset(c->st, 0, sizeof(c->st));
+}
+
+static inline int32_t sat_sig(int32_t v)
+{
+    if (v > SIG_MAX) return SIG_MAX;
+    if (v < SIG_MIN) return SIG_MIN;
+    return v;
+}
+
+void HOT_FUNC(biquad_cascade_process_adc)(biquad_cascade_t *c, const uint16_t *in, uint16_t *out, int n)
+{
+    for (int i = 0; i < n; i++) {
+        int32_t x = ((int32_t)in[i] - 2048) * (1 << BIQUAD_GUARD);
+
+        for (int s = 0; s < c->n_stages; s++) {
+            const biquad_coef_t *k = &c->coef[s];
+            biquad_state_t *st = &c->st[s];
+
+            int64_t acc = st->err;
+            acc += (int32_t)k->b0 * x;
+            acc += (int32_t)k->b1 * st->x1;
+            acc += (int32_t)k->b2 * st->x2;
+            acc -= (int32_t)k->a1 * st->y1;
+            acc -= (int32_t)k->a2 * st->y2;
+
+            int32_t y = (int32_t)(acc >> BIQUAD_Q);
+            st->err = (int32_t)(acc - ((int64_t)y << BIQUAD_Q));
+            y = sat_sig(y);
+
+            st->x2 = st->x1; st->x1 = x;
+            st->y2 = st->y1; st->y1 = y;
+            x = y;
+        }
+
+        // volta para o formato do ADC (arredonda os bits de guarda)
+        int32_t v = ((x + (1 << (BIQUAD_GUARD - 1))) >> BIQUAD_GUARD) + 2048;
+        if (v < 0) v = 0;
+        if (v > 4095) v = 4095;
+        out[i] = (uint16_t)v;
+    }
+}
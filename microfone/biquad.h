@@ -0,0 +1,57 @@
+#ifndef BIQUAD_H
+#define BIQUAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// =========================
+// Cascata de biquads IIR em ponto fixo (pré-filtro do microfone)
+// =========================
+// Direct Form I, coeficientes Q14 (int16, faixa ±2) e sinal interno com
+// BIQUAD_GUARD bits de fração (ADC de 12 bits centrado -> ±2^15). Todo
+// produto é 16x16 -> 32 bits (MULS de 1 ciclo no Cortex-M0+); a soma dos
+// 5 termos vai em 64 bits. O resto do shift volta na amostra seguinte
+// (error feedback), então polos perto de z = 1 (passa-altas de poucos Hz,
+// notch estreito) não viram ruído/offset de arredondamento.
+//
+// O estado é mantido entre blocos: a cascata roda em streaming sobre os
+// blocos do DMA, sem transiente a cada quadro.
+//
+// Coeficientes: gerados no build por gen_biquad.py (mic_biquad_coefs.h).
+//
+// Custo (estimado, M0+): ~30 ciclos por estágio por amostra
+// -> bloco de 256 amostras com 2 estágios ~ 15k ciclos (~120 us a 125 MHz),
+//    menos de 1 % do período do bloco (12,8 ms a 20 kHz). O firmware mede e
+//    imprime o custo real no log do microfone ("filt=").
+
+#define BIQUAD_Q           14
+#define BIQUAD_GUARD       4
+#define BIQUAD_MAX_STAGES  4
+
+typedef struct {
+    int16_t b0, b1, b2;
+    int16_t a1, a2;      // a0 = 1 (já normalizado)
+} biquad_coef_t;
+
+typedef struct {
+    int32_t x1, x2;
+    int32_t y1, y2;
+    int32_t err;         // resto do último shift (error feedback)
+} biquad_state_t;
+
+typedef struct {
+    const biquad_coef_t *coef;
+    int                  n_stages;
+    biquad_state_t       st[BIQUAD_MAX_STAGES];
+} biquad_cascade_t;
+
+// false se n_stages fora de 0..BIQUAD_MAX_STAGES
+bool biquad_cascade_init(biquad_cascade_t *c, const biquad_coef_t *coef, int n_stages);
+
+void biquad_cascade_reset(biquad_cascade_t *c);
+
+// in: leituras brutas do ADC (12 bits); out: filtrado, recentrado em 2048 e
+// limitado a 0..4095 (mesmo formato do buffer do DMA). in == out é permitido.
+void biquad_cascade_process_adc(biquad_cascade_t *c, const uint16_t *in, uint16_t *out, int n);
+
+#endif
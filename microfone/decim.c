@@ -0,0 +1,62 @@
+#include <string.h>
+
+#include "decim.h"
+#include "hot_func.h"
+
+bool decim_cic_init(decim_cic_t *d, int r)
+{
+    if (!d || r < 1 || r > DECIM_MAX_R || (r & (r - 1)) != 0) return false;
+
+    int log2r = 0;
+    while ((1 << log2r) < r) log2r++;
+
+    d->r = r;
+    d->shift = DECIM_CIC_ORDER * log2r;
+    decim_cic_reset(d);
+    return true;
+}
+
+void decim_cic_reset(decim_cic_t *d)
+{
+    d->phase = 0;
+    memset(d->integ, 0, sizeof(d->integ));
+    memset(d->comb, 0, sizeof(d->comb));
+}
+
+int HOT_FUNC(decim_cic_process_adc)(decim_cic_t *d, const uint16_t *in, int n, uint16_t *out)
+{
+    if (d->r == 1) {
+        if (out != in) memcpy(out, in, (size_t)n * sizeof(*out));
+        return n;
+    }
+
+    int produced = 0;
+
+    for (int i = 0; i < n; i++) {
+        // integradores (modulares)
+        uint32_t v = (uint32_t)((int32_t)in[i] - 2048);
+        for (int k = 0; k < DECIM_CIC_ORDER; k++) {
+            d->integ[k] += v;
+            v = d->integ[k];
+        }
+
+        if (++d->phase < d->r) continue;
+        d->phase = 0;
+
+        // pentes (atraso diferencial 1, na taxa de saída)
+        for (int k = 0; k < DECIM_CIC_ORDER; k++) {
+            uint32_t prev = d->comb[k];
+            d->comb[k] = v;
+            v -= prev;
+        }
+
+        // tira o ganho r^ORDEM (arredondando) e volta ao formato do ADC
+        int32_t y = ((int32_t)v + (1 << (d->shift - 1))) >> d->shift;
+        y += 2048;
+        if (y < 0) y = 0;
+        if (y > 4095) y = 4095;
+        out[produced++] = (uint16_t)y;
+    }
+
+    return produced;
+}
@@ -0,0 +1,45 @@
+#ifndef DECIM_H
+#define DECIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// =========================
+// Decimador CIC (inteiro) do microfone
+// =========================
+// O ADC continua a 20 kHz; o CIC de ordem DECIM_CIC_ORDER entrega 1 amostra
+// a cada r para o analisador. Com a mesma FFT de SAMPLES pontos o bin fica
+// r vezes mais estreito (20 kHz / 256 = 78 Hz -> r = 4: 19,5 Hz).
+//
+// Só somas/subtrações (sem multiplicação): integradores a cada amostra de
+// entrada, pentes a cada saída. Os integradores estouram de propósito
+// (aritmética modular em uint32): o resultado dos pentes continua exato
+// enquanto a saída cabe em 32 bits (12 + ORDEM*log2(r) bits).
+//
+// Resposta: |H(f)| = |sin(π f r / fs) / (r sin(π f / fs))|^ORDEM
+//   - queda na banda útil (r = 4, ordem 3): -0,6 dB em 600 Hz, -6,8 dB em 2 kHz
+//   - tons acima da nova Nyquist dobram com atenuação dos nulos do sinc
+//     (ex.: 4 kHz -> 1 kHz a -36 dB); a classe "agudo" (>= 600 Hz) continua
+//     existindo, mas a intensidade dos agudos perto da Nyquist cai.
+
+#define DECIM_CIC_ORDER  3
+#define DECIM_MAX_R      64
+
+typedef struct {
+    int      r;
+    int      shift;                     // ORDEM * log2(r): ganho do CIC
+    int      phase;                     // amostras de entrada desde a última saída
+    uint32_t integ[DECIM_CIC_ORDER];
+    uint32_t comb[DECIM_CIC_ORDER];     // última entrada de cada pente
+} decim_cic_t;
+
+// r: potência de 2 entre 1 e DECIM_MAX_R (1 = repassa as amostras)
+bool decim_cic_init(decim_cic_t *d, int r);
+
+void decim_cic_reset(decim_cic_t *d);
+
+// in: n leituras do ADC (12 bits); out: recebe até n/r + 1 amostras no mesmo
+// formato (recentradas em 2048). Retorna quantas amostras escreveu.
+int  decim_cic_process_adc(decim_cic_t *d, const uint16_t *in, int n, uint16_t *out);
+
+#endif
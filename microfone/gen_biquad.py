@@ -0,0 +1,122 @@
+"""
+Gera os coeficientes da cascata de biquads do microfone (biquad.h) para os
+parâmetros escolhidos no build.
+
+Uso (o CMake roda isto, ver MIC_HP_HZ / MIC_NOTCH_HZ / MIC_NOTCH_Q):
+    python gen_biquad.py <fs> <hp_hz> <notch_hz[,notch_hz...]> <notch_q> <saida.h>
+
+- hp_hz:    passa-altas Butterworth de 2ª ordem (remove DC e ronco);
+            0 desliga
+- notch_hz: lista separada por vírgula (ex.: "390" ou "390,780");
+            "" ou "0" desliga
+- notch_q:  Q dos notches (largura ~ f/Q)
+
+Fórmulas do "Audio EQ Cookbook" (R. Bristow-Johnson), normalizadas por a0
+e quantizadas em Q14. O header também traz os coeficientes em double para
+o bench comparar a resposta quantizada com a ideal.
+"""
+
+import math
+import sys
+
+Q = 14
+ESCALA = 1 << Q
+
+
+def highpass(fs, f0, q=1 / math.sqrt(2)):
+    w = 2 * math.pi * f0 / fs
+    alpha = math.sin(w) / (2 * q)
+    c = math.cos(w)
+    b = [(1 + c) / 2, -(1 + c), (1 + c) / 2]
+    a = [1 + alpha, -2 * c, 1 - alpha]
+    return b, a
+
+
+def notch(fs, f0, q):
+    w = 2 * math.pi * f0 / fs
+    alpha = math.sin(w) / (2 * q)
+    c = math.cos(w)
+    b = [1, -2 * c, 1]
+    a = [1 + alpha, -2 * c, 1 - alpha]
+    return b, a
+
+
+def quantiza(v):
+    iv = int(math.floor(v * ESCALA + 0.5))
+    if iv < -32768 or iv > 32767:
+        raise SystemExit("coeficiente %.6f fora de Q14" % v)
+    return iv
+
+
+def gerar(fs, hp_hz, notches, notch_q):
+    estagios = []
+    if hp_hz > 0:
+        estagios.append(("passa-altas %g Hz" % hp_hz, highpass(fs, hp_hz)))
+    for f in notches:
+        estagios.append(("notch %g Hz (Q %g)" % (f, notch_q), notch(fs, f, notch_q)))
+
+    if len(estagios) > 4:
+        raise SystemExit("mais estágios que BIQUAD_MAX_STAGES")
+
+    linhas = []
+    linhas.append("// Gerado por microfone/gen_biquad.py - não editar.")
+    linhas.append("#ifndef MIC_BIQUAD_COEFS_H")
+    linhas.append("#define MIC_BIQUAD_COEFS_H")
+    linhas.append("")
+    linhas.append('#include "biquad.h"')
+    linhas.append("")
+    linhas.append("#define MIC_BIQUAD_FS        %d" % fs)
+    linhas.append("#define MIC_BIQUAD_N_STAGES  %d" % len(estagios))
+    linhas.append('#define MIC_BIQUAD_DESC      "%s"' % ("; ".join(n for n, _ in estagios) or "sem filtro"))
+    linhas.append("")
+
+    dim = max(len(estagios), 1)
+    linhas.append("// b0, b1, b2, a1, a2 em Q%d" % Q)
+    linhas.append("static const biquad_coef_t mic_biquad_coefs[%d] = {" % dim)
+    for nome, (b, a) in estagios:
+        a0 = a[0]
+        vals = [b[0] / a0, b[1] / a0, b[2] / a0, a[1] / a0, a[2] / a0]
+        linhas.append("    { %s },   // %s" % (", ".join(str(quantiza(v)) for v in vals), nome))
+    if not estagios:
+        linhas.append("    { 0 },")
+    linhas.append("};")
+    linhas.append("")
+    linhas.append("// mesmos coeficientes sem quantizar (referência do bench)")
+    linhas.append("static const double mic_biquad_coefs_ref[%d][5] = {" % dim)
+    for nome, (b, a) in estagios:
+        a0 = a[0]
+        vals = [b[0] / a0, b[1] / a0, b[2] / a0, a[1] / a0, a[2] / a0]
+        linhas.append("    { %s }," % ", ".join(repr(v) for v in vals))
+    if not estagios:
+        linhas.append("    { 0 },")
+    linhas.append("};")
+    linhas.append("")
+    linhas.append("#endif")
+    return "\n".join(linhas) + "\n"
+
+
+def main():
+    if len(sys.argv) != 6:
+        raise SystemExit("uso: gen_biquad.py <fs> <hp_hz> <notch_hz[,...]> <notch_q> <saida.h>")
+
+    fs = int(sys.argv[1])
+    hp_hz = float(sys.argv[2])
+    notches = [float(x) for x in sys.argv[3].replace(";", ",").split(",") if x.strip() and float(x) > 0]
+    notch_q = float(sys.argv[4])
+
+    texto = gerar(fs, hp_hz, notches, notch_q)
+
+    # só reescreve se mudou (não força recompilação à toa)
+    try:
+        with open(sys.argv[5], "r", encoding="utf-8") as f:
+            if f.read() == texto:
+                return
+    except OSError:
+        pass
+
+    with open(sys.argv[5], "w", encoding="utf-8") as f:
+        f.write(texto)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,162 @@
+"""
+Gera a configuração do kiss_fftr (twiddles, super-twiddles e fatores) para
+um tamanho fixo de FFT, como dados const em C (ficam na flash do RP2040).
+
+Uso (o CMake roda isto no build, ver MIC_FFT_SIZE):
+    python gen_fft_tables.py <nfft> <saida.c>
+
+Os valores reproduzem exatamente kiss_fft_alloc/kiss_fftr_alloc (mesma
+fórmula de fase e mesmo arredondamento) para os três tipos de escalar:
+float, FIXED_POINT=16 e FIXED_POINT=32. O tipo é escolhido no #if do
+arquivo gerado, então o mesmo .c serve para qualquer MIC_FFT_FIXED_POINT.
+"""
+
+import math
+import sys
+
+MAXFACTORS = 32
+
+Q15_MAX = 32767
+Q31_MAX = 2147483647
+
+
+def kf_factor(n):
+    # mesma ordem do kf_factor() do kiss_fft.c: potências de 4, de 2, primos
+    fac = []
+    p = 4
+    floor_sqrt = math.floor(math.sqrt(n))
+    while True:
+        while n % p:
+            if p == 4:
+                p = 2
+            elif p == 2:
+                p = 3
+            else:
+                p += 2
+            if p > floor_sqrt:
+                p = n
+        n //= p
+        fac += [p, n]
+        if n <= 1:
+            break
+    return fac
+
+
+def twiddle_phases(ncfft):
+    # kiss_fft_alloc: phase = -2*pi*i / nfft
+    return [-2 * math.pi * i / ncfft for i in range(ncfft)]
+
+
+def super_twiddle_phases(ncfft):
+    # kiss_fftr_alloc: phase = -pi * ((i+1)/ncfft + .5)
+    return [-math.pi * ((i + 1) / ncfft + .5) for i in range(ncfft // 2)]
+
+
+def fmt_fix(phase, samp_max):
+    # KISS_FFT_COS/SIN em ponto fixo: floor(.5 + SAMP_MAX * cos(phase))
+    r = math.floor(.5 + samp_max * math.cos(phase))
+    i = math.floor(.5 + samp_max * math.sin(phase))
+    return "{%d, %d}" % (r, i)
+
+
+def fmt_float(phase):
+    # (kiss_fft_scalar) cos(phase): o compilador faz o mesmo double -> float
+    return "{%r, %r}" % (math.cos(phase), math.sin(phase))
+
+
+def linhas_cpx(fases, indent):
+    # uma lista de valores por tipo de escalar, escolhida no #if do .c gerado
+    out = []
+    for variante, fmt in (("#if defined(FIXED_POINT) && (FIXED_POINT == 32)", lambda p: fmt_fix(p, Q31_MAX)),
+                          ("#elif defined(FIXED_POINT)", lambda p: fmt_fix(p, Q15_MAX)),
+                          ("#else", fmt_float)):
+        out.append(variante)
+        out += ["%s%s," % (indent, fmt(p)) for p in fases]
+    out.append("#endif")
+    return out
+
+
+def gerar(nfft):
+    if nfft < 4 or nfft % 4:
+        raise SystemExit("nfft precisa ser múltiplo de 4 (kiss_fftr usa nfft/2 e nfft/4)")
+
+    ncfft = nfft // 2
+    fac = kf_factor(ncfft)
+    if len(fac) > 2 * MAXFACTORS:
+        raise SystemExit("fatores demais para MAXFACTORS")
+
+    linhas = []
+    linhas.append("// Gerado por microfone/gen_fft_tables.py - não editar.")
+    linhas.append("// kiss_fftr de %d pontos (kiss_fft complexo de %d) em dados const" % (nfft, ncfft))
+    linhas.append("// (flash; com HOT_IN_RAM os twiddles vão para a RAM, hot_func.h).")
+    linhas.append("")
+    linhas.append("#include <stddef.h>")
+    linhas.append("")
+    linhas.append('#include "_kiss_fft_guts.h"')
+    linhas.append('#include "mic_fft_tables.h"')
+    linhas.append('#include "hot_func.h"')
+    linhas.append("")
+    linhas.append("#define TBL_NFFT  %d" % nfft)
+    linhas.append("#define TBL_NCFFT %d" % ncfft)
+    linhas.append("")
+    linhas.append("// mesmo layout de struct kiss_fft_state, com os twiddles no tamanho real")
+    linhas.append("typedef struct {")
+    linhas.append("    int nfft;")
+    linhas.append("    int inverse;")
+    linhas.append("    int factors[2*MAXFACTORS];")
+    linhas.append("    kiss_fft_cpx twiddles[TBL_NCFFT];")
+    linhas.append("} tbl_fft_state_t;")
+    linhas.append("")
+    linhas.append("_Static_assert(offsetof(tbl_fft_state_t, twiddles) == offsetof(struct kiss_fft_state, twiddles),")
+    linhas.append('               "layout de kiss_fft_state mudou");')
+    linhas.append("")
+    linhas.append('static const tbl_fft_state_t HOT_DATA("mic_fft") tbl_substate = {')
+    linhas.append("    .nfft    = TBL_NCFFT,")
+    linhas.append("    .inverse = 0,")
+    linhas.append("    .factors = { %s }," % ", ".join(str(f) for f in fac))
+    linhas.append("    .twiddles = {")
+    linhas += linhas_cpx(twiddle_phases(ncfft), "        ")
+    linhas.append("    },")
+    linhas.append("};")
+    linhas.append("")
+    linhas.append('static const kiss_fft_cpx HOT_DATA("mic_fft") tbl_super_twiddles[TBL_NCFFT / 2] = {')
+    linhas += linhas_cpx(super_twiddle_phases(ncfft), "    ")
+    linhas.append("};")
+    linhas.append("")
+    linhas.append("// único pedaço em RAM: área de trabalho do kiss_fftr")
+    linhas.append("static kiss_fft_cpx tbl_tmpbuf[TBL_NCFFT];")
+    linhas.append("")
+    linhas.append("static const struct kiss_fftr_state tbl_fftr = {")
+    linhas.append("    .substate       = (kiss_fft_cfg)&tbl_substate,")
+    linhas.append("    .tmpbuf         = tbl_tmpbuf,")
+    linhas.append("    .super_twiddles = (kiss_fft_cpx *)tbl_super_twiddles,")
+    linhas.append("};")
+    linhas.append("")
+    linhas.append("kiss_fftr_cfg mic_fft_tables_cfg(int nfft)")
+    linhas.append("{")
+    linhas.append("    if (nfft != TBL_NFFT) return NULL;")
+    linhas.append("    return (kiss_fftr_cfg)&tbl_fftr;")
+    linhas.append("}")
+    return "\n".join(linhas) + "\n"
+
+
+def main():
+    if len(sys.argv) != 3:
+        raise SystemExit("uso: gen_fft_tables.py <nfft> <saida.c>")
+
+    texto = gerar(int(sys.argv[1]))
+
+    # só reescreve se mudou (não força recompilação à toa)
+    try:
+        with open(sys.argv[2], "r", encoding="utf-8") as f:
+            if f.read() == texto:
+                return
+    except OSError:
+        pass
+
+    with open(sys.argv[2], "w", encoding="utf-8") as f:
+        f.write(texto)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,252 @@
+#include "hot_bench.h"
+
+#if defined(HOT_BENCH) && HOT_BENCH
+
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/structs/xip_ctrl.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "mic_dsp.h"
+#include "noise_gate.h"
+#include "json_writer.h"
+#if MIC_PREFILTER
+#include "biquad.h"
+#include "mic_biquad_coefs.h"
+#endif
+#if MIC_DECIM > 1
+#include "decim.h"
+#endif
+
+#define HB_REPS  64
+
+static uint16_t hb_in[SAMPLES];
+static uint16_t hb_out[SAMPLES + 1];
+
+#if MIC_PREFILTER
+static biquad_cascade_t hb_bq;
+#endif
+#if MIC_DECIM > 1
+static decim_cic_t hb_cic;
+#endif
+
+static void hb_dsp(void)       { mic_dsp_result_t r; mic_dsp_analyze(hb_in, &r); }
+static void hb_energy(void)    { volatile uint32_t e = noise_gate_frame_energy(hb_in, SAMPLES); (void)e; }
+#if MIC_PREFILTER
+static void hb_prefilter(void) { biquad_cascade_process_adc(&hb_bq, hb_in, hb_out, SAMPLES); }
+#endif
+#if MIC_DECIM > 1
+static void hb_decim(void)     { decim_cic_process_adc(&hb_cic, hb_in, SAMPLES, hb_out); }
+#endif
+
+// telemetria do MQTT: o snprintf único de antes x o json_writer (mesmo objeto)
+static char hb_json[512];
+static void hb_json_snprintf(void) {
+    volatile float f = 440.0f, i = 0.734f, r = 0.0213f, c = 1830.0f, fl = 0.112f, z = 0.087f;
+    snprintf(hb_json, sizeof(hb_json),
+             "{\"estado\":%d,\"user\":\"%s\",\"modo\":\"%s\",\"alvo\":\"%s\",\"face\":\"%s\",\"info\":\"%s\","
+             "\"mic_freq\":%.1f,\"mic_int\":%.3f,\"mic_type\":%u,\"mic_rms\":%.4f,\"mic_cent\":%.0f,"
+             "\"mic_flat\":%.3f,\"mic_zcr\":%.3f,\"ok_total\":%u,\"err_total\":%u,\"last_ms\":%u,\"avg_ms\":%u}",
+             1, "Davi", "NIVEL 1", "FRENTE", "TOPO", "OK:12 ER:3",
+             f, i, 2u, r, c, fl, z, 12u, 3u, 812u, 945u);
+}
+static void hb_json_writer(void) {
+    volatile float f = 440.0f, i = 0.734f, r = 0.0213f, c = 1830.0f, fl = 0.112f, z = 0.087f;
+    jw_t w;
+    jw_init(&w, hb_json, sizeof(hb_json));
+    jw_obj_begin(&w);
+    jw_key(&w, "estado");    jw_i32(&w, 1);
+    jw_key(&w, "user");      jw_str(&w, "Davi");
+    jw_key(&w, "modo");      jw_str(&w, "NIVEL 1");
+    jw_key(&w, "alvo");      jw_str(&w, "FRENTE");
+    jw_key(&w, "face");      jw_str(&w, "TOPO");
+    jw_key(&w, "info");      jw_str(&w, "OK:12 ER:3");
+    jw_key(&w, "mic_freq");  jw_fix(&w, f, 1);
+    jw_key(&w, "mic_int");   jw_fix(&w, i, 3);
+    jw_key(&w, "mic_type");  jw_u32(&w, 2);
+    jw_key(&w, "mic_rms");   jw_fix(&w, r, 4);
+    jw_key(&w, "mic_cent");  jw_fix(&w, c, 0);
+    jw_key(&w, "mic_flat");  jw_fix(&w, fl, 3);
+    jw_key(&w, "mic_zcr");   jw_fix(&w, z, 3);
+    jw_key(&w, "ok_total");  jw_u32(&w, 12);
+    jw_key(&w, "err_total"); jw_u32(&w, 3);
+    jw_key(&w, "last_ms");   jw_u32(&w, 812);
+    jw_key(&w, "avg_ms");    jw_u32(&w, 945);
+    jw_obj_end(&w);
+    jw_finish(&w);
+}
+
+typedef struct {
+    const char *nome;
+    void (*fn)(void);
+} hb_caso_t;
+
+static const hb_caso_t HB_CASOS[] = {
+    { "mic_dsp_analyze", hb_dsp },
+    { "frame_energy",    hb_energy },
+#if MIC_PREFILTER
+    { "biquad_cascade",  hb_prefilter },
+#endif
+#if MIC_DECIM > 1
+    { "decim_cic",       hb_decim },
+#endif
+    { "json_snprintf",   hb_json_snprintf },
+    { "json_writer",     hb_json_writer },
+};
+
+// invalida o cache XIP inteiro; a leitura do FLUSH espera terminar
+static inline void hb_xip_flush(void) {
+    xip_ctrl_hw->flush = 1;
+    (void)xip_ctrl_hw->flush;
+}
+
+static void hb_medir(const hb_caso_t *c, bool frio, uint32_t *med, uint32_t *max) {
+    uint32_t soma = 0, pior = 0;
+    c->fn();   // aquece dados/estado
+
+    for (int i = 0; i < HB_REPS; i++) {
+        if (frio) hb_xip_flush();
+        uint32_t t0 = time_us_32();
+        c->fn();
+        uint32_t dt = time_us_32() - t0;
+        soma += dt;
+        if (dt > pior) pior = dt;
+    }
+    *med = soma / HB_REPS;
+    *max = pior;
+}
+
+// contenção: uma task no core 0 copiando blocos na SRAM principal sem
+// parar (o pior caso de core 0 + DMA do Wi-Fi nos mesmos bancos)
+#define HB_HAMMER_BYTES 8192
+static volatile bool hb_hammer_run = false;
+static uint8_t       hb_hammer_buf[HB_HAMMER_BYTES];
+static StackType_t   hb_hammer_stack[256];
+static StaticTask_t  hb_hammer_tcb;
+
+static void hb_hammer_task(void *arg)
+{
+    uint8_t *buf = (uint8_t *)arg;
+    while (hb_hammer_run) {
+        memcpy(buf, buf + HB_HAMMER_BYTES / 2, HB_HAMMER_BYTES / 2);
+        memcpy(buf + HB_HAMMER_BYTES / 2, buf, HB_HAMMER_BYTES / 2);
+    }
+    vTaskDelete(NULL);
+}
+
+// jitter do período da GameTask: ela soma a cada espera, o hb_contencao
+// zera no começo de cada janela e lê no fim (a soma da Health é outra)
+#define HB_JIT_MS 2000   // ~50 voltas de LOOP_MS
+static volatile uint32_t hb_jit_sum_us = 0, hb_jit_max_us = 0, hb_jit_n = 0;
+static volatile bool     hb_jit_reset = false;
+
+void hot_bench_game_jitter(uint32_t jit_us)
+{
+    if (hb_jit_reset) {
+        hb_jit_sum_us = 0; hb_jit_max_us = 0; hb_jit_n = 0;
+        hb_jit_reset = false;
+    }
+    hb_jit_sum_us += jit_us;
+    hb_jit_n++;
+    if (jit_us > hb_jit_max_us) hb_jit_max_us = jit_us;
+}
+
+typedef struct {
+    uint32_t dsp_med, dsp_max;   // mic_dsp_analyze, us
+    uint32_t jit_med, jit_max;   // período da GameTask, us
+    uint32_t voltas;
+} hb_janela_t;
+
+// mic_dsp_analyze sem parar por HB_JIT_MS, com o jitter do jogo no mesmo tempo
+static void hb_janela(hb_janela_t *j)
+{
+    uint64_t soma = 0;
+    uint32_t n = 0, pior = 0;
+
+    hb_jit_reset = true;
+    vTaskDelay(pdMS_TO_TICKS(100));   // a GameTask zera na próxima volta (LOOP_MS = 40)
+    uint32_t t_ini = time_us_32();
+    while (time_us_32() - t_ini < HB_JIT_MS * 1000u) {
+        uint32_t med, max;
+        hb_medir(&HB_CASOS[0], false, &med, &max);
+        soma += (uint64_t)med * HB_REPS;
+        n += HB_REPS;
+        if (max > pior) pior = max;
+        vTaskDelay(1);   // deixa as tasks de prioridade 1 do core 1 rodarem
+    }
+    uint32_t jn = hb_jit_n;
+    j->dsp_med = n ? (uint32_t)(soma / n) : 0;
+    j->dsp_max = pior;
+    j->jit_med = jn ? hb_jit_sum_us / jn : 0;
+    j->jit_max = hb_jit_max_us;
+    j->voltas  = jn;
+}
+
+static void hb_contencao(void)
+{
+    hb_janela_t livre, martelo;
+    hb_janela(&livre);
+
+    hb_hammer_run = true;
+    xTaskCreateStaticAffinitySet(hb_hammer_task, "hb_hammer", 256, hb_hammer_buf, 1,
+                                 hb_hammer_stack, &hb_hammer_tcb, (1u << 0));
+    vTaskDelay(pdMS_TO_TICKS(5));
+    hb_janela(&martelo);
+    hb_hammer_run = false;
+    vTaskDelay(pdMS_TO_TICKS(5));   // a task sai sozinha
+
+#if defined(SCRATCH_BANKS) && SCRATCH_BANKS
+    const char *onde = "SCRATCH_X";
+#else
+    const char *onde = "SRAM principal";
+#endif
+    printf("[HOT] contenção (adc_buffer em %s), %u ms cada, med/max em us:\n", onde, HB_JIT_MS);
+    printf("[HOT]   %-16s %13s %13s\n", "", "core 0 livre", "martelando");
+    printf("[HOT]   %-16s %6u %6u %6u %6u\n", HB_CASOS[0].nome,
+           (unsigned)livre.dsp_med, (unsigned)livre.dsp_max, (unsigned)martelo.dsp_med, (unsigned)martelo.dsp_max);
+    printf("[HOT]   %-16s %6u %6u %6u %6u  (%u/%u voltas)\n", "jitter GameTask",
+           (unsigned)livre.jit_med, (unsigned)livre.jit_max, (unsigned)martelo.jit_med, (unsigned)martelo.jit_max,
+           (unsigned)livre.voltas, (unsigned)martelo.voltas);
+}
+
+void hot_bench_run(void)
+{
+    mic_dsp_init();
+#if MIC_PREFILTER
+    biquad_cascade_init(&hb_bq, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+#endif
+#if MIC_DECIM > 1
+    decim_cic_init(&hb_cic, MIC_DECIM);
+#endif
+    for (int n = 0; n < SAMPLES; n++) {
+        hb_in[n] = (uint16_t)(2048 + 700.0f * sinf(2.0f * 3.14159265f * 440.0f * n / MIC_ADC_RATE)
+                                   + 90.0f * sinf(2.0f * 3.14159265f * 2300.0f * n / MIC_ADC_RATE));
+    }
+
+#if defined(HOT_IN_RAM) && HOT_IN_RAM
+    const char *onde = "RAM";
+#else
+    const char *onde = "flash/XIP";
+#endif
+    printf("[HOT] funções quentes em %s, %d repetições, tempos em us\n", onde, HB_REPS);
+    printf("[HOT] %-16s %9s %9s %9s %9s\n", "função", "quente", "q.max", "frio", "f.max");
+
+    for (unsigned i = 0; i < sizeof(HB_CASOS) / sizeof(HB_CASOS[0]); i++) {
+        uint32_t qm, qx, fm, fx;
+        hb_medir(&HB_CASOS[i], false, &qm, &qx);
+        hb_medir(&HB_CASOS[i], true,  &fm, &fx);
+        printf("[HOT] %-16s %9u %9u %9u %9u\n", HB_CASOS[i].nome,
+               (unsigned)qm, (unsigned)qx, (unsigned)fm, (unsigned)fx);
+    }
+
+    hb_contencao();
+}
+
+#endif // HOT_BENCH
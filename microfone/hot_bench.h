@@ -0,0 +1,34 @@
+#ifndef HOT_BENCH_H
+#define HOT_BENCH_H
+
+#include <stdint.h>
+
+// =========================
+// Benchmark no alvo das funções quentes (HOT_FUNC)
+// =========================
+// Roda cada função do caminho do microfone com o cache XIP quente
+// (chamadas seguidas) e frio (flush do XIP antes de cada chamada, o pior
+// caso de quando o cyw43/lwIP expulsam as linhas) e imprime médio/máximo.
+// Compilar duas vezes (HOT_IN_RAM=ON e OFF) dá o "com e sem" da mudança;
+// é essa tabela que tem que decidir a lista do hot_func.h.
+//
+// Contenção de banco: repete o mic_dsp_analyze por HB_JIT_MS com e sem uma
+// task no core 0 copiando memória na SRAM principal sem parar, e mede nas
+// mesmas janelas o jitter do período da GameTask (hot_bench_game_jitter).
+// Comparar SCRATCH_BANKS=ON/OFF (só o adc_buffer muda: SCRATCH_X ou SRAM
+// principal) pelas duas linhas.
+//
+// json_snprintf/json_writer: o objeto de telemetria do MQTT montado pelo
+// snprintf antigo (%f em soft-float) e pelo json_writer.c.
+//
+// Só existe com HOT_BENCH=1 (opção do CMake); chamado no início da MicTask,
+// no core onde o DSP roda de verdade.
+
+#if defined(HOT_BENCH) && HOT_BENCH
+void hot_bench_run(void);
+
+// GameTask: desvio de cada espera de LOOP_MS, para o jitter do hb_contencao
+void hot_bench_game_jitter(uint32_t jit_us);
+#endif
+
+#endif
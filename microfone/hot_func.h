@@ -0,0 +1,55 @@
+#ifndef HOT_FUNC_H
+#define HOT_FUNC_H
+
+// =========================
+// Funções quentes em SRAM
+// =========================
+// Por padrão todo o código roda da flash QSPI pelo cache XIP (16 KB). Quando
+// o cyw43/lwIP expulsam linhas do cache, a FFT e a IRQ do DMA pagam a volta
+// na flash. HOT_FUNC(nome) coloca a função na seção .time_critical (copiada
+// para a RAM no boot, mesma coisa que __not_in_flash_func do SDK).
+//
+// Candidatos: só o que roda a cada bloco do DMA ou quadro (FFT, pré-filtro,
+// CIC, energia, IRQ do DMA). A lista ainda não foi medida no
+// alvo, por isso HOT_IN_RAM é OFF por padrão: ligar (e cortar daqui o que
+// não ganhar) depois da tabela [HOT] do hot_bench.c com HOT_IN_RAM=ON e OFF.
+// O detector de face (a cada 40 ms) fica na flash.
+//
+// FFT float: as butterflies chamam __aeabi_f* do SDK, que só vão para a RAM
+// com PICO_FLOAT_IN_RAM (o CMake liga junto com HOT_IN_RAM), e leem os
+// twiddles gerados no build, que HOT_DATA põe na RAM junto.
+//
+// No PC (bench/) e com HOT_IN_RAM=OFF vira o nome puro.
+//
+// Bancos SCRATCH_X/SCRATCH_Y (4 KB cada, fora da SRAM "listrada" de 256 KB):
+// o SDK já põe no topo deles a pilha MSP de cada core (Y = core 0, onde o
+// cyw43/lwIP rodam em IRQ; X = core 1). SCRATCH_X_DATA põe dados do core 1
+// no resto do banco dele: o adc_buffer ping-pong (1 KB em 256 pts), que o
+// DMA escreve e a MicTask lê sem disputar banco com o core 0.
+// Nada do core 1 vai para o Y (é do core 0). A pilha da MicTask e o
+// fft_input ficam na SRAM principal: a pilha só cabe no X depois de medido
+// o [STACK] Mic da Health (com folga), e o fft_input só muda de lugar se o
+// hot_bench mostrar ganho. O linker do SDK recusa o build se algum banco
+// estourar.
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE
+#include "pico/platform.h"
+#endif
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE && defined(HOT_IN_RAM) && HOT_IN_RAM
+#define HOT_FUNC(name) __not_in_flash_func(name)
+#define HOT_DATA(group) __not_in_flash(group)
+#else
+#define HOT_FUNC(name) name
+#define HOT_DATA(group)
+#endif
+
+#if defined(PICO_ON_DEVICE) && PICO_ON_DEVICE && defined(SCRATCH_BANKS) && SCRATCH_BANKS
+#define SCRATCH_X_DATA(group) __scratch_x(group)
+#define SCRATCH_Y_DATA(group) __scratch_y(group)
+#else
+#define SCRATCH_X_DATA(group)
+#define SCRATCH_Y_DATA(group)
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+#include <math.h>
+#include <string.h>
+
+#include "led_viz.h"
+
+void led_viz_init(led_viz_t *v)
+{
+    memset(v, 0, sizeof(*v));
+    for (int c = 0; c < LV_COLS; c++) v->level_db[c] = LV_FLOOR_DB;
+}
+
+void led_viz_push(led_viz_t *v, const mic_features_t *f)
+{
+    float p_total = f->rms * f->rms;
+    for (int c = 0; c < LV_COLS; c++) {
+        float db = 10.0f * log10f(p_total * f->viz[c] + 1e-12f);
+        if (db > v->level_db[c]) v->level_db[c] = db;
+    }
+}
+
+uint8_t led_viz_height(const led_viz_t *v, int col)
+{
+    float x = (v->level_db[col] - LV_FLOOR_DB) * (LV_ROWS / (LV_TOP_DB - LV_FLOOR_DB));
+    if (x <= 0.0f) return 0;
+    if (x >= LV_ROWS) return LV_ROWS;
+    return (uint8_t)ceilf(x);
+}
+
+void led_viz_step(led_viz_t *v, uint32_t dt_ms)
+{
+    float drop = LV_DECAY_DB_S * (float)dt_ms / 1000.0f;
+
+    for (int c = 0; c < LV_COLS; c++) {
+        uint8_t h = led_viz_height(v, c);
+
+        if (h >= v->peak[c]) {
+            v->peak[c] = h;
+            v->peak_age_ms[c] = 0;
+        } else {
+            uint32_t age = v->peak_age_ms[c] + dt_ms;
+            while (age >= LV_PEAK_HOLD_MS + LV_PEAK_FALL_MS && v->peak[c] > h) {
+                v->peak[c]--;
+                age -= LV_PEAK_FALL_MS;
+            }
+            v->peak_age_ms[c] = (uint16_t)(age > 0xFFFF ? 0xFFFF : age);
+        }
+
+        v->level_db[c] -= drop;
+        if (v->level_db[c] < LV_FLOOR_DB) v->level_db[c] = LV_FLOOR_DB;
+    }
+}
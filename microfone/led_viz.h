@@ -0,0 +1,49 @@
+#ifndef LED_VIZ_H
+#define LED_VIZ_H
+
+#include <stdint.h>
+
+#include "mic_features.h"
+
+// =========================
+// Visualizador de espectro (5 bandas -> 5 colunas da matriz 5x5)
+// =========================
+// Nível de cada banda em dB de fundo de escala: rms² do quadro vezes a
+// fração da banda (features.viz[]), ou seja, Parseval sem depender da escala
+// da FFT (float/Q15/Q31 dão o mesmo resultado).
+//   - barra: sobe na hora e cai a LV_DECAY_DB_S (não pisca entre quadros)
+//   - pico: fica LV_PEAK_HOLD_MS no topo e depois desce uma linha a cada
+//     LV_PEAK_FALL_MS
+// Só lógica (sem hardware): o desenho fica no microphone_dma.c.
+
+#define LV_COLS          MIC_FEAT_N_VIZ
+#define LV_ROWS          5
+
+#ifndef LV_FLOOR_DB
+#define LV_FLOOR_DB      (-54.0f)   // abaixo disso a coluna apaga
+#endif
+#ifndef LV_TOP_DB
+#define LV_TOP_DB        (-14.0f)   // coluna cheia (8 dB por linha)
+#endif
+#define LV_DECAY_DB_S    48.0f
+#define LV_PEAK_HOLD_MS  400
+#define LV_PEAK_FALL_MS  80
+
+typedef struct {
+    float    level_db[LV_COLS];
+    uint8_t  peak[LV_COLS];          // linha do pico (0 = sem pico)
+    uint16_t peak_age_ms[LV_COLS];
+} led_viz_t;
+
+void    led_viz_init(led_viz_t *v);
+
+// entra um quadro novo (só quadros analisados; silêncio do gate não entra)
+void    led_viz_push(led_viz_t *v, const mic_features_t *f);
+
+// avança o tempo (queda das barras e dos picos)
+void    led_viz_step(led_viz_t *v, uint32_t dt_ms);
+
+// altura da barra da coluna (0..LV_ROWS)
+uint8_t led_viz_height(const led_viz_t *v, int col);
+
+#endif
@@ -4,10 +4,35 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "mic_features.h"
+#include "mic_stats.h"
+
 void mic_init(void);
 void mic_process(void);
 
 // últimos valores (para telemetria)
 bool  mic_get_last(float *freq_hz, float *intensity, uint8_t *type);
 
+// features do último quadro (RMS, bandas, centroide, planura, ZCR)
+void  mic_get_features(mic_features_t *out);
+
+// estatísticas acumuladas (ver mic_stats.h): uma por rodada, outra por sessão
+typedef enum {
+    MIC_STATS_ROUND = 0,
+    MIC_STATS_SESSION,
+    MIC_STATS_N_SCOPES
+} mic_stats_scope_t;
+
+// cópia do intervalo; com reset=true zera na mesma trava (nenhum quadro some)
+void  mic_get_stats(mic_stats_scope_t scope, mic_stats_t *out, bool reset);
+void  mic_reset_stats(mic_stats_scope_t scope);
+
+// captura DMA: blocos completos e blocos perdidos (processamento atrasado)
+void  mic_get_dma_stats(uint32_t *blocks, uint32_t *overruns);
+
+// para/religa a captura em volta de algo que trava o core 1 por vários
+// blocos (apagar setor da flash); os blocos perdidos entram nos overruns
+void  mic_capture_pause(void);
+void  mic_capture_resume(void);
+
 #endif
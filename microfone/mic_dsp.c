@@ -0,0 +1,186 @@
+#include <math.h>
+#include <stdint.h>
+
+#include "mic_dsp.h"
+#include "mic_features.h"
+#include "hot_func.h"
+#ifdef MIC_FFT_STATIC_TABLES
+#include "mic_fft_tables.h"
+#endif
+
+// =========================
+// Buffers
+// =========================
+static kiss_fft_scalar fft_input[SAMPLES];   // SRAM principal: o SCRATCH_Y é do core 0
+static kiss_fft_cpx    fft_output[SAMPLES / 2 + 1];   // kiss_fftr gera N/2+1 bins
+
+static kiss_fftr_cfg kiss_cfg = NULL;
+
+// features do quadro, acumuladas nos laços abaixo
+static mic_feat_time_t feat_time;
+static mic_feat_spec_t feat_spec;
+
+#ifdef FIXED_POINT
+// O kiss_fft em ponto fixo escala a saída por 1/N. Com a entrada em Q(FRAC),
+// |bin_fixo| = |bin_float| * 2^FRAC / N.
+#if (FIXED_POINT == 32)
+#define MIC_Q_FRAC   31
+#else
+#define MIC_Q_FRAC   15
+#endif
+#define MIC_ADC_SHIFT (MIC_Q_FRAC - 11)   // ±2048 (12 bits centrado) -> Q
+#define MIC_FIX_SCALE ((float)SAMPLES / (float)(1ULL << MIC_Q_FRAC))
+
+// |X|² inteiro: 32 bits bastam para bins Q15; Q31 precisa de 64
+#if (FIXED_POINT == 32)
+typedef int64_t  mic_prod_t;
+typedef uint64_t mic_mag2_t;
+#define MIC_FEAT_SHIFT 16   // |X|² até ~2^61: desce antes de somar k·|X|²
+#else
+typedef int32_t  mic_prod_t;
+typedef uint32_t mic_mag2_t;
+#define MIC_FEAT_SHIFT 0
+#endif
+
+static uint32_t HOT_FUNC(isqrt64)(uint64_t v) {
+    uint64_t r = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) { v -= r + bit; r = (r >> 1) + bit; }
+        else              { r >>= 1; }
+        bit >>= 2;
+    }
+    return (uint32_t)r;
+}
+#endif
+
+bool mic_dsp_init(void)
+{
+    mic_feat_init();
+    if (kiss_cfg) return true;
+#ifdef MIC_FFT_STATIC_TABLES
+    // tabelas const geradas no build: sem heap e sem trigonometria no boot
+    kiss_cfg = mic_fft_tables_cfg(SAMPLES);
+#else
+    kiss_cfg = kiss_fftr_alloc(SAMPLES, 0, NULL, NULL);
+#endif
+    return kiss_cfg != NULL;
+}
+
+const kiss_fft_cpx* mic_dsp_spectrum(void) {
+    return fft_output;
+}
+
+float mic_dsp_spectrum_scale(void) {
+#ifdef FIXED_POINT
+    return MIC_FIX_SCALE;
+#else
+    return 1.0f;
+#endif
+}
+
+#ifdef FIXED_POINT
+static void HOT_FUNC(apply_fft)(const uint16_t *samples)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < SAMPLES; i++) sum += samples[i];
+    int32_t mean = (sum + SAMPLES / 2) / SAMPLES;
+
+    mic_feat_time_reset(&feat_time);
+    for (int i = 0; i < SAMPLES; i++) {
+        int32_t v = (int32_t)samples[i] - mean;
+        if (v >  2047) v =  2047;
+        if (v < -2048) v = -2048;
+        mic_feat_time_add(&feat_time, v);
+        fft_input[i] = (kiss_fft_scalar)(v * (int32_t)(1UL << MIC_ADC_SHIFT));
+    }
+
+    if (kiss_cfg != NULL) {
+        kiss_fftr(kiss_cfg, fft_input, fft_output);
+    }
+}
+#else
+static void HOT_FUNC(apply_fft)(const uint16_t *samples)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < SAMPLES; i++) sum += samples[i];
+    float   mean   = (float)sum / (float)SAMPLES;
+    int32_t mean_i = (sum + SAMPLES / 2) / SAMPLES;
+
+    mic_feat_time_reset(&feat_time);
+    for (int i = 0; i < SAMPLES; i++) {
+        float v = ((float)samples[i] - mean);
+        fft_input[i] = v / 2048.0f;
+        mic_feat_time_add(&feat_time, (int32_t)samples[i] - mean_i);
+    }
+
+    if (kiss_cfg != NULL) {
+        kiss_fftr(kiss_cfg, fft_input, fft_output);
+    }
+}
+#endif
+
+void HOT_FUNC(mic_dsp_analyze)(const uint16_t *samples, mic_dsp_result_t *out)
+{
+    apply_fft(samples);
+
+    int max_index = 1;
+
+#ifdef FIXED_POINT
+    mic_mag2_t max_mag2 = 0;
+
+    mic_feat_spec_reset(&feat_spec);
+    for (int i = 1; i < SAMPLES / 2; i++) {
+        mic_prod_t r  = fft_output[i].r;
+        mic_prod_t im = fft_output[i].i;
+        mic_mag2_t mag2 = (mic_mag2_t)(r * r) + (mic_mag2_t)(im * im);
+        mic_feat_spec_add(&feat_spec, i, (mic_feat_pow_t)(mag2 >> MIC_FEAT_SHIFT));
+        if (mag2 > max_mag2) {
+            max_mag2 = mag2;
+            max_index = i;
+        }
+    }
+
+    float max_magnitude = (float)isqrt64(max_mag2) * MIC_FIX_SCALE;
+#else
+    float max_mag2 = 0.0f;
+
+    mic_feat_spec_reset(&feat_spec);
+    for (int i = 1; i < SAMPLES / 2; i++) {
+        float r = fft_output[i].r;
+        float im = fft_output[i].i;
+        float mag2 = (r * r) + (im * im);
+        mic_feat_spec_add(&feat_spec, i, mag2);
+        if (mag2 > max_mag2) {
+            max_mag2 = mag2;
+            max_index = i;
+        }
+    }
+
+    float max_magnitude = sqrtf(max_mag2);
+#endif
+
+    mic_feat_finish(&feat_time, &feat_spec, &out->feat);
+
+    out->freq_hz    = (max_index * SAMPLE_RATE) / (float)SAMPLES;
+    out->intensity  = max_magnitude;
+    out->sound_type = mic_dsp_detect_sound_type(out->freq_hz, out->intensity);
+}
+
+uint8_t mic_dsp_detect_sound_type(float freq, float intensity)
+{
+    if (intensity < NOISE_THRESHOLD)
+        return 0;
+
+    if (freq > IGNORE_FREQ_MIN && freq < IGNORE_FREQ_MAX)
+        return 0;
+
+    if (freq < 200.0f)
+        return 1;
+
+    if (freq < 600.0f)
+        return 2;
+
+    return 3;
+}
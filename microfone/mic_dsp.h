@@ -0,0 +1,63 @@
+#ifndef MIC_DSP_H
+#define MIC_DSP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kiss_fftr.h"
+
+// =========================
+// Análise espectral do microfone
+// =========================
+// Sem dependência do SDK da Pico: o firmware (microphone_dma.c) e os
+// benchmarks no PC (bench/) usam exatamente o mesmo caminho.
+//
+// Compilado com FIXED_POINT=16/32 (opção MIC_FFT_FIXED_POINT no CMake),
+// o kiss_fft roda em inteiros: as amostras do ADC entram como Q15/Q31 e a
+// busca do pico usa |X|² inteiro. A intensidade devolvida continua na mesma
+// escala do caminho float (entrada normalizada por 2048).
+
+// Tamanho do quadro/FFT (opção MIC_FFT_SIZE no CMake). Com
+// MIC_FFT_STATIC_TABLES a cfg do kiss_fftr vem de tabelas const geradas no
+// build para esse tamanho (mic_fft_tables.h); sem ela, kiss_fftr_alloc.
+#ifndef MIC_FFT_SIZE
+#define MIC_FFT_SIZE     256
+#endif
+
+// Decimação antes da análise (opção MIC_DECIM no CMake, decim.h): o ADC
+// fica em MIC_ADC_RATE e o analisador vê SAMPLE_RATE = MIC_ADC_RATE/MIC_DECIM,
+// com bins MIC_DECIM vezes mais finos. Cada quadro junta MIC_DECIM blocos.
+#ifndef MIC_DECIM
+#define MIC_DECIM        1
+#endif
+
+#define SAMPLES          MIC_FFT_SIZE
+#define MIC_ADC_RATE     20000
+#define SAMPLE_RATE      (MIC_ADC_RATE / MIC_DECIM)
+
+#include "mic_features.h"
+
+#define NOISE_THRESHOLD  0.9f
+#define IGNORE_FREQ_MIN  380.0f
+#define IGNORE_FREQ_MAX  400.0f
+
+typedef struct {
+    float   freq_hz;     // bin dominante
+    float   intensity;   // |X| do bin dominante
+    uint8_t sound_type;  // 0 silêncio/ignorado, 1 grave, 2 médio, 3 agudo
+    mic_features_t feat; // RMS, bandas, centroide, planura, ZCR (mic_features.h)
+} mic_dsp_result_t;
+
+bool    mic_dsp_init(void);
+
+// samples: SAMPLES leituras brutas do ADC (12 bits)
+void    mic_dsp_analyze(const uint16_t *samples, mic_dsp_result_t *out);
+
+uint8_t mic_dsp_detect_sound_type(float freq, float intensity);
+
+// Espectro do último quadro (SAMPLES/2 + 1 bins) e fator que converte |bin|
+// para a escala do caminho float (usado pelos benchmarks)
+const kiss_fft_cpx* mic_dsp_spectrum(void);
+float   mic_dsp_spectrum_scale(void);
+
+#endif
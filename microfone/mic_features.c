@@ -0,0 +1,61 @@
+#include <math.h>
+#include <string.h>
+
+#include "mic_dsp.h"
+#include "mic_features.h"
+
+// primeiro bin de cada banda acima da grave: 200 Hz, 600 Hz, 2 kHz
+#define FEAT_BIN(hz) ((uint16_t)(((hz) * SAMPLES + SAMPLE_RATE - 1) / SAMPLE_RATE))
+
+const uint16_t mic_feat_band_bin[MIC_FEAT_N_BANDS - 1] = {
+    FEAT_BIN(200), FEAT_BIN(600), FEAT_BIN(2000)
+};
+
+uint16_t mic_feat_viz_bin[MIC_FEAT_N_VIZ - 1];
+
+void mic_feat_init(void)
+{
+    // fronteiras em progressão geométrica de VIZ_LO_HZ até a Nyquist
+    float ratio = ((float)SAMPLE_RATE / 2.0f) / (float)MIC_FEAT_VIZ_LO_HZ;
+    for (int v = 0; v < MIC_FEAT_N_VIZ - 1; v++) {
+        float hz = (float)MIC_FEAT_VIZ_LO_HZ * powf(ratio, (float)(v + 1) / MIC_FEAT_N_VIZ);
+        mic_feat_viz_bin[v] = (uint16_t)ceilf(hz * SAMPLES / SAMPLE_RATE);
+    }
+}
+
+void mic_feat_spec_reset(mic_feat_spec_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+void mic_feat_finish(const mic_feat_time_t *t, const mic_feat_spec_t *s, mic_features_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    // RMS sem o DC que ainda tenha sobrado: var = E[v²] - E[v]²
+    if (t->n > 0) {
+        int64_t n = t->n;
+        int64_t var_n2 = t->sum2 * n - (int64_t)t->sum * t->sum;   // var * n²
+        if (var_n2 < 0) var_n2 = 0;
+        out->rms = sqrtf((float)var_n2) / ((float)n * 2048.0f);
+        if (t->n > 1) out->zcr = (float)t->zc / (float)(t->n - 1);
+    }
+
+    if (s->n == 0 || s->total == 0) return;
+
+    float total = (float)s->total;
+    for (int b = 0; b < MIC_FEAT_N_BANDS; b++) {
+        out->band[b] = (float)s->band[b] / total;
+    }
+    for (int v = 0; v < MIC_FEAT_N_VIZ; v++) {
+        out->viz[v] = (float)s->viz[v] / total;
+    }
+
+    out->centroid_hz = ((float)s->weighted / total) * ((float)SAMPLE_RATE / (float)SAMPLES);
+
+    // planura = média geométrica / média aritmética, em log2 (Q8)
+    int32_t log_geo  = s->log2_sum_q8 / s->n;
+    int32_t log_arit = mic_feat_log2_q8(s->total / s->n);
+    float flat = exp2f((float)(log_geo - log_arit) / 256.0f);
+    out->flatness = (flat > 1.0f) ? 1.0f : flat;
+}
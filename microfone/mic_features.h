@@ -0,0 +1,119 @@
+#ifndef MIC_FEATURES_H
+#define MIC_FEATURES_H
+
+#include <stdint.h>
+
+// =========================
+// Features do quadro do microfone
+// =========================
+// Em vez de só (bin dominante, pico), cada quadro gera um resumo compacto:
+//   - rms:         RMS no tempo (mesma escala da intensidade: ADC/2048)
+//   - band[]:      fração da energia espectral em cada banda (soma = 1)
+//   - centroid_hz: centroide espectral (onde está o "peso" do som)
+//   - flatness:    planura espectral, 0 = tonal (apito) .. 1 = ruído
+//   - zcr:         cruzamentos por zero por amostra (0..1)
+//
+// Não há passe extra sobre os dados: os acumuladores abaixo são chamados
+// dentro dos laços que o mic_dsp.c já faz (centralização das amostras e
+// busca do pico), e mic_feat_finish() fecha o quadro.
+//
+//   - viz[]:       fração da energia em 5 bandas logarítmicas (visualizador
+//                  de espectro do Neopixel, uma coluna por banda)
+//
+// Bandas: as mesmas fronteiras do sound_type (200 e 600 Hz) + 2 kHz.
+// Bandas do visualizador: 100 Hz .. Nyquist em passos geométricos iguais
+// (a 20 kHz: 251, 631, 1585, 3981 Hz), então acompanham o MIC_DECIM.
+
+#define MIC_FEAT_N_BANDS  4   // grave <200, médio <600, agudo <2k, alto >=2k
+#define MIC_FEAT_N_VIZ    5   // colunas do visualizador
+#define MIC_FEAT_VIZ_LO_HZ 100
+
+typedef struct {
+    float rms;
+    float band[MIC_FEAT_N_BANDS];
+    float viz[MIC_FEAT_N_VIZ];
+    float centroid_hz;
+    float flatness;
+    float zcr;
+} mic_features_t;
+
+// --------- acumulador no tempo (amostras centradas, unidade do ADC) ---------
+typedef struct {
+    int64_t  sum2;
+    int32_t  sum;
+    uint16_t n;
+    uint16_t zc;
+    int8_t   prev_neg;
+} mic_feat_time_t;
+
+static inline void mic_feat_time_reset(mic_feat_time_t *t) {
+    t->sum2 = 0; t->sum = 0; t->n = 0; t->zc = 0; t->prev_neg = -1;
+}
+
+static inline void mic_feat_time_add(mic_feat_time_t *t, int32_t v) {
+    int8_t neg = (v < 0);
+    if (t->prev_neg >= 0 && neg != t->prev_neg) t->zc++;
+    t->prev_neg = neg;
+    t->sum  += v;
+    t->sum2 += (int64_t)(v * v);   // |v| <= 4095: produto de 32 bits (sem __aeabi_lmul no M0+)
+    t->n++;
+}
+
+// --------- acumulador espectral (|X[k]|², escala qualquer) ---------
+// Só razões entram nas features, então a escala de |X|² não importa.
+// O caminho inteiro (FIXED_POINT) acumula em 64 bits; o float
+// acumula em float. log2 aproximado (expoente + mantissa linear, Q8) para a
+// planura, sem logf por bin.
+#ifdef FIXED_POINT
+typedef uint64_t mic_feat_pow_t;
+
+static inline int32_t mic_feat_log2_q8(mic_feat_pow_t p) {
+    if (p == 0) p = 1;
+    int e = 63 - __builtin_clzll(p);
+    uint32_t frac = (uint32_t)((e >= 8) ? (p >> (e - 8)) : (p << (8 - e))) & 0xFF;
+    return e * 256 + (int32_t)frac;
+}
+#else
+typedef float mic_feat_pow_t;
+
+static inline int32_t mic_feat_log2_q8(mic_feat_pow_t p) {
+    union { float f; uint32_t u; } v = { p };
+    return (int32_t)(v.u >> 15) - 127 * 256;   // p >= 0
+}
+#endif
+
+typedef struct {
+    mic_feat_pow_t total;
+    mic_feat_pow_t band[MIC_FEAT_N_BANDS];
+    mic_feat_pow_t viz[MIC_FEAT_N_VIZ];
+    mic_feat_pow_t weighted;    // Σ k·|X[k]|²
+    int32_t        log2_sum_q8; // Σ log2|X[k]|²
+    uint16_t       n;
+} mic_feat_spec_t;
+
+// calcula as fronteiras do visualizador (chamado pelo mic_dsp_init)
+void mic_feat_init(void);
+
+void mic_feat_spec_reset(mic_feat_spec_t *s);
+
+// bins que separam as bandas (primeiro bin de cada banda >= 1)
+extern const uint16_t mic_feat_band_bin[MIC_FEAT_N_BANDS - 1];
+extern uint16_t       mic_feat_viz_bin[MIC_FEAT_N_VIZ - 1];
+
+static inline void mic_feat_spec_add(mic_feat_spec_t *s, int k, mic_feat_pow_t p) {
+    int b = 0;
+    while (b < MIC_FEAT_N_BANDS - 1 && k >= mic_feat_band_bin[b]) b++;
+    s->band[b]     += p;
+    int v = 0;
+    while (v < MIC_FEAT_N_VIZ - 1 && k >= mic_feat_viz_bin[v]) v++;
+    s->viz[v]      += p;
+    s->total       += p;
+    s->weighted    += p * (mic_feat_pow_t)k;
+    s->log2_sum_q8 += mic_feat_log2_q8(p);
+    s->n++;
+}
+
+// Fecha o quadro (uma sqrt e um exp2 por quadro)
+void mic_feat_finish(const mic_feat_time_t *t, const mic_feat_spec_t *s, mic_features_t *out);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef MIC_FFT_TABLES_H
+#define MIC_FFT_TABLES_H
+
+#include "kiss_fftr.h"
+
+// =========================
+// Configuração do kiss_fftr gerada no build
+// =========================
+// mic_fft_tables.c é gerado por gen_fft_tables.py (CMake, MIC_FFT_SIZE):
+// twiddles, super-twiddles e fatores ficam em dados const (flash), sem
+// malloc e sem cos/sin no boot. Só a área de trabalho (nfft/2 complexos)
+// fica em RAM, então a cfg não pode ser usada por duas tarefas ao mesmo
+// tempo.
+//
+// Retorna NULL se nfft não for o tamanho gerado.
+kiss_fftr_cfg mic_fft_tables_cfg(int nfft);
+
+#endif
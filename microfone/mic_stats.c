@@ -0,0 +1,35 @@
+#include <string.h>
+
+#include "mic_stats.h"
+
+void mic_stats_reset(mic_stats_t *s)
+{
+    memset(s, 0, sizeof(*s));
+}
+
+void mic_stats_add(mic_stats_t *s, float freq_hz, float intensity,
+                   uint8_t sound_type, const mic_features_t *feat)
+{
+    if (sound_type >= MIC_STATS_N_TYPES) sound_type = 0;
+
+    s->frames++;
+    s->type_hist[sound_type]++;
+
+    mic_welford_add(&s->intensity, intensity);
+    mic_welford_add(&s->rms, feat->rms);
+
+    if (sound_type != 0) {
+        mic_welford_add(&s->freq, freq_hz);
+        mic_welford_add(&s->centroid, feat->centroid_hz);
+        mic_welford_add(&s->flatness, feat->flatness);
+    }
+}
+
+uint8_t mic_stats_top_type(const mic_stats_t *s)
+{
+    uint8_t best = 0;
+    for (uint8_t t = 1; t < MIC_STATS_N_TYPES; t++) {
+        if (s->type_hist[t] > (best ? s->type_hist[best] : 0u)) best = t;
+    }
+    return best;
+}
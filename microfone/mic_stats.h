@@ -0,0 +1,69 @@
+#ifndef MIC_STATS_H
+#define MIC_STATS_H
+
+#include <stdint.h>
+
+#include "mic_features.h"
+
+// =========================
+// Estatísticas do microfone por intervalo (rodada / sessão)
+// =========================
+// Em vez de um quadro solto no momento do evento, cada intervalo acumula
+// todos os quadros analisados, em memória constante:
+//   - frames e histograma do sound_type (0 = nada, 1 grave, 2 médio, 3 agudo)
+//   - contagem, média, mín, máx e variância (Welford, uma passada, estável
+//     em float) de freq dominante, intensidade, rms, centroide e planura
+//
+// Freq dominante, centroide e planura só contam nos quadros com som
+// (sound_type != 0); intensidade e rms contam em todos, inclusive os de
+// silêncio do gate (que não têm espectro).
+
+#define MIC_STATS_N_TYPES  4
+
+typedef struct {
+    uint32_t n;
+    float    mean;
+    float    m2;     // Σ (x - média)²
+    float    min;
+    float    max;
+} mic_welford_t;
+
+static inline void mic_welford_reset(mic_welford_t *w) {
+    w->n = 0; w->mean = 0.0f; w->m2 = 0.0f; w->min = 0.0f; w->max = 0.0f;
+}
+
+static inline void mic_welford_add(mic_welford_t *w, float x) {
+    w->n++;
+    if (w->n == 1) { w->min = x; w->max = x; }
+    else if (x < w->min) w->min = x;
+    else if (x > w->max) w->max = x;
+
+    float d = x - w->mean;
+    w->mean += d / (float)w->n;
+    w->m2   += d * (x - w->mean);
+}
+
+// variância amostral (0 com menos de 2 valores)
+static inline float mic_welford_var(const mic_welford_t *w) {
+    return (w->n > 1) ? w->m2 / (float)(w->n - 1) : 0.0f;
+}
+
+typedef struct {
+    uint32_t      frames;
+    uint32_t      type_hist[MIC_STATS_N_TYPES];
+    mic_welford_t freq;        // só quadros com som
+    mic_welford_t intensity;
+    mic_welford_t rms;
+    mic_welford_t centroid;    // só quadros com som
+    mic_welford_t flatness;    // só quadros com som
+} mic_stats_t;
+
+void    mic_stats_reset(mic_stats_t *s);
+
+void    mic_stats_add(mic_stats_t *s, float freq_hz, float intensity,
+                      uint8_t sound_type, const mic_features_t *feat);
+
+// tipo mais frequente entre os quadros com som (0 se não houve som)
+uint8_t mic_stats_top_type(const mic_stats_t *s);
+
+#endif
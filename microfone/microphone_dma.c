@@ -1,32 +1,54 @@
 #include <stdio.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
 
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
 #include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "pico/sync.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
 
-#include "kiss_fftr.h"
 #include "neopixel.h"
 
 #include "mic.h"
+#include "mic_dsp.h"
+#include "mic_stats.h"
+#include "led_viz.h"
+#include "hot_func.h"
+
+#if MIC_PREFILTER
+#include "biquad.h"
+#include "mic_biquad_coefs.h"   // gerado no build (gen_biquad.py)
+
+_Static_assert(MIC_BIQUAD_FS == MIC_ADC_RATE, "coeficientes do pré-filtro para outra taxa de amostragem");
+#endif
+
+#if MIC_VAD
+#include "noise_gate.h"
+#endif
+
+#if MIC_DECIM > 1
+#include "decim.h"
+
+_Static_assert(SAMPLES % MIC_DECIM == 0, "bloco do DMA precisa ser múltiplo de MIC_DECIM");
+#endif
 
 // =========================
 // Configuração do Microfone
 // =========================
 #define MIC_CHANNEL      2      // ADC2 -> GPIO 28
 #define MIC_PIN          28
-#define ADC_CLOCK_DIV    48.f   // ~20kHz
-#define SAMPLES          256
-#define SAMPLE_RATE      20000
-
-#define NOISE_THRESHOLD  0.9f
-#define IGNORE_FREQ_MIN  380.0f
-#define IGNORE_FREQ_MAX  400.0f
+#define ADC_CLOCK_DIV    48.f   // ~20kHz (MIC_ADC_RATE em mic_dsp.h)
 
 #define DMA_TIMEOUT_MS   50
+#define MIC_DMA_IRQ      DMA_IRQ_1   // DMA_IRQ_0 fica livre p/ o driver cyw43
 
 // =========================
 // LEDs Neopixel
@@ -36,36 +58,199 @@
 #define MATRIX_WIDTH     5
 #define MATRIX_HEIGHT    5
 
+// visualizador: sem quadro novo (decimação, gate fechado) ainda redesenha
+// a cada VIZ_FRAME_MS para a queda das barras/picos ficar contínua
+#define VIZ_FRAME_MS     25   // 40 fps mínimo
+#ifndef MIC_LED_VIZ
+#define MIC_LED_VIZ      0    // 1 = espectro, 0 = linhas por sound_type (CMake)
+#endif
+
 // =========================
 // Globais
 // =========================
-static uint dma_channel;
-static dma_channel_config dma_cfg;
-
-static uint16_t adc_buffer[SAMPLES];
-static float    fft_input[SAMPLES];
-static kiss_fft_cpx fft_output[SAMPLES / 2];
-
-static kiss_fftr_cfg kiss_cfg = NULL;
-
-// últimos valores (para telemetria)
-static volatile float   g_last_freq = 0.0f;
-static volatile float   g_last_int  = 0.0f;
-static volatile uint8_t g_last_type = 0;
+// Captura contínua em ping-pong: dois canais DMA encadeados (A -> B -> A ...),
+// cada um escrevendo no seu buffer. O ADC roda livre; ao completar um bloco
+// a IRQ rearma o canal e acorda a MicTask com uma notificação.
+static uint dma_chan[2];
+
+#if SAMPLES <= 256
+static uint16_t SCRATCH_X_DATA("mic_adc") adc_buffer[2][SAMPLES];   // banco do core 1 (hot_func.h)
+#else
+static uint16_t adc_buffer[2][SAMPLES];
+#endif
+static volatile uint8_t  g_ready_idx = 0;
+static volatile uint32_t g_ready_us = 0;    // fim do bloco (amostra mais nova)
+static volatile uint32_t g_blocks_done = 0;
+static uint32_t g_blocks_seen = 0;
+static uint32_t g_overruns = 0;
+static bool              g_dma_ativo = false;
+static uint32_t          g_pausa_us = 0;
+static volatile uint32_t g_pausa_perdidos = 0;   // blocos que não vieram (mic_capture_pause)
+
+static TaskHandle_t g_mic_task_handle = NULL;
+
+#if MIC_PREFILTER
+// passa-altas + notch(es) em streaming sobre os blocos do DMA, antes da FFT
+static biquad_cascade_t g_prefilter;
+static uint16_t filt_buffer[SAMPLES];
+#endif
+
+#if MIC_DECIM > 1
+// cada bloco do DMA rende SAMPLES/MIC_DECIM amostras; o quadro de análise
+// fica pronto a cada MIC_DECIM blocos
+static decim_cic_t g_decim;
+static uint16_t frame_buffer[SAMPLES];
+static int frame_fill = 0;
+#endif
+
+#if MIC_VAD
+// piso de ruído adaptativo: quadros de silêncio não passam pela FFT
+static noise_gate_t g_gate;
+#endif
+static bool g_leds_lit = false;
+
+static led_viz_t g_viz;
+static uint32_t  g_viz_last_us = 0;
+// latência áudio -> LED (fim do bloco no DMA até o npWrite terminar)
+static uint32_t  g_viz_frames = 0, g_viz_lat_sum = 0, g_viz_lat_max = 0, g_viz_lat_n = 0;
+
+// últimos valores (para telemetria): caixa de correio de 1 posição.
+// A MicTask (core 1) sobrescreve o quadro inteiro com xQueueOverwrite e os
+// leitores no core 0 (MQTT/UDP) só espiam com xQueuePeek: freq/tipo/features
+// saem sempre do mesmo quadro, sem seção crítica segurando os dois cores.
+static QueueHandle_t g_last_box = NULL;
+static StaticQueue_t g_last_box_buf;
+static uint8_t       g_last_box_item[sizeof(mic_dsp_result_t)];
+
+// estatísticas por rodada/sessão: a MicTask soma cada quadro e o core 0
+// tira cópia/zera. Trava própria (spinlock do SDK), curta e sem pegar a
+// trava do kernel como o taskENTER_CRITICAL.
+static mic_stats_t        g_stats[MIC_STATS_N_SCOPES];
+static critical_section_t g_stats_cs;
 
 // protótipos internos
-static bool sample_mic(void);
-static void apply_fft(void);
-static uint8_t detect_sound_type(float freq, float intensity);
+static const uint16_t* sample_mic(void);
 static void update_leds(uint8_t sound_type);
+static void viz_service(const mic_features_t *feat, uint32_t block_us);
+
+static void mic_peek_last(mic_dsp_result_t *r) {
+    if (!g_last_box || xQueuePeek(g_last_box, r, 0) != pdTRUE) memset(r, 0, sizeof(*r));
+}
 
 bool mic_get_last(float *freq_hz, float *intensity, uint8_t *type) {
-    if (freq_hz)   *freq_hz   = g_last_freq;
-    if (intensity) *intensity = g_last_int;
-    if (type)      *type      = g_last_type;
+    mic_dsp_result_t r;
+    mic_peek_last(&r);
+    if (freq_hz)   *freq_hz   = r.freq_hz;
+    if (intensity) *intensity = r.intensity;
+    if (type)      *type      = r.sound_type;
     return true;
 }
 
+void mic_get_features(mic_features_t *out) {
+    if (!out) return;
+    mic_dsp_result_t r;
+    mic_peek_last(&r);
+    *out = r.feat;
+}
+
+void mic_get_stats(mic_stats_scope_t scope, mic_stats_t *out, bool reset) {
+    if (!out || scope >= MIC_STATS_N_SCOPES) return;
+    if (!critical_section_is_initialized(&g_stats_cs)) { mic_stats_reset(out); return; }
+    critical_section_enter_blocking(&g_stats_cs);
+    *out = g_stats[scope];
+    if (reset) mic_stats_reset(&g_stats[scope]);
+    critical_section_exit(&g_stats_cs);
+}
+
+void mic_reset_stats(mic_stats_scope_t scope) {
+    if (scope >= MIC_STATS_N_SCOPES || !critical_section_is_initialized(&g_stats_cs)) return;
+    critical_section_enter_blocking(&g_stats_cs);
+    mic_stats_reset(&g_stats[scope]);
+    critical_section_exit(&g_stats_cs);
+}
+
+void mic_get_dma_stats(uint32_t *blocks, uint32_t *overruns) {
+    if (blocks)   *blocks   = g_blocks_done;
+    if (overruns) *overruns = g_overruns + g_pausa_perdidos;
+}
+
+// Parada do outro núcleo (apagar setor da flash, ~45 ms = 3+ blocos): sem a
+// IRQ ninguém rearma o endereço, e a cadeia A -> B -> A seguiria escrevendo
+// depois do fim de adc_buffer. Para o ADC e os dois canais antes, e na volta
+// conta os blocos que não vieram como overruns.
+void mic_capture_pause(void) {
+    if (!g_dma_ativo) return;
+    adc_run(false);
+    for (int i = 0; i < 2; i++) {
+        dma_irqn_set_channel_enabled(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i], false);
+        dma_channel_abort(dma_chan[i]);
+    }
+    g_pausa_us = time_us_32();
+}
+
+void mic_capture_resume(void) {
+    if (!g_dma_ativo) return;
+    uint32_t dt = time_us_32() - g_pausa_us;
+    // o bloco que estava enchendo, mais os que caberiam na parada
+    g_pausa_perdidos += (uint32_t)((uint64_t)dt * MIC_ADC_RATE / ((uint64_t)SAMPLES * 1000000u)) + 1;
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_set_write_addr(dma_chan[i], adc_buffer[i], false);
+        dma_channel_set_trans_count(dma_chan[i], SAMPLES, false);
+        dma_irqn_acknowledge_channel(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i]);
+        dma_irqn_set_channel_enabled(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i], true);
+    }
+    adc_fifo_drain();
+    dma_channel_start(dma_chan[0]);
+    adc_run(true);
+}
+
+static void HOT_FUNC(mic_dma_irq_handler)(void)
+{
+    BaseType_t woken = pdFALSE;
+
+    for (int i = 0; i < 2; i++) {
+        if (!dma_irqn_get_channel_status(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i])) continue;
+        dma_irqn_acknowledge_channel(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i]);
+
+        // rearma o canal que terminou (o outro já está escrevendo via chain)
+        dma_channel_set_write_addr(dma_chan[i], adc_buffer[i], false);
+
+        g_ready_idx = (uint8_t)i;
+        g_ready_us = time_us_32();
+        g_blocks_done++;
+
+        if (g_mic_task_handle) vTaskNotifyGiveFromISR(g_mic_task_handle, &woken);
+    }
+
+    portYIELD_FROM_ISR(woken);
+}
+
+static void mic_dma_start(void)
+{
+    for (int i = 0; i < 2; i++) dma_chan[i] = dma_claim_unused_channel(true);
+
+    for (int i = 0; i < 2; i++) {
+        dma_channel_config c = dma_channel_get_default_config(dma_chan[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+        channel_config_set_read_increment(&c, false);
+        channel_config_set_write_increment(&c, true);
+        channel_config_set_dreq(&c, DREQ_ADC);
+        channel_config_set_chain_to(&c, dma_chan[i ^ 1]);
+
+        dma_channel_configure(dma_chan[i], &c, adc_buffer[i], &adc_hw->fifo, SAMPLES, false);
+        dma_irqn_set_channel_enabled(MIC_DMA_IRQ - DMA_IRQ_0, dma_chan[i], true);
+    }
+
+    irq_add_shared_handler(MIC_DMA_IRQ, mic_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(MIC_DMA_IRQ, true);
+
+    adc_fifo_drain();
+    dma_channel_start(dma_chan[0]);
+    adc_run(true);
+    g_dma_ativo = true;
+}
+
 void mic_init(void)
 {
     sleep_ms(500);
@@ -88,21 +273,46 @@ void mic_init(void)
 
     adc_set_clkdiv(ADC_CLOCK_DIV);
 
-    dma_channel = dma_claim_unused_channel(true);
-    dma_cfg = dma_channel_get_default_config(dma_channel);
-    channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_16);
-    channel_config_set_read_increment(&dma_cfg, false);
-    channel_config_set_write_increment(&dma_cfg, true);
-    channel_config_set_dreq(&dma_cfg, DREQ_ADC);
+    if (!mic_dsp_init()) {
+        printf("mic_init: ERRO alocando FFT\n");
+    }
+
+#if MIC_PREFILTER
+    biquad_cascade_init(&g_prefilter, mic_biquad_coefs, MIC_BIQUAD_N_STAGES);
+    printf("mic_init: pré-filtro: %s\n", MIC_BIQUAD_DESC);
+#endif
+
+#if MIC_VAD
+    noise_gate_init(&g_gate);
+#endif
 
-    kiss_cfg = kiss_fftr_alloc(SAMPLES, 0, NULL, NULL);
+    led_viz_init(&g_viz);
+    g_viz_last_us = time_us_32();
+
+#if MIC_DECIM > 1
+    decim_cic_init(&g_decim, MIC_DECIM);
+    printf("mic_init: decimação CIC /%d (análise a %d Hz, bin %.1f Hz)\n",
+           MIC_DECIM, SAMPLE_RATE, (float)SAMPLE_RATE / SAMPLES);
+#endif
+
+    for (int i = 0; i < MIC_STATS_N_SCOPES; i++) mic_stats_reset(&g_stats[i]);
+    critical_section_init(&g_stats_cs);
+
+    g_last_box = xQueueCreateStatic(1, sizeof(mic_dsp_result_t), g_last_box_item, &g_last_box_buf);
+
+    // mic_init roda dentro da MicTask (fixa no core 1): é ela que a IRQ vai
+    // acordar, e o irq_set_enabled abaixo prende a IRQ do DMA no mesmo core
+    g_mic_task_handle = xTaskGetCurrentTaskHandle();
+    mic_dma_start();
 
     printf("mic_init: ADC/DMA/FFT/LEDs inicializados.\n");
 }
 
 void mic_process(void)
 {
-    if (!sample_mic()) {
+    const uint16_t *samples = sample_mic();
+    uint32_t block_us = g_ready_us;
+    if (!samples) {
         npClear();
         npWrite();
 
@@ -115,105 +325,120 @@ void mic_process(void)
         return;
     }
 
-    apply_fft();
-
-    int max_index = 1;
-    float max_mag2 = 0.0f;
-
-    for (int i = 1; i < SAMPLES / 2; i++) {
-        float r = fft_output[i].r;
-        float im = fft_output[i].i;
-        float mag2 = (r * r) + (im * im);
-        if (mag2 > max_mag2) {
-            max_mag2 = mag2;
-            max_index = i;
-        }
+    // pré-processamento por bloco do DMA (pré-filtro + decimação)
+    static uint32_t filt_max_us = 0;
+    uint32_t filt_us = 0;
+#if MIC_PREFILTER
+    uint32_t tf_us = time_us_32();
+    biquad_cascade_process_adc(&g_prefilter, samples, filt_buffer, SAMPLES);
+    samples = filt_buffer;
+    filt_us = time_us_32() - tf_us;
+#endif
+
+#if MIC_DECIM <= 1
+    if (filt_us > filt_max_us) filt_max_us = filt_us;
+#else
+    uint32_t td_us = time_us_32();
+    frame_fill += decim_cic_process_adc(&g_decim, samples, SAMPLES, frame_buffer + frame_fill);
+    filt_us += time_us_32() - td_us;
+    if (filt_us > filt_max_us) filt_max_us = filt_us;
+    if (frame_fill < SAMPLES) {   // quadro ainda incompleto (LEDs mantêm o último)
+        if (MIC_LED_VIZ) viz_service(NULL, 0);
+        return;
+    }
+    frame_fill = 0;
+    samples = frame_buffer;
+#endif
+
+    bool ativo = true;
+#if MIC_VAD
+    ativo = noise_gate_update(&g_gate, noise_gate_frame_energy(samples, SAMPLES));
+#endif
+
+    mic_dsp_result_t res;
+    static uint32_t dsp_sum_us = 0, dsp_max_us = 0, dsp_n = 0, frames_n = 0;
+    frames_n++;
+
+    if (ativo) {
+        uint32_t t0_us = time_us_32();
+        mic_dsp_analyze(samples, &res);
+        uint32_t dsp_us = time_us_32() - t0_us;
+
+        // custo do DSP por quadro (compara float x MIC_FFT_FIXED_POINT no alvo)
+        dsp_sum_us += dsp_us;
+        dsp_n++;
+        if (dsp_us > dsp_max_us) dsp_max_us = dsp_us;
+    } else {
+        // silêncio pelo gate: sem FFT/classificação, só o nível sai na telemetria
+        memset(&res, 0, sizeof(res));
+#if MIC_VAD
+        res.feat.rms = sqrtf((float)g_gate.energy) / 2048.0f;
+#endif
     }
 
-    float dominant_freq = (max_index * SAMPLE_RATE) / (float)SAMPLES;
-    float max_magnitude = sqrtf(max_mag2);
-    uint8_t sound_type = detect_sound_type(dominant_freq, max_magnitude);
+    float dominant_freq = res.freq_hz;
+    float max_magnitude = res.intensity;
+    uint8_t sound_type  = res.sound_type;
 
-    // salva para telemetria
-    g_last_freq = dominant_freq;
-    g_last_int  = max_magnitude;
-    g_last_type = sound_type;
+    // publica para telemetria (core 0)
+    if (g_last_box) xQueueOverwrite(g_last_box, &res);
+
+    critical_section_enter_blocking(&g_stats_cs);
+    for (int i = 0; i < MIC_STATS_N_SCOPES; i++) {
+        mic_stats_add(&g_stats[i], dominant_freq, max_magnitude, sound_type, &res.feat);
+    }
+    critical_section_exit(&g_stats_cs);
 
     // log controlado
     static uint32_t last_log_ms = 0;
     uint32_t now_ms = to_ms_since_boot(get_absolute_time());
     if (now_ms - last_log_ms >= 2000) {
         last_log_ms = now_ms;
-        printf("Freq: %.1f Hz | Int: %.3f | tipo=%u\n",
-               dominant_freq, max_magnitude, sound_type);
-    }
-
-    update_leds(sound_type);
-}
-
-static bool sample_mic(void)
-{
-    adc_fifo_drain();
-    adc_run(false);
-
-    dma_channel_configure(
-        dma_channel,
-        &dma_cfg,
-        adc_buffer,
-        &adc_hw->fifo,
-        SAMPLES,
-        true
-    );
-
-    adc_run(true);
-
-    absolute_time_t t0 = get_absolute_time();
-
-    while (dma_channel_is_busy(dma_channel)) {
-        if (absolute_time_diff_us(t0, get_absolute_time()) > (int64_t)DMA_TIMEOUT_MS * 1000) {
-            dma_channel_abort(dma_channel);
-            adc_run(false);
-            adc_fifo_drain();
-            return false;
+        printf("Freq: %.1f Hz | Int: %.3f | tipo=%u | rms=%.3f cent=%.0f Hz flat=%.2f zcr=%.2f | dsp=%u us (max %u, %u/%u quadros) filt=%u us (max %u)\n",
+               dominant_freq, max_magnitude, sound_type,
+               res.feat.rms, res.feat.centroid_hz, res.feat.flatness, res.feat.zcr,
+               (unsigned)(dsp_n ? dsp_sum_us / dsp_n : 0), (unsigned)dsp_max_us,
+               (unsigned)dsp_n, (unsigned)frames_n,
+               (unsigned)filt_us, (unsigned)filt_max_us);
+#if MIC_VAD
+        printf("[MIC] gate=%s piso=%.1f LSB rms (abre > %.1f) nivel=%.1f LSB\n",
+               g_gate.active ? "aberto" : "fechado",
+               sqrtf((float)g_gate.floor_q8 / 256.0f),
+               sqrtf((float)g_gate.floor_q8 / 256.0f * NG_ON_RATIO_Q8 / 256.0f),
+               sqrtf((float)g_gate.energy));
+#endif
+        if (MIC_LED_VIZ) {
+            printf("[LED] espectro: %.1f fps | audio->LED med %u us max %u us (+%u us de meia janela)\n",
+                   g_viz_frames / 2.0f,
+                   (unsigned)(g_viz_lat_n ? g_viz_lat_sum / g_viz_lat_n : 0), (unsigned)g_viz_lat_max,
+                   (unsigned)(SAMPLES * 500000u / SAMPLE_RATE));
         }
-        tight_loop_contents();
+        g_viz_frames = 0; g_viz_lat_sum = 0; g_viz_lat_max = 0; g_viz_lat_n = 0;
+        dsp_sum_us = 0; dsp_max_us = 0; dsp_n = 0; frames_n = 0; filt_max_us = 0;
     }
 
-    adc_run(false);
-    return true;
-}
-
-static void apply_fft(void)
-{
-    float mean = 0.0f;
-    for (int i = 0; i < SAMPLES; i++) mean += (float)adc_buffer[i];
-    mean /= (float)SAMPLES;
-
-    for (int i = 0; i < SAMPLES; i++) {
-        float v = ((float)adc_buffer[i] - mean);
-        fft_input[i] = v / 2048.0f;
-    }
-
-    if (kiss_cfg != NULL) {
-        kiss_fftr(kiss_cfg, fft_input, fft_output);
+    if (MIC_LED_VIZ) {
+        viz_service(ativo ? &res.feat : NULL, block_us);
+    } else if (ativo || g_leds_lit) {
+        // LEDs só mudam com som ativo; ao fechar o gate apaga uma vez
+        update_leds(sound_type);
     }
 }
 
-static uint8_t detect_sound_type(float freq, float intensity)
+// Bloqueia (sem spin) até a IRQ entregar o próximo bloco completo.
+// Retorna o buffer pronto ou NULL em timeout.
+static const uint16_t* sample_mic(void)
 {
-    if (intensity < NOISE_THRESHOLD)
-        return 0;
-
-    if (freq > IGNORE_FREQ_MIN && freq < IGNORE_FREQ_MAX)
-        return 0;
-
-    if (freq < 200.0f)
-        return 1;
+    uint32_t n = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DMA_TIMEOUT_MS));
+    if (n == 0) return NULL;
 
-    if (freq < 600.0f)
-        return 2;
+    // mais de uma notificação acumulada: blocos que não foram processados
+    uint32_t done = g_blocks_done;
+    uint32_t lost = done - g_blocks_seen;
+    if (g_blocks_seen != 0 && lost > 1) g_overruns += lost - 1;
+    g_blocks_seen = done;
 
-    return 3;
+    return adc_buffer[g_ready_idx];
 }
 
 static void update_leds(uint8_t sound_type)
@@ -237,6 +462,7 @@ static void update_leds(uint8_t sound_type)
         end_row   = 4;
     } else {
         npWrite();
+        g_leds_lit = false;
         return;
     }
 
@@ -250,4 +476,55 @@ static void update_leds(uint8_t sound_type)
     }
 
     npWrite();
+    g_leds_lit = true;
+}
+
+// matriz em serpentina: LED 0 no canto inferior direito, linhas pares da
+// direita para a esquerda e ímpares da esquerda para a direita
+static inline uint led_index(int row, int col)
+{
+    return (uint)(row * MATRIX_WIDTH + ((row & 1) ? col : (MATRIX_WIDTH - 1 - col)));
+}
+
+static void viz_render(void)
+{
+    static const uint8_t row_rgb[MATRIX_HEIGHT][3] = {
+        { 0, 60, 0 }, { 0, 60, 0 }, { 60, 60, 0 }, { 60, 60, 0 }, { 80, 0, 0 },
+    };
+    bool lit = false;
+
+    npClear();
+    for (int col = 0; col < LV_COLS && col < MATRIX_WIDTH; col++) {
+        uint8_t h = led_viz_height(&g_viz, col);
+        for (int row = 0; row < h; row++) {
+            npSetLED(led_index(row, col), row_rgb[row][0], row_rgb[row][1], row_rgb[row][2]);
+        }
+        uint8_t pk = g_viz.peak[col];
+        if (pk > h) npSetLED(led_index(pk - 1, col), 40, 40, 40);
+        lit = lit || h || pk;
+    }
+    npWrite();
+    g_leds_lit = lit;
+}
+
+// um quadro novo redesenha na hora; sem quadro novo, só a cada VIZ_FRAME_MS
+static void viz_service(const mic_features_t *feat, uint32_t block_us)
+{
+    uint32_t now_us = time_us_32();
+    if (!feat && (now_us - g_viz_last_us) < VIZ_FRAME_MS * 1000u) return;
+
+    uint32_t dt_ms = (now_us - g_viz_last_us) / 1000u;
+    g_viz_last_us += dt_ms * 1000u;   // guarda o resto: a queda não atrasa
+    led_viz_step(&g_viz, dt_ms);
+    if (feat) led_viz_push(&g_viz, feat);
+
+    viz_render();
+    g_viz_frames++;
+
+    if (feat) {
+        uint32_t lat = time_us_32() - block_us;
+        g_viz_lat_sum += lat;
+        g_viz_lat_n++;
+        if (lat > g_viz_lat_max) g_viz_lat_max = lat;
+    }
 }
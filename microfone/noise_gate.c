@@ -0,0 +1,69 @@
+#include <string.h>
+
+#include "noise_gate.h"
+#include "hot_func.h"
+
+void noise_gate_init(noise_gate_t *g)
+{
+    memset(g, 0, sizeof(*g));
+}
+
+uint32_t HOT_FUNC(noise_gate_frame_energy)(const uint16_t *s, int n)
+{
+    if (n <= 0) return 0;
+
+    uint32_t sum = 0;
+    uint64_t sum2 = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t v = s[i];
+        sum  += v;
+        sum2 += v * v;
+    }
+
+    // var = (n·Σx² - (Σx)²) / n²
+    uint64_t nn = (uint64_t)n;
+    uint64_t num = sum2 * nn - (uint64_t)sum * sum;
+    return (uint32_t)(num / (nn * nn));
+}
+
+bool noise_gate_update(noise_gate_t *g, uint32_t energy)
+{
+    uint32_t e_q8 = energy << 8;
+
+    g->energy = energy;
+    g->frames++;
+
+    if (!g->primed) {
+        g->floor_q8 = e_q8;
+        g->primed = true;
+    }
+
+    // decisão com o piso de antes deste quadro
+    uint64_t on_thr  = ((uint64_t)g->floor_q8 * NG_ON_RATIO_Q8) >> 8;
+    uint64_t off_thr = ((uint64_t)g->floor_q8 * NG_OFF_RATIO_Q8) >> 8;
+    bool loud = energy >= NG_MIN_ENERGY;
+
+    if (loud && e_q8 > on_thr) {
+        g->active = true;
+        g->hang = NG_HANGOVER;
+    } else if (g->active) {
+        if (loud && e_q8 > off_thr) {
+            g->hang = NG_HANGOVER;
+        } else if (g->hang > 0) {
+            g->hang--;
+        } else {
+            g->active = false;
+        }
+    }
+
+    // piso: desce rápido, sobe devagar (mais devagar ainda com som ativo)
+    if (e_q8 < g->floor_q8) {
+        g->floor_q8 -= (g->floor_q8 - e_q8) >> NG_FLOOR_DOWN_SHIFT;
+    } else {
+        int sh = g->active ? NG_FLOOR_UP_SHIFT_ACT : NG_FLOOR_UP_SHIFT;
+        g->floor_q8 += (e_q8 - g->floor_q8) >> sh;
+    }
+
+    if (g->active) g->active_frames++;
+    return g->active;
+}
@@ -0,0 +1,58 @@
+#ifndef NOISE_GATE_H
+#define NOISE_GATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// =========================
+// Piso de ruído adaptativo + gate de atividade (VAD) do microfone
+// =========================
+// Por quadro, só uma passada inteira barata (média e energia, sem FFT):
+//   - energia = variância das amostras (LSB² do ADC)
+//   - piso: média exponencial assimétrica da energia, desce rápido e sobe
+//     devagar (segue um percentil baixo, como "minimum statistics"), então
+//     acompanha o ruído de cada sala sem ser puxado pelos sons.
+//   - gate: abre quando energia > piso * ON (com mínimo absoluto) e fecha
+//     quando fica abaixo de piso * OFF por NG_HANGOVER quadros seguidos
+//     (histerese + hangover: não corta o fim das palavras/batidas).
+//
+// Com o gate fechado a MicTask não roda FFT/classificação nem mexe nos LEDs.
+
+// limiares em energia (razão de potência, Q8): 256 = 0 dB
+#ifndef NG_ON_RATIO_Q8
+#define NG_ON_RATIO_Q8     1024   // +6 dB acima do piso abre
+#endif
+#ifndef NG_OFF_RATIO_Q8
+#define NG_OFF_RATIO_Q8    512    // +3 dB: abaixo disso conta o hangover
+#endif
+#ifndef NG_HANGOVER
+#define NG_HANGOVER        8      // quadros (~100 ms a 20 kHz / 256)
+#endif
+#ifndef NG_MIN_ENERGY
+#define NG_MIN_ENERGY      16     // 4 LSB rms: abaixo disso é sempre silêncio
+#endif
+
+// velocidade do piso (shift da média exponencial, por quadro)
+#define NG_FLOOR_DOWN_SHIFT   2   // desce em ~4 quadros
+#define NG_FLOOR_UP_SHIFT     8   // sobe em ~256 quadros (~3 s) com o gate fechado
+#define NG_FLOOR_UP_SHIFT_ACT 11  // e 8x mais devagar com o gate aberto
+
+typedef struct {
+    uint32_t floor_q8;     // piso de ruído (energia, Q8)
+    uint32_t energy;       // energia do último quadro (LSB²)
+    uint16_t hang;         // quadros restantes de hangover
+    bool     active;
+    bool     primed;       // piso já inicializado
+    uint32_t frames;
+    uint32_t active_frames;
+} noise_gate_t;
+
+void     noise_gate_init(noise_gate_t *g);
+
+// energia (variância) de n leituras do ADC, em LSB²
+uint32_t noise_gate_frame_energy(const uint16_t *s, int n);
+
+// atualiza piso e gate com a energia do quadro; retorna se o gate está aberto
+bool     noise_gate_update(noise_gate_t *g, uint32_t energy);
+
+#endif
@@ -28,11 +28,15 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
-#include "pico/cyw43_arch.h"
+#include "net_sup.h"
+#include "net_io.h"
+#include "net_bench.h"
 #include "mqtt.h"
 #include "secrets.h"
 
 #include "mic.h"
+#include "face_detect.h"
+#include "hot_bench.h"
 
 // ==========================
 // CONFIG: manter MQTT sem mexer no resto
@@ -64,27 +68,18 @@
 // ==========================
 // LOG COM LIMITE
 // ==========================
-static inline bool log_every_ms(uint32_t ms) {
-    static TickType_t last = 0;
+static inline bool log_every_ms(TickType_t *last, uint32_t ms) {
     TickType_t now = xTaskGetTickCount();
-    if ((now - last) >= pdMS_TO_TICKS(ms)) { last = now; return true; }
+    if ((now - *last) >= pdMS_TO_TICKS(ms)) { *last = now; return true; }
     return false;
 }
-#define LOG_5S(...) do { if (log_every_ms(5000)) printf(__VA_ARGS__); } while(0)
+// cada LOG_5S tem o seu próprio relógio (senão só o 1º log do ciclo sai)
+#define LOG_5S(...) do { static TickType_t _last = 0; if (log_every_ms(&_last, 5000)) printf(__VA_ARGS__); } while(0)
 
 // ==========================
 // TIPOS DO CUBO
 // ==========================
-typedef enum {
-    FACE_MOVENDO = -1,
-    FACE_FRENTE = 0,
-    FACE_TRAS,
-    FACE_ESQ,
-    FACE_DIR,
-    FACE_BASE,
-    FACE_TOPO
-} face_t;
-
+// face_t vem de face_detect.h
 typedef enum { ESTADO_PARADO = 0, ESTADO_RODANDO } estado_t;
 
 // ==========================
@@ -103,9 +98,6 @@ typedef enum {
 // ==========================
 // CONFIG DO JOGO
 // ==========================
-static const float LIMIAR_G = 0.60f;
-static const int   ESTABILIDADE_MIN = 6;
-
 static const uint32_t LOOP_MS         = 40;
 static const uint32_t HOLD_MS_A       = 900;   // A longo: troca modo
 static const uint32_t HOLD_MS_B       = 1200;  // B longo: encerra sessão
@@ -153,8 +145,7 @@ static face_t last_input_face = FACE_MOVENDO;
 static face_t alvo_l1 = FACE_FRENTE;
 static face_t last_l1_target = FACE_MOVENDO;
 
-static face_t last_face_lida = FACE_MOVENDO;
-static int estabilidade_cont = 0;
+static face_filtro_t g_face_filtro = { FACE_MOVENDO, 0, FACE_MOVENDO };
 static face_t face_base_estavel = FACE_MOVENDO;
 
 static bool yellow_timer_active = false;
@@ -166,14 +157,52 @@ static char texto_face[12];
 static char texto_alvo[12];
 static char texto_info[24];
 
-// Wi-Fi status (simples)
-static volatile bool g_wifi_ok = false;
-
 // Handles
 static TaskHandle_t g_game_task = NULL;
 static TaskHandle_t g_mic_task  = NULL;
 static TaskHandle_t g_mqtt_task = NULL;
 
+// Afinidade (SMP): o core 0 fica com jogo, IMU e rede (a NetSup inicia o
+// cyw43/lwIP nele, então as IRQs deles também estão lá, e a tcpip_thread é
+// presa nele pelo net_io_init); o core 1 fica só
+// com o DSP do microfone e o Neopixel, que a MicTask atualiza.
+#define CORE_JOGO  ((UBaseType_t)(1u << 0))
+#define CORE_DSP   ((UBaseType_t)(1u << 1))
+
+// Tasks todas estáticas (nada no heap do FreeRTOS em execução). Tamanhos
+// em palavras, os mesmos de quando saíam do heap: com
+// configCHECK_FOR_STACK_OVERFLOW 2 uma pilha curta trava o cubo, então só
+// diminuem a partir do high-water mark ([STACK]) que a Health imprime,
+// medido na placa, mais folga. O mem_report.py mostra o total.
+//   Game:   eventos do local_report (JSON de 384 B + resumo do mic), registro
+//           da telemetria (tele_snapshot_t, ~0,7 KB) e OLED
+//   MQTT:   laço do mqtt.c (os callbacks rodam na tcpip_thread, net_io.h)
+//   Health: printf
+//   Mic:    printf de 7 floats do log e, com HOT_BENCH, o snprintf do JSON
+#define GAME_TASK_STACK_WORDS   4096
+#define MQTT_TASK_STACK_WORDS   4096
+#define HEALTH_TASK_STACK_WORDS 2048
+#define MIC_TASK_STACK_WORDS    4096
+
+static StackType_t  g_game_stack[GAME_TASK_STACK_WORDS];
+static StaticTask_t g_game_tcb;
+static StackType_t  g_mic_stack[MIC_TASK_STACK_WORDS];
+static StaticTask_t g_mic_tcb;
+#if USE_MQTT
+static StackType_t  g_mqtt_stack[MQTT_TASK_STACK_WORDS];
+static StaticTask_t g_mqtt_tcb;
+#endif
+static StackType_t  g_health_stack[HEALTH_TASK_STACK_WORDS];
+static StaticTask_t g_health_tcb;
+
+// Jitter do laço do jogo: quanto cada espera de LOOP_MS acordou fora do
+// previsto (vTaskDelay já varia 1 tick; acima disso é disputa de CPU).
+// A GameTask acumula, a Health lê e pede o zeramento a cada 5 s.
+static volatile uint32_t g_jit_sum_us = 0;
+static volatile uint32_t g_jit_max_us = 0;
+static volatile uint32_t g_jit_n      = 0;
+static volatile bool     g_jit_reset  = false;
+
 // ==========================
 // MÉTRICAS
 // ==========================
@@ -184,6 +213,15 @@ static uint32_t g_round_start_ms = 0;
 static uint32_t g_last_round_ms  = 0;
 static uint32_t g_sum_ok_ms      = 0;
 
+// Momentos que a telemetria precisa mostrar: fim de rodada, troca de
+// modo, start/stop (o MQTT junta os da mesma volta num publish só)
+static inline void telemetry_changed(void) {
+#if USE_MQTT
+    mqtt_telemetry_changed();
+#endif
+}
+static void telemetry_round(bool ok);
+
 static inline void metrics_reset_all(void) {
     g_ok_total = 0;
     g_err_total = 0;
@@ -193,6 +231,7 @@ static inline void metrics_reset_all(void) {
 }
 static inline void metrics_round_start(void) {
     g_round_start_ms = to_ms_since_boot(get_absolute_time());
+    mic_reset_stats(MIC_STATS_ROUND);   // resumo do mic no evento ok/err é desta rodada
 }
 static inline void metrics_round_finish_ok(void) {
     uint32_t now = to_ms_since_boot(get_absolute_time());
@@ -200,12 +239,14 @@ static inline void metrics_round_finish_ok(void) {
     g_ok_total++;
     g_sum_ok_ms += g_last_round_ms;
     g_round_start_ms = 0;
+    telemetry_round(true);
 }
 static inline void metrics_round_finish_err(void) {
     uint32_t now = to_ms_since_boot(get_absolute_time());
     g_last_round_ms = (g_round_start_ms != 0) ? (now - g_round_start_ms) : 0;
     g_err_total++;
     g_round_start_ms = 0;
+    telemetry_round(false);
 }
 static inline uint32_t metrics_avg_ms(void) {
     if (g_ok_total == 0) return 0;
@@ -224,11 +265,25 @@ static const char* mode_to_str(menu_mode_t m) {
     }
 }
 
+#if LOCAL_REPORT_ENABLE
+static lr_modo_t mode_to_lr(menu_mode_t m) {
+    switch (m) {
+        case MODE_LVL1:       return LR_MODO_NIVEL1;
+        case MODE_MEM_NORMAL: return LR_MODO_MEMORIA;
+        case MODE_MEM_RAPIDO: return LR_MODO_MEMORIA_RAPIDA;
+        default:              return LR_MODO_UNK;
+    }
+}
+#endif
+
 #if USE_MQTT
 // ==========================
 // CALLBACK PARA MQTT
 // ==========================
-static void cubo_data_to_json_callback(char *buffer, size_t buffer_size) {
+// Estado atual, com as chaves e formatos do JSON de antes; o mqtt.c manda
+// só as que mudaram (mqtt_telemetry_changed() marca os momentos que
+// interessam). Os números da rodada vão com horário em telemetry_round().
+static void cubo_telemetry_callback(tele_snapshot_t *t) {
     char user[16];
     bool has_user = mqtt_get_active_user(user, sizeof(user));
     if (!has_user || user[0] == '\0') has_user = false;
@@ -237,47 +292,59 @@ static void cubo_data_to_json_callback(char *buffer, size_t buffer_size) {
     uint8_t mt=0;
     mic_get_last(&mf, &mi, &mt);
 
-    snprintf(buffer, buffer_size,
-        "{"
-        "\"estado\":%d,"
-        "\"user\":\"%s\","
-        "\"modo\":\"%s\","
-        "\"alvo\":\"%s\","
-        "\"face\":\"%s\","
-        "\"info\":\"%s\","
-        "\"mic_freq\":%.1f,"
-        "\"mic_int\":%.3f,"
-        "\"mic_type\":%u,"
-        "\"ok_total\":%u,"
-        "\"err_total\":%u,"
-        "\"last_ms\":%u,"
-        "\"avg_ms\":%u"
-        "}",
-        (int)estado,
-        has_user ? user : "",
-        texto_modo, texto_alvo, texto_face, texto_info,
-        mf, mi, (unsigned)mt,
-        (unsigned)g_ok_total,
-        (unsigned)g_err_total,
-        (unsigned)g_last_round_ms,
-        (unsigned)metrics_avg_ms()
-    );
+    mic_features_t feat;
+    mic_get_features(&feat);
+
+    tele_put_u32(t, "estado",   estado);
+    tele_put_str(t, "user",     has_user ? user : "");
+    tele_put_str(t, "modo",     texto_modo);
+    tele_put_str(t, "alvo",     texto_alvo);
+    tele_put_str(t, "face",     texto_face);
+    tele_put_str(t, "info",     texto_info);
+    tele_put_fix(t, "mic_freq", mf, 1);
+    tele_put_fix(t, "mic_int",  mi, 3);
+    tele_put_u32(t, "mic_type", mt);
+    tele_put_fix(t, "mic_rms",  feat.rms, 4);
+    tele_put_fix(t, "mic_cent", feat.centroid_hz, 0);
+    tele_put_fix(t, "mic_flat", feat.flatness, 3);
+    tele_put_fix(t, "mic_zcr",  feat.zcr, 3);
 }
 #endif
 
+// Fim de rodada: resultado + resumo do mic da rodada, com o horário de
+// agora, para o lote do ThingsBoard (chamado antes do local_report, que
+// zera as estatísticas da rodada ao ler)
+static void telemetry_round(bool ok) {
+#if USE_MQTT
+    mic_stats_t s;
+    mic_get_stats(MIC_STATS_ROUND, &s, false);
+
+    tele_snapshot_t t;
+    t.n = 0;
+    tele_put_str(&t, "resultado",   ok ? "ok" : "err");
+    tele_put_str(&t, "modo",        mode_to_str(mode_sel));
+    tele_put_u32(&t, "ok_total",    g_ok_total);
+    tele_put_u32(&t, "err_total",   g_err_total);
+    tele_put_u32(&t, "last_ms",     g_last_round_ms);
+    tele_put_u32(&t, "avg_ms",      metrics_avg_ms());
+    tele_put_fix(&t, "mic_freq",    s.freq.mean, 1);
+    tele_put_fix(&t, "mic_int",     s.intensity.mean, 3);
+    tele_put_fix(&t, "mic_rms",     s.rms.mean, 4);
+    tele_put_fix(&t, "mic_rms_max", s.rms.max, 4);
+    tele_put_fix(&t, "mic_cent",    s.centroid.mean, 0);
+    tele_put_fix(&t, "mic_flat",    s.flatness.mean, 3);
+    tele_put_u32(&t, "mic_type",    mic_stats_top_type(&s));
+    tele_put_u32(&t, "mic_n",       s.frames);
+    mqtt_telemetry_record(&t);
+#endif
+    telemetry_changed();
+}
+
 // ==========================
 // UTILS
 // ==========================
 static void face_to_str(face_t f, char *dest) {
-    switch (f) {
-        case FACE_FRENTE: strcpy(dest, "FRENTE"); break;
-        case FACE_TRAS:   strcpy(dest, "TRAS"); break;
-        case FACE_ESQ:    strcpy(dest, "ESQ"); break;
-        case FACE_DIR:    strcpy(dest, "DIR"); break;
-        case FACE_BASE:   strcpy(dest, "BASE"); break;
-        case FACE_TOPO:   strcpy(dest, "TOPO"); break;
-        default:          strcpy(dest, "MOV"); break;
-    }
+    strcpy(dest, face_nome(f));
 }
 static int face_to_led_pin(face_t f) {
     switch (f) {
@@ -364,44 +431,10 @@ static void oled_your_turn(const char *titulo) {
 static face_t detectar_face_base_raw(void) {
     int16_t accel[3], gyro[3], temp;
     mpu6050_read_raw(accel, gyro, &temp);
-
-    float ax = accel[0] / ACCEL_SENS_2G;
-    float ay = accel[1] / ACCEL_SENS_2G;
-    float az = accel[2] / ACCEL_SENS_2G;
-
-    float abs_ax = fabsf(ax);
-    float abs_ay = fabsf(ay);
-    float abs_az = fabsf(az);
-
-    if (abs_ax > abs_ay && abs_ax > abs_az && abs_ax > LIMIAR_G) {
-        return (ax > 0) ? FACE_ESQ : FACE_DIR;
-    } else if (abs_ay > abs_ax && abs_ay > abs_az && abs_ay > LIMIAR_G) {
-        return (ay > 0) ? FACE_FRENTE : FACE_TRAS;
-    } else if (abs_az > abs_ax && abs_az > abs_ay && abs_az > LIMIAR_G) {
-        return (az > 0) ? FACE_TOPO : FACE_BASE;
-    }
-    return FACE_MOVENDO;
+    return face_classificar(accel);
 }
 static void atualizar_face_estavel(void) {
-    face_t f = detectar_face_base_raw();
-
-    if (f == FACE_MOVENDO) {
-        estabilidade_cont = 0;
-        last_face_lida = FACE_MOVENDO;
-        face_base_estavel = FACE_MOVENDO;
-        return;
-    }
-
-    if (f == last_face_lida) {
-        if (estabilidade_cont < 100) estabilidade_cont++;
-    } else {
-        estabilidade_cont = 0;
-        last_face_lida = f;
-    }
-
-    if (estabilidade_cont >= ESTABILIDADE_MIN) {
-        face_base_estavel = f;
-    }
+    face_base_estavel = face_filtro_atualizar(&g_face_filtro, detectar_face_base_raw());
 }
 static void yellow_timer_update(void) {
     if (face_base_estavel == FACE_TOPO) {
@@ -610,44 +643,28 @@ static void hw_init(void)
 }
 
 // ==========================
-// Wi-Fi robusto (retry)
+// Rede: link subiu/caiu (task NetSup, net_sup.h)
 // ==========================
-static void wifi_connect_with_retry(void)
+// Vira evento no local_report e registro com horário no MQTT; os dois
+// saem quando o link voltar, com o momento em que aconteceu.
+static void cubo_net_callback(const net_sup_ev_t *ev)
 {
-    g_wifi_ok = false;
-
-    printf("Iniciando Wi-Fi...\n");
-    if (cyw43_arch_init()) {
-        printf("Erro ao inicializar chip Wi-Fi\n");
-        while (true) tight_loop_contents();
-    }
-
-    cyw43_arch_enable_sta_mode();
-    sleep_ms(300);
-
-    const int MAX_TENTATIVAS = 10;
-    for (int t = 1; t <= MAX_TENTATIVAS; t++) {
-        printf("Wi-Fi: tentando conectar (%d/%d) SSID=%s\n", t, MAX_TENTATIVAS, WIFI_SSID);
-
-        int r = cyw43_arch_wifi_connect_timeout_ms(
-            WIFI_SSID,
-            WIFI_PASSWORD,
-            CYW43_AUTH_WPA2_AES_PSK,
-            30000
-        );
-
-        if (r == 0) {
-            printf("Wi-Fi conectado!\n");
-            g_wifi_ok = true;
-            return;
-        }
-
-        printf("Falha ao conectar no Wi-Fi. Codigo: %d\n", r);
-        sleep_ms(2000);
+#if LOCAL_REPORT_ENABLE
+    local_report_event_net(ev->up, ev->rssi, ev->tentativas, ev->fora_ms);
+#endif
+#if USE_MQTT
+    tele_snapshot_t t;
+    t.n = 0;
+    tele_put_u32(&t, "wifi",            ev->up ? 1u : 0u);
+    tele_put_u32(&t, "wifi_quedas",     ev->quedas);
+    if (ev->up) {
+        tele_put_i32(&t, "wifi_rssi",       ev->rssi);
+        tele_put_u32(&t, "wifi_fora_ms",    ev->fora_ms);
+        tele_put_u32(&t, "wifi_tentativas", ev->tentativas);
     }
-
-    printf("Nao conectou apos varias tentativas.\n");
-    while (true) tight_loop_contents();
+    mqtt_telemetry_record(&t);
+#endif
+    (void)ev;
 }
 
 // ==========================
@@ -680,6 +697,25 @@ static void oled_draw_menu(bool force)
 // ==========================
 // TASK DO JOGO
 // ==========================
+static void game_loop_wait(void)
+{
+    uint32_t t0 = time_us_32();
+    vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+    int32_t dev = (int32_t)(time_us_32() - t0) - (int32_t)(LOOP_MS * 1000u);
+    uint32_t jit = (uint32_t)(dev < 0 ? -dev : dev);
+
+    if (g_jit_reset) {
+        g_jit_sum_us = 0; g_jit_max_us = 0; g_jit_n = 0;
+        g_jit_reset = false;
+    }
+    g_jit_sum_us += jit;
+    g_jit_n++;
+    if (jit > g_jit_max_us) g_jit_max_us = jit;
+#if defined(HOT_BENCH) && HOT_BENCH
+    hot_bench_game_jitter(jit);
+#endif
+}
+
 static void vGameTask(void *pvParameters)
 {
     (void) pvParameters;
@@ -717,15 +753,17 @@ static void vGameTask(void *pvParameters)
             last_input_face = FACE_MOVENDO;
             fast_rounds_done = 0;
             g_round_start_ms = 0;
+            telemetry_changed();
         }
 
         // B longo: encerra sessão (stop geral)
         if (evB == 1) {
 #if LOCAL_REPORT_ENABLE
-            local_report_event_stop(g_ok_total, g_err_total, mode_to_str(mode_sel));
+            local_report_event_stop(g_ok_total, g_err_total, mode_to_lr(mode_sel));
             printf("[LOCAL] STOP GERAL enviado\n");
 #endif
             metrics_reset_all();
+            telemetry_changed();
 
             beep_err();
             oled_msg("SESSAO ENCERRADA", "Voltou ao MENU", 900);
@@ -769,13 +807,14 @@ static void vGameTask(void *pvParameters)
                     mem_len++;
                     if (mem_len > MEM_LEN_MAX) { mode_sel = MODE_LVL1; mem_len = MEM_LEN_MIN; }
                 }
+                telemetry_changed();
             }
 
             // A curto: start
             if (evA == 0) {
 #if LOCAL_REPORT_ENABLE
                 local_report_new_session();
-                local_report_event_start(mode_to_str(mode_sel));
+                local_report_event_start(mode_to_lr(mode_sel));
                 printf("[LOCAL] start solicitado (%s)\n", mode_to_str(mode_sel));
 #endif
                 beep_start();
@@ -786,9 +825,10 @@ static void vGameTask(void *pvParameters)
                 fast_rounds_done = 0;
                 g_round_start_ms = 0;
                 go_wait_yellow();
+                telemetry_changed();
             }
 
-            vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+            game_loop_wait();
             continue;
         }
 
@@ -820,7 +860,7 @@ static void vGameTask(void *pvParameters)
                 }
             }
 
-            vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+            game_loop_wait();
             continue;
         }
 
@@ -859,20 +899,20 @@ static void vGameTask(void *pvParameters)
                 if (face_base_estavel == alvo_l1) {
                     metrics_round_finish_ok();
 #if LOCAL_REPORT_ENABLE
-                    local_report_event_ok(g_last_round_ms, metrics_avg_ms(), g_ok_total, g_err_total, "NIVEL 1");
+                    local_report_event_ok(g_last_round_ms, metrics_avg_ms(), g_ok_total, g_err_total, LR_MODO_NIVEL1);
 #endif
                     feedback_ok_go_yellow("Volte ao AMARELO");
                 } else {
                     metrics_round_finish_err();
 #if LOCAL_REPORT_ENABLE
-                    local_report_event_err(g_last_round_ms, g_ok_total, g_err_total, "NIVEL 1");
+                    local_report_event_err(g_last_round_ms, g_ok_total, g_err_total, LR_MODO_NIVEL1);
 #endif
                     repeat_same_seq = false;
                     feedback_err_repeat_go_yellow("Volte ao AMARELO");
                 }
             }
 
-            vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+            game_loop_wait();
             continue;
         }
 
@@ -893,7 +933,7 @@ static void vGameTask(void *pvParameters)
             metrics_round_start();
             st = ST_MEM_INPUT;
 
-            vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+            game_loop_wait();
             continue;
         }
 
@@ -934,7 +974,7 @@ static void vGameTask(void *pvParameters)
                         if (input_idx >= mem_len) {
                             metrics_round_finish_ok();
 #if LOCAL_REPORT_ENABLE
-                            local_report_event_ok(g_last_round_ms, metrics_avg_ms(), g_ok_total, g_err_total, mode_to_str(mode_sel));
+                            local_report_event_ok(g_last_round_ms, metrics_avg_ms(), g_ok_total, g_err_total, mode_to_lr(mode_sel));
 #endif
 
                             if (rapido) {
@@ -958,7 +998,7 @@ static void vGameTask(void *pvParameters)
                     } else {
                         metrics_round_finish_err();
 #if LOCAL_REPORT_ENABLE
-                        local_report_event_err(g_last_round_ms, g_ok_total, g_err_total, mode_to_str(mode_sel));
+                        local_report_event_err(g_last_round_ms, g_ok_total, g_err_total, mode_to_lr(mode_sel));
 #endif
                         repeat_same_seq = true;
                         feedback_err_repeat_go_yellow("Repete a MESMA");
@@ -966,12 +1006,12 @@ static void vGameTask(void *pvParameters)
                 }
             }
 
-            vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+            game_loop_wait();
             continue;
         }
 
         st = ST_MENU;
-        vTaskDelay(pdMS_TO_TICKS(LOOP_MS));
+        game_loop_wait();
     }
 }
 
@@ -981,11 +1021,13 @@ static void vGameTask(void *pvParameters)
 static void vMicTask(void *pvParameters)
 {
     (void) pvParameters;
+#if defined(HOT_BENCH) && HOT_BENCH
+    hot_bench_run();
+#endif
     mic_init();
     for (;;) {
         watchdog_update();
-        mic_process();
-        vTaskDelay(pdMS_TO_TICKS(30));
+        mic_process();   // bloqueia até o DMA entregar o próximo bloco
     }
 }
 
@@ -997,12 +1039,17 @@ static void vMQTTTask(void *pvParameters)
 {
     (void) pvParameters;
 
-    while (!g_wifi_ok) {
+    // o jogo já está rodando; o MQTT começa quando o link subir a 1ª vez
+    // (depois disso o mqtt.c acompanha as quedas pelo net_sup)
+    while (!net_sup_is_up()) {
         watchdog_update();
         vTaskDelay(pdMS_TO_TICKS(200));
     }
 
-    mqtt_start_application("v1/devices/me/telemetry", "pico_cubo", cubo_data_to_json_callback);
+#if defined(NET_BENCH) && NET_BENCH
+    net_bench_run();
+#endif
+    mqtt_start_application("v1/devices/me/telemetry", "pico_cubo", cubo_telemetry_callback);
 
     for (;;) {
         watchdog_update();
@@ -1014,6 +1061,38 @@ static void vMQTTTask(void *pvParameters)
 // ==========================
 // TASK DE SAÚDE (debug leve)
 // ==========================
+// carga por core: 100% - fatia do idle daquele core no intervalo
+static void health_cpu_load(void)
+{
+    static configRUN_TIME_COUNTER_TYPE last_t = 0, last_idle[configNUM_CORES] = {0}, last_mic = 0;
+
+    configRUN_TIME_COUNTER_TYPE now = portGET_RUN_TIME_COUNTER_VALUE();
+    configRUN_TIME_COUNTER_TYPE dt = now - last_t;
+    unsigned load[configNUM_CORES];
+
+    for (BaseType_t c = 0; c < configNUM_CORES; c++) {
+        configRUN_TIME_COUNTER_TYPE idle = ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(c));
+        configRUN_TIME_COUNTER_TYPE d = idle - last_idle[c];
+        last_idle[c] = idle;
+        load[c] = (dt && d < dt) ? (unsigned)(100u - (d * 100u) / dt) : 0u;
+    }
+
+    configRUN_TIME_COUNTER_TYPE mic = g_mic_task ? ulTaskGetRunTimeCounter(g_mic_task) : 0;
+    unsigned mic_pct = dt ? (unsigned)(((mic - last_mic) * 100u) / dt) : 0u;
+    last_mic = mic;
+
+    uint32_t n = g_jit_n;
+    unsigned jit_avg = n ? (unsigned)(g_jit_sum_us / n) : 0u;
+    unsigned jit_max = (unsigned)g_jit_max_us;
+    g_jit_reset = true;
+
+    if (last_t) {
+        printf("[CPU] core0=%u%% core1=%u%% | Mic=%u%% | jitter jogo: med %u us max %u us (%u esperas)\n",
+               load[0], load[1], mic_pct, jit_avg, jit_max, (unsigned)n);
+    }
+    last_t = now;
+}
+
 static void vHealthTask(void *pvParameters)
 {
     (void) pvParameters;
@@ -1021,15 +1100,34 @@ static void vHealthTask(void *pvParameters)
     for (;;) {
         watchdog_update();
 
-        LOG_5S("[HEALTH] wifi_ok=%d | free_heap=%u bytes\n",
-               (int)g_wifi_ok,
-               (unsigned)xPortGetFreeHeapSize());
+        health_cpu_load();
+
+        LOG_5S("[HEALTH] wifi=%d (quedas %u) | heap livre=%u (mínimo %u) bytes\n",
+               (int)net_sup_is_up(), (unsigned)net_sup_quedas(),
+               (unsigned)xPortGetFreeHeapSize(),
+               (unsigned)xPortGetMinimumEverFreeHeapSize());
 
         if (g_game_task)  LOG_5S("[STACK] Game=%u\n", (unsigned)uxTaskGetStackHighWaterMark(g_game_task));
         if (g_mic_task)   LOG_5S("[STACK] Mic =%u\n", (unsigned)uxTaskGetStackHighWaterMark(g_mic_task));
+        {
+            uint32_t blocks, overruns;
+            mic_get_dma_stats(&blocks, &overruns);
+            LOG_5S("[MIC] blocos=%u overruns=%u\n", (unsigned)blocks, (unsigned)overruns);
+        }
 #if USE_MQTT
         if (g_mqtt_task)  LOG_5S("[STACK] MQTT=%u\n", (unsigned)uxTaskGetStackHighWaterMark(g_mqtt_task));
 #endif
+        TaskHandle_t net = net_sup_task_handle();
+        if (net) LOG_5S("[STACK] NetSup=%u\n", (unsigned)uxTaskGetStackHighWaterMark(net));
+        TaskHandle_t tcpip = net_io_task_handle();
+        if (tcpip) LOG_5S("[STACK] tcpip=%u\n", (unsigned)uxTaskGetStackHighWaterMark(tcpip));
+        {
+            net_io_stats_t ns;
+            net_io_get_stats(&ns, false);
+            LOG_5S("[NET] net_io: %lu chamadas, med %lu / máx %lu us, fila cheia %lu\n",
+                   (unsigned long)ns.n, (unsigned long)(ns.n ? ns.soma_us / ns.n : 0),
+                   (unsigned long)ns.max_us, (unsigned long)ns.cheio);
+        }
 #if LOCAL_REPORT_ENABLE
         TaskHandle_t lr = local_report_get_task_handle();
         if (lr) LOG_5S("[STACK] LocalUDP=%u\n", (unsigned)uxTaskGetStackHighWaterMark(lr));
@@ -1048,19 +1146,27 @@ int main(void)
 
     watchdog_enable(8000, 1);
 
-    wifi_connect_with_retry();
+    // a rede sobe em segundo plano (NetSup): o jogo não espera o Wi-Fi
+    net_sup_init(cubo_net_callback);
 
 #if LOCAL_REPORT_ENABLE
     local_report_init();
     printf("[LOCAL] init feito\n");
 #endif
+#if USE_MQTT
+    mqtt_telemetry_init();
+#endif
 
-    xTaskCreate(vGameTask,   "GameTask", 4096, NULL, 2, &g_game_task);
-    xTaskCreate(vMicTask,    "MicTask",  4096, NULL, 1, &g_mic_task);
+    g_game_task = xTaskCreateStaticAffinitySet(vGameTask, "GameTask", GAME_TASK_STACK_WORDS, NULL, 2,
+                                               g_game_stack, &g_game_tcb, CORE_JOGO);
+    g_mic_task  = xTaskCreateStaticAffinitySet(vMicTask, "MicTask", MIC_TASK_STACK_WORDS, NULL, 1,
+                                               g_mic_stack, &g_mic_tcb, CORE_DSP);
 #if USE_MQTT
-    xTaskCreate(vMQTTTask,   "MQTTTask", 4096, NULL, 3, &g_mqtt_task);
+    g_mqtt_task = xTaskCreateStaticAffinitySet(vMQTTTask, "MQTTTask", MQTT_TASK_STACK_WORDS, NULL, 3,
+                                               g_mqtt_stack, &g_mqtt_tcb, CORE_JOGO);
 #endif
-    xTaskCreate(vHealthTask, "Health",   2048, NULL, 1, NULL);
+    xTaskCreateStaticAffinitySet(vHealthTask, "Health", HEALTH_TASK_STACK_WORDS, NULL, 1,
+                                 g_health_stack, &g_health_tcb, CORE_JOGO);
 
     vTaskStartScheduler();
 
@@ -1,13 +1,55 @@
 #include "mqtt.h"
 #include "secrets.h"
+#include "json_writer.h"
+#include "net_sup.h"
+#include "net_io.h"
 
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 
+#include "lwip/apps/sntp.h"
+
+#include "semphr.h"
+
 static MQTT_CLIENT_T g_state;
 static GetDataCallback g_get_data_cb = NULL;
 
+// Delta da telemetria: hash (FNV-1a) do valor de cada chave no último
+// publish confirmado; 80 B no lugar de uma cópia do snapshot
+static tele_snapshot_t   g_tele;                        // fora da pilha da task
+static uint32_t          g_tele_acked[TELE_MAX_KEYS];
+static uint32_t          g_tele_acked_mask = 0;         // chaves com hash válido
+static uint32_t          g_tele_sent[TELE_MAX_KEYS];
+static uint32_t          g_tele_sent_mask = 0;          // chaves no publish em voo
+static volatile uint32_t g_tele_kick_ms = 0;            // 1ª mudança pendente (0 = nenhuma)
+
+// Lotes com horário: registros da GameTask e da NetSup -> g_rec_mb ->
+// g_batch (que fica intacto até o PUBACK; se falhar, vai de novo com os
+// mesmos ts). Dois escritores: o envio passa pelo mutex (regra do FreeRTOS)
+static MessageBufferHandle_t g_rec_mb = NULL;
+static StaticMessageBuffer_t g_rec_mb_buf;
+static SemaphoreHandle_t     g_rec_mtx = NULL;
+static StaticSemaphore_t     g_rec_mtx_buf;
+static uint8_t               g_rec_mb_store[TELE_REC_MB_BYTES + 1];
+static uint8_t               g_rec[4 + TELE_REC_MAX];   // tirado do buffer, ainda fora do lote
+static size_t                g_rec_len = 0;
+static tele_batch_t          g_batch;
+
+// epoch (ms) - ms do boot; escrito no contexto do lwIP pelo SNTP (lido
+// pelo net_io_call: lá dentro os dois campos mudam juntos)
+static int64_t               g_epoch_off_ms = 0;
+static bool                  g_epoch_ok = false;
+
+// estatística (log a cada snapshot completo)
+static uint32_t g_st_pub = 0, g_st_full = 0, g_st_keys = 0, g_st_bytes = 0;
+static uint32_t g_st_lotes = 0, g_st_lote_regs = 0, g_st_lote_bytes = 0, g_st_lote_reenvios = 0;
+static volatile uint32_t g_st_rec_drop = 0;
+// tempo do publish: chamada (pedido ao dono do lwIP -> enfileirado no TCP)
+// e publish -> PUBACK (QoS 1, medido no callback)
+static uint32_t g_st_call_n = 0, g_st_call_us = 0, g_st_call_max_us = 0;
+static volatile uint32_t g_st_ack_n = 0, g_st_ack_us = 0, g_st_ack_max_us = 0;
+
 static char g_active_user[16] = "";   // vindo do TB (atributo)
 static volatile bool g_have_user = false;
 
@@ -43,6 +85,143 @@ static uint32_t clamp_u32(uint32_t v, uint32_t a, uint32_t b) {
     return v;
 }
 
+// --------------------------
+// Chamadas ao lwIP: rodam no dono dele (net_io.h)
+// --------------------------
+typedef struct {
+    const char        *topic;
+    const void        *payload;
+    u16_t              len;
+    u8_t               qos;
+    mqtt_request_cb_t  cb;
+    err_t              err;
+} mqtt_pub_req_t;
+
+static void mqtt_pub_fn(void *arg) {
+    mqtt_pub_req_t *r = (mqtt_pub_req_t *)arg;
+    r->err = mqtt_publish(g_state.mqtt_client, r->topic, r->payload, r->len, r->qos, 0, r->cb, &g_state);
+}
+
+// O payload é copiado para o anel do MQTT (MQTT_OUTPUT_RINGBUF_SIZE) antes
+// de voltar: o buffer do chamador pode ser reusado em seguida
+static err_t mqtt_pub(const char *topic, const void *payload, u16_t len, u8_t qos, mqtt_request_cb_t cb) {
+    mqtt_pub_req_t r = { topic, payload, len, qos, cb, ERR_MEM };
+
+    uint32_t t0 = time_us_32();
+    if (!net_io_call(mqtt_pub_fn, &r)) return ERR_MEM;
+    uint32_t dt = time_us_32() - t0;
+    g_st_call_n++;
+    g_st_call_us += dt;
+    if (dt > g_st_call_max_us) g_st_call_max_us = dt;
+    return r.err;
+}
+
+// PUBACK (contexto do lwIP)
+static void mqtt_ack_medir(uint32_t t0_us) {
+    uint32_t dt = time_us_32() - t0_us;
+    g_st_ack_n++;
+    g_st_ack_us += dt;
+    if (dt > g_st_ack_max_us) g_st_ack_max_us = dt;
+}
+
+// --------------------------
+// Snapshot da telemetria
+// --------------------------
+// Abre o valor da próxima chave; tele_put_end() fecha (null se não coube)
+static bool tele_put_begin(tele_snapshot_t *t, const char *key, jw_t *w) {
+    if (!t || t->n >= TELE_MAX_KEYS) return false;
+    t->key[t->n] = key;
+    jw_init(w, t->val[t->n], TELE_VAL_MAX);
+    return true;
+}
+
+static void tele_put_end(tele_snapshot_t *t, jw_t *w) {
+    if (jw_finish(w) == 0) strcpy(t->val[t->n], "null");
+    t->n++;
+}
+
+void tele_put_str(tele_snapshot_t *t, const char *key, const char *s) {
+    jw_t w;
+    if (!tele_put_begin(t, key, &w)) return;
+    jw_str(&w, s ? s : "");
+    tele_put_end(t, &w);
+}
+
+void tele_put_u32(tele_snapshot_t *t, const char *key, uint32_t v) {
+    jw_t w;
+    if (!tele_put_begin(t, key, &w)) return;
+    jw_u32(&w, v);
+    tele_put_end(t, &w);
+}
+
+void tele_put_i32(tele_snapshot_t *t, const char *key, int32_t v) {
+    jw_t w;
+    if (!tele_put_begin(t, key, &w)) return;
+    jw_i32(&w, v);
+    tele_put_end(t, &w);
+}
+
+void tele_put_fix(tele_snapshot_t *t, const char *key, float v, uint8_t casas) {
+    jw_t w;
+    if (!tele_put_begin(t, key, &w)) return;
+    jw_fix(&w, v, casas);
+    tele_put_end(t, &w);
+}
+
+static uint32_t tele_hash(const char *v) {
+    uint32_t h = 2166136261u;
+    while (*v) { h ^= (uint8_t)*v++; h *= 16777619u; }
+    return h;
+}
+
+void mqtt_telemetry_changed(void) {
+    if (g_tele_kick_ms == 0) g_tele_kick_ms = now_ms() | 1u;
+}
+
+void mqtt_telemetry_init(void) {
+    if (g_rec_mb) return;
+    g_rec_mb = xMessageBufferCreateStatic(TELE_REC_MB_BYTES, g_rec_mb_store, &g_rec_mb_buf);
+    g_rec_mtx = xSemaphoreCreateMutexStatic(&g_rec_mtx_buf);
+}
+
+// Registro: u32 ms do boot + {"chave":valor,...} (o ts em epoch só é
+// posto na hora do lote, quando o SNTP já respondeu)
+bool mqtt_telemetry_record(const tele_snapshot_t *t) {
+    if (!g_rec_mb || !t) return false;
+
+    uint8_t rec[4 + TELE_REC_MAX + 1];
+
+    jw_t w;
+    jw_init(&w, (char *)&rec[4], sizeof(rec) - 4);
+    jw_obj_begin(&w);
+    for (uint8_t i = 0; i < t->n; i++) {
+        jw_key(&w, t->key[i]);
+        jw_raw(&w, t->val[i], strlen(t->val[i]));
+    }
+    jw_obj_end(&w);
+
+    size_t len = 4 + jw_finish(&w);
+    size_t env = 0;
+    if (len > 4) {
+        xSemaphoreTake(g_rec_mtx, portMAX_DELAY);   // segurado só pela cópia
+        uint32_t ms = now_ms();                      // aqui dentro: ms crescente no buffer
+        memcpy(rec, &ms, 4);
+        env = xMessageBufferSend(g_rec_mb, rec, len, 0);
+        xSemaphoreGive(g_rec_mtx);
+    }
+    if (env != len) {
+        g_st_rec_drop++;
+        return false;
+    }
+    return true;
+}
+
+void mqtt_sntp_set_time(uint32_t sec, uint32_t us) {
+    g_epoch_off_ms = (int64_t)sec * 1000 + us / 1000 - (int64_t)now_ms();
+    if (!g_epoch_ok) DEBUG_printf("[SNTP] horário: %lu\n", (unsigned long)sec);
+    g_epoch_ok = true;
+}
+
 // --------------------------
 // MQTT callbacks
 // --------------------------
@@ -101,7 +280,7 @@ static void mqtt_request_active_user(void) {
 
     if (!g_state.connected) return;
 
-    err_t e = mqtt_publish(g_state.mqtt_client, topic, payload, (u16_t)strlen(payload), 0, 0, NULL, NULL);
+    err_t e = mqtt_pub(topic, payload, (u16_t)strlen(payload), 0, NULL);
     DEBUG_printf("[MQTT] attr req -> %s (e=%d)\n", topic, (int)e);
 }
 
@@ -114,6 +293,7 @@ static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection
     if (status == MQTT_CONNECT_ACCEPTED) {
         s->connected = true;
         s->backoff_ms = MQTT_RECONNECT_MIN_MS;
+        s->last_full_ms = 0;   // snapshot completo logo depois de conectar
         DEBUG_printf("[MQTT] conectado (ACCEPTED)\n");
 
         mqtt_set_inpub_callback(client, mqtt_incoming_publish_cb, mqtt_incoming_data_cb, s);
@@ -148,6 +328,49 @@ static void dns_found_cb(const char *name, const ip_addr_t *ipaddr, void *callba
 // --------------------------
 // Conexão/reconexão
 // --------------------------
+typedef struct {
+    MQTT_CLIENT_T *s;
+    const struct mqtt_connect_client_info_t *ci;
+    err_t err;
+} mqtt_conn_req_t;
+
+static void mqtt_dns_fn(void *arg) {
+    MQTT_CLIENT_T *s = (MQTT_CLIENT_T *)arg;
+    dns_gethostbyname(MQTT_SERVER_HOST, &s->remote_addr, dns_found_cb, s);
+}
+
+static void mqtt_connect_fn(void *arg) {
+    mqtt_conn_req_t *r = (mqtt_conn_req_t *)arg;
+    r->err = mqtt_client_connect(r->s->mqtt_client, &r->s->remote_addr, MQTT_SERVER_PORT,
+                                 mqtt_connection_cb, r->s, r->ci);
+}
+
+static void mqtt_disconnect_fn(void *arg) {
+    mqtt_disconnect((mqtt_client_t *)arg);   // não chama o mqtt_connection_cb
+}
+
+static void mqtt_client_new_fn(void *arg) {
+    *(mqtt_client_t **)arg = mqtt_client_new();
+}
+
+static void mqtt_sntp_fn(void *arg) {
+    (void)arg;
+    sntp_setoperatingmode(SNTP_OPMODE_POLL);
+    sntp_setservername(0, TELE_SNTP_SERVER);
+    sntp_init();
+}
+
+typedef struct {
+    int64_t off_ms;
+    bool    ok;
+} mqtt_epoch_t;
+
+static void mqtt_epoch_fn(void *arg) {
+    mqtt_epoch_t *e = (mqtt_epoch_t *)arg;
+    e->off_ms = g_epoch_off_ms;
+    e->ok = g_epoch_ok;
+}
+
 static void mqtt_try_connect(MQTT_CLIENT_T *s, const char *client_id) {
     if (!s || s->connecting || s->connected) return;
 
@@ -156,10 +379,7 @@ static void mqtt_try_connect(MQTT_CLIENT_T *s, const char *client_id) {
     if (s->last_dns_ms == 0 || (t - s->last_dns_ms) > DNS_REFRESH_MS) {
         s->last_dns_ms = t;
         DEBUG_printf("[DNS] resolvendo %s...\n", MQTT_SERVER_HOST);
-
-        cyw43_arch_lwip_begin();
-        dns_gethostbyname(MQTT_SERVER_HOST, &s->remote_addr, dns_found_cb, s);
-        cyw43_arch_lwip_end();
+        (void)net_io_call(mqtt_dns_fn, s);
     }
 
     // tenta conectar
@@ -173,10 +393,9 @@ static void mqtt_try_connect(MQTT_CLIENT_T *s, const char *client_id) {
 
     DEBUG_printf("[MQTT] tentando conectar %s:%d...\n", ipaddr_ntoa(&s->remote_addr), MQTT_SERVER_PORT);
 
-    cyw43_arch_lwip_begin();
-    err_t e = mqtt_client_connect(s->mqtt_client, &s->remote_addr, MQTT_SERVER_PORT,
-                                 mqtt_connection_cb, s, &ci);
-    cyw43_arch_lwip_end();
+    mqtt_conn_req_t r = { s, &ci, ERR_MEM };
+    (void)net_io_call(mqtt_connect_fn, &r);
+    err_t e = r.err;
 
     if (e != ERR_OK) {
         s->connecting = false;
@@ -187,23 +406,149 @@ static void mqtt_try_connect(MQTT_CLIENT_T *s, const char *client_id) {
     }
 }
 
-static void mqtt_publish_telemetry(MQTT_CLIENT_T *s) {
-    if (!s || !s->connected || !g_get_data_cb) return;
+// PUBACK do publish de telemetria (contexto do lwIP: só marca)
+static void mqtt_telemetry_pub_cb(void *arg, err_t err) {
+    MQTT_CLIENT_T *s = (MQTT_CLIENT_T *)arg;
+    if (err == ERR_OK) mqtt_ack_medir(s->pub_t0_us);
+    s->pub_err = err;
+    s->pub_done = true;
+}
+
+// Publica as chaves que mudaram desde o último PUBACK (todas se full).
+// Retorna true se algo foi para o ar.
+static bool mqtt_publish_telemetry(MQTT_CLIENT_T *s, bool full) {
+    if (!s || !s->connected || !g_get_data_cb) return false;
+
+    g_tele.n = 0;
+    g_get_data_cb(&g_tele);
 
     char buf[BUFFER_SIZE];
-    memset(buf, 0, sizeof(buf));
-    g_get_data_cb(buf, sizeof(buf));
+    uint32_t mask = 0;
+    bool cortado = false;
+
+    jw_t w;
+    jw_init(&w, buf, sizeof(buf) - 1);   // 1 byte guardado para o '}'
+    jw_obj_begin(&w);
+    for (uint8_t i = 0; i < g_tele.n; i++) {
+        uint32_t h = tele_hash(g_tele.val[i]);
+        g_tele_sent[i] = h;
+        if (!full && (g_tele_acked_mask & (1u << i)) && g_tele_acked[i] == h) continue;
+
+        jw_t salvo = w;
+        jw_key(&w, g_tele.key[i]);
+        jw_raw(&w, g_tele.val[i], strlen(g_tele.val[i]));
+        if (w.err) { w = salvo; cortado = true; break; }
+        mask |= 1u << i;
+    }
+    if (cortado) mqtt_telemetry_changed();   // o resto vai no próximo
+    if (mask == 0) return false;             // nada mudou
+    w.cap++;
+    jw_obj_end(&w);
+    size_t len = jw_finish(&w);
 
-    if (buf[0] == '\0') return;
+    s->pub_done = false;
+    s->pub_t0_us = time_us_32();
+    err_t e = mqtt_pub(s->publish_topic, buf, (u16_t)len, 1, mqtt_telemetry_pub_cb);
 
-    err_t e = mqtt_publish(s->mqtt_client, s->publish_topic, buf, (u16_t)strlen(buf), 0, 0, NULL, NULL);
     if (e != ERR_OK) {
+        mqtt_telemetry_changed();   // tenta de novo depois
         uint32_t t = now_ms();
         if (s->last_pub_err_ms == 0 || (t - s->last_pub_err_ms) > 2000) {
             s->last_pub_err_ms = t;
             DEBUG_printf("[MQTT] publish err=%d\n", (int)e);
         }
+        return false;
     }
+
+    s->pub_inflight = true;
+    g_tele_sent_mask = mask;
+    g_st_pub++;
+    g_st_keys += (uint32_t)__builtin_popcount(mask);
+    g_st_bytes += (uint32_t)len;
+    if (full) g_st_full++;
+    return true;
+}
+
+// --------------------------
+// Lotes com horário
+// --------------------------
+static void mqtt_batch_pub_cb(void *arg, err_t err) {
+    MQTT_CLIENT_T *s = (MQTT_CLIENT_T *)arg;
+    if (err == ERR_OK) mqtt_ack_medir(s->batch_t0_us);
+    s->batch_err = err;
+    s->batch_done = true;
+}
+
+// Monta o lote com o que chegou e publica quando encher ou vencer o prazo.
+// Um lote em voo por vez; os registros novos esperam no message buffer.
+static void mqtt_batch_pump(MQTT_CLIENT_T *s, uint32_t t) {
+    if (s->batch_inflight) {
+        if (!s->batch_done && s->connected) return;
+        s->batch_inflight = false;
+
+        if (s->batch_done && s->batch_err == ERR_OK) {
+            g_st_lotes++;
+            g_st_lote_regs += g_batch.n;
+            g_st_lote_bytes += (uint32_t)g_batch.w.len + 1;
+            tele_batch_clear(&g_batch);
+        } else {
+            g_st_lote_reenvios++;   // desconectou ou sem PUBACK: o mesmo lote de novo
+        }
+    }
+    if (!g_rec_mb) return;
+    if (g_rec_len == 0 && g_batch.n == 0 && xMessageBufferIsEmpty(g_rec_mb)) return;   // nada: nem pergunta o horário
+
+    mqtt_epoch_t ep = { 0, false };
+    (void)net_io_call(mqtt_epoch_fn, &ep);
+    if (!ep.ok) return;   // sem horário ainda: os registros esperam
+
+    bool cheio = false;
+    for (;;) {
+        if (g_rec_len == 0) {
+            g_rec_len = xMessageBufferReceive(g_rec_mb, g_rec, sizeof(g_rec), 0);
+            if (g_rec_len == 0) break;
+        }
+        if (!tele_batch_add(&g_batch, g_rec, g_rec_len, ep.off_ms)) { cheio = true; break; }
+        g_rec_len = 0;
+    }
+
+    if (!s->connected || !tele_batch_due(&g_batch, cheio, t)) return;
+
+    size_t len = tele_batch_close(&g_batch);
+    s->batch_done = false;
+    s->batch_t0_us = time_us_32();
+    err_t e = mqtt_pub(s->publish_topic, g_batch.buf, (u16_t)len, 1, mqtt_batch_pub_cb);
+
+    if (e != ERR_OK) {
+        if (s->last_pub_err_ms == 0 || (t - s->last_pub_err_ms) > 2000) {
+            s->last_pub_err_ms = t;
+            DEBUG_printf("[MQTT] lote err=%d (%u registros)\n", (int)e, (unsigned)g_batch.n);
+        }
+        return;   // tenta de novo na próxima volta
+    }
+    s->batch_inflight = true;
+}
+
+// Resultado do publish em voo: confirmado = vira a nova referência do delta
+static void mqtt_telemetry_settle(MQTT_CLIENT_T *s) {
+    if (!s->pub_inflight) return;
+
+    if (!s->connected) {
+        // a desconexão descarta o pedido sem chamar o callback
+        s->pub_inflight = false;
+        return;
+    }
+    if (!s->pub_done) return;
+
+    s->pub_inflight = false;
+    if (s->pub_err != ERR_OK) {
+        mqtt_telemetry_changed();   // as chaves continuam diferentes do confirmado
+        return;
+    }
+    for (uint8_t i = 0; i < TELE_MAX_KEYS; i++) {
+        if (g_tele_sent_mask & (1u << i)) g_tele_acked[i] = g_tele_sent[i];
+    }
+    g_tele_acked_mask |= g_tele_sent_mask;
 }
 
 // --------------------------
@@ -216,7 +561,7 @@ void mqtt_start_application(const char *publish_topic,
     g_state.publish_topic = publish_topic;
     g_get_data_cb = get_data_cb;
 
-    g_state.mqtt_client = mqtt_client_new();
+    (void)net_io_call(mqtt_client_new_fn, &g_state.mqtt_client);
     if (!g_state.mqtt_client) {
         DEBUG_printf("[MQTT] ERRO: mqtt_client_new falhou\n");
         return;
@@ -225,22 +570,75 @@ void mqtt_start_application(const char *publish_topic,
     g_state.backoff_ms = MQTT_RECONNECT_MIN_MS;
     g_state.next_reconnect_ms = 0;
 
+    // horário para os lotes (1ª consulta logo, depois a cada SNTP_UPDATE_DELAY)
+    (void)net_io_call(mqtt_sntp_fn, NULL);
+
     // loop principal (roda dentro da sua task)
+    bool link_ant = true;
     for (;;) {
         uint32_t t = now_ms();
 
-        if (!g_state.connected && !g_state.connecting) {
+        // link Wi-Fi (net_sup.h): caiu = fecha já, sem esperar o keepalive
+        // estourar; voltou = reconecta na hora e resolve o DNS de novo
+        bool link = net_sup_is_up();
+        if (link != link_ant) {
+            link_ant = link;
+            if (link) {
+                g_state.backoff_ms = MQTT_RECONNECT_MIN_MS;
+                g_state.next_reconnect_ms = 0;
+                g_state.last_dns_ms = 0;
+            } else if (g_state.connected || g_state.connecting) {
+                (void)net_io_call(mqtt_disconnect_fn, g_state.mqtt_client);
+                g_state.connected = false;
+                g_state.connecting = false;
+                DEBUG_printf("[MQTT] link caiu: desconectado\n");
+            }
+        }
+
+        if (link && !g_state.connected && !g_state.connecting) {
             if (g_state.next_reconnect_ms == 0 || t >= g_state.next_reconnect_ms) {
                 mqtt_try_connect(&g_state, client_id);
             }
         }
 
-        if (g_state.connected) {
-            // publica telemetria
-            if (t - g_state.last_publish_ms >= PUB_DELAY_MS) {
-                g_state.last_publish_ms = t;
-                mqtt_publish_telemetry(&g_state);
+        mqtt_telemetry_settle(&g_state);
+        mqtt_batch_pump(&g_state, t);
+
+        if (g_state.connected && !g_state.pub_inflight) {
+            // snapshot completo periódico / delta das mudanças, um por vez
+            uint32_t kick = g_tele_kick_ms;
+            bool full = (g_state.last_full_ms == 0) || (t - g_state.last_full_ms >= TELE_FULL_MS);
+            bool delta = (kick != 0) && (t - kick >= TELE_COALESCE_MS);
+
+            if (full || delta) {
+                g_tele_kick_ms = 0;
+                if (full) {
+                    g_state.last_full_ms = t;
+                    if (g_st_pub || g_st_lotes) {
+                        DEBUG_printf("[MQTT] telemetria: %lu publishes (%lu completos), %lu chaves, %lu B | lotes: %lu (%lu registros, %lu B, %lu reenvios), descartados %lu\n",
+                                     (unsigned long)g_st_pub, (unsigned long)g_st_full,
+                                     (unsigned long)g_st_keys, (unsigned long)g_st_bytes,
+                                     (unsigned long)g_st_lotes, (unsigned long)g_st_lote_regs,
+                                     (unsigned long)g_st_lote_bytes, (unsigned long)g_st_lote_reenvios,
+                                     (unsigned long)g_st_rec_drop);
+                    }
+                    if (g_st_call_n) {
+                        uint32_t ack_n = g_st_ack_n;
+                        DEBUG_printf("[MQTT] publish: chamada med %lu / máx %lu us | PUBACK med %lu / máx %lu ms\n",
+                                     (unsigned long)(g_st_call_us / g_st_call_n), (unsigned long)g_st_call_max_us,
+                                     (unsigned long)(ack_n ? g_st_ack_us / ack_n / 1000u : 0),
+                                     (unsigned long)(g_st_ack_max_us / 1000u));
+                    }
+                    g_st_pub = g_st_full = g_st_keys = g_st_bytes = 0;
+                    g_st_lotes = g_st_lote_regs = g_st_lote_bytes = g_st_lote_reenvios = 0;
+                    g_st_call_n = g_st_call_us = g_st_call_max_us = 0;
+                    g_st_ack_n = g_st_ack_us = g_st_ack_max_us = 0;
+                }
+                if (mqtt_publish_telemetry(&g_state, full)) g_state.last_publish_ms = t;
             }
+        }
+
+        if (g_state.connected) {
 
             // re-request active_user a cada 20s se ainda não chegou
             if (!g_have_user) {
@@ -15,6 +15,9 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "message_buffer.h"
+
+#include "tele_batch.h"
 
 // Debug (se quiser silenciar: #define DEBUG_printf(...) ((void)0))
 #define DEBUG_printf printf
@@ -22,12 +25,38 @@
 // ==========================
 // ThingsBoard Cloud MQTT
 // ==========================
+// (secrets.h pode apontar para o cubo_serve/mqtt_stub.py: IP do PC e 1883)
+#ifndef MQTT_SERVER_HOST
 #define MQTT_SERVER_HOST "mqtt.thingsboard.cloud"
+#endif
+#ifndef MQTT_SERVER_PORT
 #define MQTT_SERVER_PORT 1883
-
-// Telemetria
-#define BUFFER_SIZE   512
-#define PUB_DELAY_MS  5000
+#endif
+
+// Telemetria por mudança: o jogo chama mqtt_telemetry_changed() no fim da
+// rodada, na troca de modo e no start/stop; o publish sai TELE_COALESCE_MS
+// depois (junta o que muda na mesma volta do laço) só com as chaves que
+// mudaram desde o último publish confirmado (QoS 1, PUBACK). A cada
+// TELE_FULL_MS, e logo depois de (re)conectar, vai o snapshot inteiro.
+#define BUFFER_SIZE        512
+#define TELE_COALESCE_MS   250
+#define TELE_FULL_MS     60000
+#define TELE_MAX_KEYS       20   // <= 32 (máscara u32)
+#define TELE_VAL_MAX        32   // valor já em JSON: número ou "texto"
+
+// Lotes com horário (resultado de cada rodada + resumo do mic, e o link
+// Wi-Fi caindo/voltando): a GameTask e a NetSup chamam
+// mqtt_telemetry_record(), que guarda o registro (ms do boot + as
+// chaves) num message buffer. O MQTT junta vários num só publish no
+// formato do ThingsBoard [{"ts":..,"values":{..}},..], de até
+// TELE_BATCH_MAX bytes (cabe num segmento TCP), quando o próximo não cabe
+// ou TELE_BATCH_MS depois do primeiro (tele_batch.h). ts é epoch em ms,
+// pelo SNTP: sem horário os registros esperam no buffer (cheio = descarta
+// e conta).
+#define TELE_REC_MB_BYTES  2048   // ~8 registros de rodada
+#ifndef TELE_SNTP_SERVER
+#define TELE_SNTP_SERVER   "pool.ntp.org"
+#endif
 
 // Reconexão
 #define MQTT_KEEPALIVE_S         30
@@ -49,8 +78,17 @@ typedef struct MQTT_CLIENT_T {
     volatile bool   connected;     // true só quando ACCEPTED
     volatile bool   connecting;    // true enquanto handshake acontece
     volatile bool   pub_inflight;  // true quando já tem publish pendente
+    volatile bool   pub_done;      // PUBACK (ou erro) chegou, pub_err diz qual
+    volatile err_t  pub_err;
+    uint32_t        pub_t0_us;     // hora do publish (latência até o PUBACK)
+
+    volatile bool   batch_inflight;  // mesmo esquema, para o lote com horário
+    volatile bool   batch_done;
+    volatile err_t  batch_err;
+    uint32_t        batch_t0_us;
 
     uint32_t        last_publish_ms;
+    uint32_t        last_full_ms;
     uint32_t        next_reconnect_ms;
     uint32_t        backoff_ms;
     uint32_t        last_dns_ms;
@@ -59,13 +97,41 @@ typedef struct MQTT_CLIENT_T {
     uint32_t        last_pub_err_ms; // evita spam de log
 } MQTT_CLIENT_T;
 
-typedef void (*GetDataCallback)(char *buffer, size_t buffer_size);
+// Snapshot da telemetria: o callback preenche com tele_put_*(), sempre as
+// mesmas chaves na mesma ordem (a posição identifica a chave no delta).
+// Valores já em JSON, pelo json_writer.h (sem printf/%f)
+typedef struct {
+    uint8_t     n;
+    const char *key[TELE_MAX_KEYS];
+    char        val[TELE_MAX_KEYS][TELE_VAL_MAX];
+} tele_snapshot_t;
+
+typedef void (*GetDataCallback)(tele_snapshot_t *t);
+
+// Acrescenta uma chave (key: literal, guardado por ponteiro)
+void tele_put_str(tele_snapshot_t *t, const char *key, const char *s);
+void tele_put_u32(tele_snapshot_t *t, const char *key, uint32_t v);
+void tele_put_i32(tele_snapshot_t *t, const char *key, int32_t v);
+void tele_put_fix(tele_snapshot_t *t, const char *key, float v, uint8_t casas);
 
 // API principal: essa função roda um loop interno (não retorna)
 void mqtt_start_application(const char *publish_topic,
                             const char *client_id,
                             GetDataCallback get_data_cb);
 
+// Cria o buffer dos registros (chamar antes do scheduler)
+void mqtt_telemetry_init(void);
+
+// Algo da telemetria mudou (chamado pela GameTask; só marca)
+void mqtt_telemetry_changed(void);
+
+// Registro com o horário de agora, para o próximo lote (GameTask e
+// NetSup). false = buffer cheio (descartado e contado)
+bool mqtt_telemetry_record(const tele_snapshot_t *t);
+
+// Horário do SNTP (lwipopts.h: SNTP_SET_SYSTEM_TIME_US; contexto do lwIP)
+void mqtt_sntp_set_time(uint32_t sec, uint32_t us);
+
 // Lê active_user recebido do ThingsBoard
 bool mqtt_get_active_user(char *out, size_t out_sz);
 
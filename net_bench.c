@@ -0,0 +1,119 @@
+#include "net_bench.h"
+
+#if defined(NET_BENCH) && NET_BENCH
+
+#include <stdio.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "lwip/pbuf.h"
+#include "lwip/udp.h"
+#include "lwip/ip_addr.h"
+
+#include "net_io.h"
+#include "secrets.h"
+
+#define NB_REPS       500
+#define NB_PORTA      9      // discard: o servidor não precisa ouvir
+#define NB_MAX_BYTES  1472   // 1 quadro Ethernet sem fragmentar
+
+static struct udp_pcb *nb_pcb = NULL;
+static ip_addr_t       nb_dst;
+static uint8_t         nb_dados[NB_MAX_BYTES];
+
+typedef struct {
+    uint16_t len;
+    err_t    err;
+} nb_envio_t;
+
+static void nb_vazio_fn(void *arg) {
+    (void)arg;
+}
+
+static void nb_abrir_fn(void *arg) {
+    (void)arg;
+    nb_pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+}
+
+static void nb_fechar_fn(void *arg) {
+    (void)arg;
+    udp_remove(nb_pcb);
+    nb_pcb = NULL;
+}
+
+static void nb_enviar_fn(void *arg) {
+    nb_envio_t *e = (nb_envio_t *)arg;
+    struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, e->len, PBUF_RAM);
+    if (!p) { e->err = ERR_MEM; return; }
+    memcpy(p->payload, nb_dados, e->len);
+    e->err = udp_sendto(nb_pcb, p, &nb_dst, NB_PORTA);
+    pbuf_free(p);
+}
+
+// us por chamada; erros = envios recusados (pbuf/ARP cheio)
+static void nb_medir(const char *nome, net_io_fn_t fn, uint16_t len) {
+    nb_envio_t e = { len, ERR_OK };
+    uint32_t soma = 0, max = 0, erros = 0;
+
+    uint32_t t_ini = time_us_32();
+    for (int i = 0; i < NB_REPS; i++) {
+        uint32_t t0 = time_us_32();
+        bool ok = net_io_call(fn, &e);
+        uint32_t dt = time_us_32() - t0;
+        soma += dt;
+        if (dt > max) max = dt;
+        if (!ok || e.err != ERR_OK) erros++;
+    }
+    uint32_t total = time_us_32() - t_ini;
+    if (total == 0) total = 1;
+
+    uint32_t ok_n = NB_REPS - erros;
+    printf("[NETB] %-10s %7u %7u %9lu %9lu %6lu\n", nome,
+           (unsigned)(soma / NB_REPS), (unsigned)max,
+           (unsigned long)((uint64_t)ok_n * 1000000u / total),
+           (unsigned long)((uint64_t)ok_n * len * 1000000u / 1024u / total),
+           (unsigned long)erros);
+}
+
+void net_bench_run(void)
+{
+    if (!ipaddr_aton(LOCAL_SERVER_IP, &nb_dst)) {
+        printf("[NETB] LOCAL_SERVER_IP inválido; benchmark não roda\n");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(nb_dados); i++) nb_dados[i] = (uint8_t)i;
+
+    (void)net_io_call(nb_abrir_fn, NULL);
+    if (!nb_pcb) {
+        printf("[NETB] udp_new falhou\n");
+        return;
+    }
+
+#if NO_SYS
+    const char *modo = "NO_SYS (lock do cyw43)";
+#else
+    const char *modo = "tcpip_thread (sys_arch)";
+#endif
+    printf("[NETB] lwIP %s, %d chamadas por caso\n", modo, NB_REPS);
+    printf("[NETB] %-10s %7s %7s %9s %9s %6s\n", "caso", "us med", "us max", "pacotes/s", "KB/s", "erros");
+
+    net_io_stats_t st;
+    net_io_get_stats(&st, true);
+
+    nb_medir("vazio", nb_vazio_fn, 0);
+    nb_medir("udp 64", nb_enviar_fn, 64);
+    nb_medir("udp 512", nb_enviar_fn, 512);
+    nb_medir("udp 1472", nb_enviar_fn, NB_MAX_BYTES);
+
+    net_io_get_stats(&st, false);
+    printf("[NETB] net_io: %lu chamadas, %lu com a fila cheia, máx %lu us\n",
+           (unsigned long)st.n, (unsigned long)st.cheio, (unsigned long)st.max_us);
+
+    (void)net_io_call(nb_fechar_fn, NULL);
+}
+
+#endif // NET_BENCH
@@ -0,0 +1,22 @@
+#ifndef NET_BENCH_H
+#define NET_BENCH_H
+
+// =========================
+// Benchmark no alvo da pilha de rede (net_io.h)
+// =========================
+// Quando o link sobe a 1ª vez (MQTTTask, antes do MQTT), mede:
+//  - vazio: net_io_call de uma função que não faz nada (custo de chegar
+//    ao dono do lwIP: fila + troca de task, ou só o lock no NO_SYS);
+//  - udp N B: rajada de udp_sendto para o LOCAL_SERVER_IP, porta 9
+//    (discard), com pbuf novo a cada envio; us por chamada (médio/máximo),
+//    datagramas/s e KB/s.
+// Compilar duas vezes (LWIP_SYS_FREERTOS=ON e OFF) dá o antes/depois;
+// o jitter do jogo durante a rajada sai na linha [CPU] da Health.
+//
+// Só existe com NET_BENCH=1 (opção do CMake).
+
+#if defined(NET_BENCH) && NET_BENCH
+void net_bench_run(void);
+#endif
+
+#endif
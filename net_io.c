@@ -0,0 +1,118 @@
+#include "net_io.h"
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+
+#include "lwip/opt.h"
+#if !NO_SYS
+#include "lwip/tcpip.h"
+#endif
+
+#define NET_IO_CORES  (1u << 0)   // rede no core 0 (o core 1 é do DSP)
+
+static volatile net_io_stats_t g_st;
+
+static void net_io_medir(uint32_t t0, bool cheio) {
+    uint32_t dt = time_us_32() - t0;
+    taskENTER_CRITICAL();
+    if (cheio) {
+        g_st.cheio++;
+    } else {
+        g_st.n++;
+        g_st.soma_us += dt;
+        if (dt > g_st.max_us) g_st.max_us = dt;
+    }
+    taskEXIT_CRITICAL();
+}
+
+#if !NO_SYS
+// ============================
+// lwIP com sys_arch: pedido na fila da tcpip_thread
+// ============================
+// índice próprio da notificação: o índice 0 é das tasks (lr_udp acorda por ele)
+#define NET_IO_NOTIFY_IDX 1
+#if configTASK_NOTIFICATION_ARRAY_ENTRIES < 2
+#error "net_io.c precisa de configTASK_NOTIFICATION_ARRAY_ENTRIES >= 2"
+#endif
+
+typedef struct {
+    net_io_fn_t  fn;
+    void        *arg;
+    TaskHandle_t quem;
+} net_io_req_t;
+
+static TaskHandle_t g_dono = NULL;   // a tcpip_thread
+
+// roda na tcpip_thread
+static void net_io_run(void *p) {
+    net_io_req_t *r = (net_io_req_t *)p;
+    r->fn(r->arg);
+    xTaskNotifyGiveIndexed(r->quem, NET_IO_NOTIFY_IDX);
+}
+
+static void net_io_dono(void *arg) {
+    (void)arg;
+    g_dono = xTaskGetCurrentTaskHandle();
+    vTaskCoreAffinitySet(g_dono, NET_IO_CORES);
+}
+
+void net_io_init(void) {
+    if (!g_dono) net_io_call(net_io_dono, NULL);
+}
+
+TaskHandle_t net_io_task_handle(void) {
+    return g_dono;
+}
+
+bool net_io_call(net_io_fn_t fn, void *arg) {
+    TaskHandle_t eu = xTaskGetCurrentTaskHandle();
+    if (eu == g_dono) {   // já é a dona (callback do lwIP)
+        fn(arg);
+        return true;
+    }
+
+    uint32_t t0 = time_us_32();
+    net_io_req_t r = { fn, arg, eu };   // na pilha: só sai daqui depois da resposta
+    if (tcpip_try_callback(net_io_run, &r) != ERR_OK) {
+        net_io_medir(t0, true);
+        return false;
+    }
+    (void)ulTaskNotifyTakeIndexed(NET_IO_NOTIFY_IDX, pdTRUE, portMAX_DELAY);
+    net_io_medir(t0, false);
+    return true;
+}
+
+#else
+// ============================
+// NO_SYS (threadsafe_background): na hora, com o lock do cyw43
+// ============================
+void net_io_init(void) {
+}
+
+TaskHandle_t net_io_task_handle(void) {
+    return NULL;
+}
+
+bool net_io_call(net_io_fn_t fn, void *arg) {
+    uint32_t t0 = time_us_32();
+    cyw43_arch_lwip_begin();
+    fn(arg);
+    cyw43_arch_lwip_end();
+    net_io_medir(t0, false);
+    return true;
+}
+#endif
+
+void net_io_get_stats(net_io_stats_t *out, bool zerar) {
+    taskENTER_CRITICAL();
+    out->n = g_st.n;
+    out->cheio = g_st.cheio;
+    out->soma_us = g_st.soma_us;
+    out->max_us = g_st.max_us;
+    if (zerar) {
+        g_st.n = g_st.cheio = 0;
+        g_st.soma_us = 0;
+        g_st.max_us = 0;
+    }
+    taskEXIT_CRITICAL();
+}
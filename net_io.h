@@ -0,0 +1,53 @@
+#ifndef NET_IO_H
+#define NET_IO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+// =====================================================
+// NET_IO - toda chamada ao lwIP passa por aqui
+// =====================================================
+//
+// Com LWIP_SYS_FREERTOS (padrão, pico_cyw43_arch_lwip_sys_freertos,
+// NO_SYS 0) o lwIP tem uma task só dele, a tcpip_thread: ela recebe os
+// quadros do cyw43, roda os timers e os callbacks (ACK do local_report,
+// PUBACK/CONNACK do MQTT, SNTP) e é a única que mexe no lwIP.
+// net_io_call() põe o pedido na fila dela (tcpip_callback, mensagem do
+// pool estático do lwIP) e espera terminar: a função roda lá, com acesso
+// exclusivo, e os buffers do chamador (o lote do local_report, o payload do
+// MQTT) podem ser reusados logo depois.
+//
+// Sem a opção (threadsafe_background, NO_SYS 1, o jeito antigo) a função
+// roda na hora, entre cyw43_arch_lwip_begin/end, com a mesma medição:
+// as duas builds dão o antes/depois (net_bench.h).
+//
+// Chamado de dentro da tcpip_thread (num callback), roda direto.
+// =====================================================
+
+typedef void (*net_io_fn_t)(void *arg);
+
+// Depois do cyw43_arch_init (NetSup): descobre a tcpip_thread e a prende
+// no core da rede
+void net_io_init(void);
+
+// Roda fn(arg) na dona do lwIP e espera. false = fila cheia (não rodou)
+bool net_io_call(net_io_fn_t fn, void *arg);
+
+// Pedido -> fim (espera na fila + execução), desde o boot
+typedef struct {
+    uint32_t n;
+    uint32_t cheio;      // fila da tcpip_thread cheia
+    uint64_t soma_us;
+    uint32_t max_us;
+} net_io_stats_t;
+
+// Copia e (opcional) zera as estatísticas
+void net_io_get_stats(net_io_stats_t *out, bool zerar);
+
+// A tcpip_thread (stack no HealthTask); NULL no NO_SYS
+TaskHandle_t net_io_task_handle(void);
+
+#endif // NET_IO_H
@@ -0,0 +1,180 @@
+#include "net_sup.h"
+#include "net_io.h"
+#include "secrets.h"
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+
+#include "lwip/netif.h"
+
+// ============================
+// Config
+// ============================
+#define NET_TASK_STACK   2048   // palavras; até medir o [STACK] NetSup (printf + o callback do link)
+#define NET_TASK_PRIO    (tskIDLE_PRIORITY + 1)   // abaixo do jogo: rede nunca atrasa a rodada
+#define NET_TASK_CORES   (1u << 0)   // o cyw43 prende a IRQ no core que chamou o init
+
+// ============================
+// Estado interno
+// ============================
+static EventGroupHandle_t g_ev = NULL;
+static StaticEventGroup_t g_ev_buf;
+static TaskHandle_t       g_task = NULL;
+static StaticTask_t       g_tcb;
+static StackType_t        g_stack[NET_TASK_STACK];
+
+static net_sup_cb_t       g_cb = NULL;
+static volatile bool      g_up = false;
+static volatile uint32_t  g_quedas = 0;
+
+static inline uint32_t net_now_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+static const char *net_status_str(int st) {
+    switch (st) {
+        case CYW43_LINK_UP:      return "ok";
+        case CYW43_LINK_DOWN:    return "não associou";
+        case CYW43_LINK_JOIN:    return "associado, sem IP";
+        case CYW43_LINK_NOIP:    return "associado, sem IP";
+        case CYW43_LINK_FAIL:    return "falha";
+        case CYW43_LINK_NONET:   return "SSID não encontrado";
+        case CYW43_LINK_BADAUTH: return "senha recusada";
+        default:                 return "erro";
+    }
+}
+
+static int8_t net_rssi(void) {
+    int32_t rssi = 0;
+    if (cyw43_wifi_get_rssi(&cyw43_state, &rssi) != 0) return 0;
+    return (int8_t)((rssi < -128) ? -128 : (rssi > 0) ? 0 : rssi);
+}
+
+static void net_ip_fn(void *arg) {
+    ip4addr_ntoa_r(netif_ip4_addr(netif_default), (char *)arg, IP4ADDR_STRLEN_MAX);
+}
+
+static void net_publicar(const net_sup_ev_t *ev) {
+    if (g_cb) g_cb(ev);
+}
+
+// Uma tentativa: dispara a associação e consulta o link até subir, dar
+// erro ou estourar o prazo (o cyw43 trabalha na IRQ; aqui só se dorme).
+// Retorna o último status (CYW43_LINK_UP = conectado).
+static int net_conectar(void) {
+    int st = cyw43_arch_wifi_connect_async(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK);
+    if (st != 0) return CYW43_LINK_FAIL;
+
+    uint32_t t0 = net_now_ms();
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(NET_POLL_MS));
+        st = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+        if (st == CYW43_LINK_UP || st < 0) return st;
+        if (net_now_ms() - t0 >= NET_CONNECT_TIMEOUT_MS) return st;
+    }
+}
+
+// ============================
+// Task
+// ============================
+static void net_task_fn(void *p) {
+    (void)p;
+
+    printf("[NET] iniciando Wi-Fi...\n");
+    if (cyw43_arch_init()) {
+        printf("[NET] ERRO: cyw43_arch_init falhou; o jogo segue sem rede\n");
+        vTaskDelete(NULL);
+    }
+    net_io_init();
+    cyw43_arch_enable_sta_mode();
+    xEventGroupSetBits(g_ev, NET_SUP_BIT_STACK);
+
+    uint32_t backoff = NET_RETRY_MIN_MS;
+    uint32_t fora_desde = 0;   // boot: conta desde o início
+    uint16_t tentativas = 0;
+
+    for (;;) {
+        // ---- conecta ----
+        tentativas++;
+        printf("[NET] conectando (tentativa %u) SSID=%s\n", (unsigned)tentativas, WIFI_SSID);
+        int st = net_conectar();
+        if (st != CYW43_LINK_UP) {
+            printf("[NET] não conectou (%s, %d); de novo em %lu ms\n",
+                   net_status_str(st), st, (unsigned long)backoff);
+            cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);   // zera o estado do join
+            vTaskDelay(pdMS_TO_TICKS(backoff));
+            backoff = (backoff * 2u > NET_RETRY_MAX_MS) ? NET_RETRY_MAX_MS : backoff * 2u;
+            continue;
+        }
+
+        // ---- subiu ----
+        uint32_t t = net_now_ms();
+        char ip[IP4ADDR_STRLEN_MAX] = "?";
+        (void)net_io_call(net_ip_fn, ip);
+
+        net_sup_ev_t ev = {
+            .up = true,
+            .rssi = net_rssi(),
+            .tentativas = tentativas,
+            .fora_ms = t - fora_desde,
+            .quedas = g_quedas,
+            .status = st,
+        };
+        printf("[NET] conectado: %s, RSSI %d dBm, %lu ms sem rede, %u tentativas\n",
+               ip, (int)ev.rssi, (unsigned long)ev.fora_ms, (unsigned)tentativas);
+        g_up = true;
+        xEventGroupSetBits(g_ev, NET_SUP_BIT_UP);
+        net_publicar(&ev);
+        backoff = NET_RETRY_MIN_MS;
+        tentativas = 0;
+
+        // ---- vigia ----
+        while ((st = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA)) == CYW43_LINK_UP) {
+            vTaskDelay(pdMS_TO_TICKS(NET_WATCH_MS));
+        }
+
+        // ---- caiu ----
+        fora_desde = net_now_ms();
+        g_up = false;
+        g_quedas++;
+        xEventGroupClearBits(g_ev, NET_SUP_BIT_UP);
+        printf("[NET] link caiu (%s, %d) depois de %lu s; reconectando\n",
+               net_status_str(st), st, (unsigned long)((fora_desde - t) / 1000u));
+
+        net_sup_ev_t down = { .up = false, .quedas = g_quedas, .status = st };
+        net_publicar(&down);
+        cyw43_wifi_leave(&cyw43_state, CYW43_ITF_STA);
+    }
+}
+
+// ============================
+// API pública
+// ============================
+void net_sup_init(net_sup_cb_t cb) {
+    if (g_task) return;
+
+    g_cb = cb;
+    g_ev = xEventGroupCreateStatic(&g_ev_buf);
+    g_task = xTaskCreateStaticAffinitySet(net_task_fn, "NetSup", NET_TASK_STACK, NULL, NET_TASK_PRIO,
+                                          g_stack, &g_tcb, NET_TASK_CORES);
+}
+
+bool net_sup_is_up(void) {
+    return g_up;
+}
+
+uint32_t net_sup_quedas(void) {
+    return g_quedas;
+}
+
+bool net_sup_wait(EventBits_t bits, TickType_t espera) {
+    if (!g_ev) return false;
+    EventBits_t b = xEventGroupWaitBits(g_ev, bits, pdFALSE, pdTRUE, espera);
+    return (b & bits) == bits;
+}
+
+TaskHandle_t net_sup_task_handle(void) {
+    return g_task;
+}
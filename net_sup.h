@@ -0,0 +1,63 @@
+#ifndef NET_SUP_H
+#define NET_SUP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+
+// =====================================================
+// NET_SUP - supervisor do Wi-Fi (task NetSup)
+// =====================================================
+//
+// O boot não espera a rede: main() cria as tasks e já inicia o scheduler.
+// A NetSup liga o cyw43 (cyw43_arch_init, que também sobe o lwIP e, com
+// LWIP_SYS_FREERTOS, a tcpip_thread; net_io.h), conecta
+// em segundo plano (cyw43_arch_wifi_connect_async + consulta do link) e
+// depois vigia o link. Falhou ou caiu = tenta de novo com backoff
+// (NET_RETRY_MIN_MS dobrando até NET_RETRY_MAX_MS), para sempre: o jogo
+// roda offline e os eventos esperam na janela/outbox do local_report e no
+// buffer de registros do MQTT.
+//
+// Quem usa lwIP espera NET_SUP_BIT_STACK (antes disso o lwIP nem existe);
+// quem precisa do link consulta net_sup_is_up() ou espera NET_SUP_BIT_UP.
+// Cada mudança do link chama o callback de net_sup_init(), no contexto da
+// NetSup (pode usar fila/buffer; lwIP só pelo net_io_call).
+// =====================================================
+
+#define NET_CONNECT_TIMEOUT_MS  30000
+#define NET_RETRY_MIN_MS         2000
+#define NET_RETRY_MAX_MS        60000
+#define NET_POLL_MS               250   // conectando: consulta do link
+#define NET_WATCH_MS             1000   // conectado: confere se continua
+
+// bits do event group (net_sup_wait)
+#define NET_SUP_BIT_STACK  (1u << 0)   // cyw43/lwIP iniciados
+#define NET_SUP_BIT_UP     (1u << 1)   // associado e com IP
+
+typedef struct {
+    bool     up;
+    int8_t   rssi;         // dBm na hora (0 = sem leitura)
+    uint16_t tentativas;   // subiu: tentativas até conseguir
+    uint32_t fora_ms;      // subiu: tempo sem rede (na 1ª vez, desde o boot)
+    uint32_t quedas;       // desde o boot
+    int      status;       // caiu: cyw43_tcpip_link_status() no momento
+} net_sup_ev_t;
+
+typedef void (*net_sup_cb_t)(const net_sup_ev_t *ev);
+
+// Cria a task (chamar antes do scheduler). cb pode ser NULL.
+void net_sup_init(net_sup_cb_t cb);
+
+bool     net_sup_is_up(void);
+uint32_t net_sup_quedas(void);
+
+// Espera todos os bits (true = chegaram dentro de 'espera')
+bool net_sup_wait(EventBits_t bits, TickType_t espera);
+
+// Debug/stack no HealthTask
+TaskHandle_t net_sup_task_handle(void);
+
+#endif // NET_SUP_H
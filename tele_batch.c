@@ -0,0 +1,38 @@
+#include "tele_batch.h"
+
+#include <string.h>
+
+bool tele_batch_add(tele_batch_t *b, const uint8_t *rec, size_t len, int64_t epoch_off_ms) {
+    if (len <= 4) return true;   // registro vazio: só consome
+    uint32_t ms;
+    memcpy(&ms, rec, 4);
+
+    if (b->n == 0) {
+        jw_init(&b->w, b->buf, TELE_BATCH_MAX);   // até TELE_BATCH_MAX - 1, e o ']'
+        jw_arr_begin(&b->w);
+    }
+
+    jw_t salvo = b->w;
+    jw_obj_begin(&b->w);
+    jw_key(&b->w, "ts");
+    jw_i64(&b->w, epoch_off_ms + ms);
+    jw_key(&b->w, "values");
+    jw_raw(&b->w, (const char *)&rec[4], len - 4);
+    jw_obj_end(&b->w);
+    if (b->w.err) { b->w = salvo; return false; }
+
+    if (b->n == 0) b->t0_ms = ms;
+    b->n++;
+    return true;
+}
+
+bool tele_batch_due(const tele_batch_t *b, bool cheio, uint32_t t_ms) {
+    if (b->n == 0) return false;
+    bool quase = (b->w.len + TELE_REC_MAX + 40 > TELE_BATCH_MAX);   // o próximo não cabe
+    return cheio || quase || t_ms - b->t0_ms >= TELE_BATCH_MS;
+}
+
+size_t tele_batch_close(tele_batch_t *b) {
+    b->buf[b->w.len] = ']';
+    return (size_t)b->w.len + 1;
+}
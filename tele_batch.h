@@ -0,0 +1,52 @@
+#ifndef TELE_BATCH_H
+#define TELE_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "json_writer.h"
+
+// =====================================================
+// TELE_BATCH - lote de registros com horário da telemetria
+// =====================================================
+//
+// Monta o publish no formato do ThingsBoard [{"ts":..,"values":{..}},..],
+// sem FreeRTOS nem lwIP (o mesmo código roda no bench/tele_batch_sim.c
+// contra o cubo_serve/mqtt_stub.py):
+//   - registro: u32 ms do boot + {"chave":valor,...} (mqtt_telemetry_record);
+//     o ts em epoch só é posto aqui, com o offset do SNTP
+//   - registro que não cabe fica para o próximo lote (tele_batch_add = false)
+//   - o lote vai quando o próximo registro não cabe ou TELE_BATCH_MS
+//     depois do primeiro (tele_batch_due)
+//   - o buffer fica intacto até quem chama confirmar (PUBACK) e chamar
+//     tele_batch_clear: o reenvio leva os mesmos registros, com os mesmos
+//     ts (mais os que chegaram no meio, se couberem)
+// =====================================================
+
+#define TELE_BATCH_MAX     1380   // cabe num segmento TCP
+#define TELE_BATCH_MS     10000
+#define TELE_REC_MAX        300   // chaves de um registro, em JSON
+
+typedef struct {
+    char     buf[TELE_BATCH_MAX + 1];
+    jw_t     w;        // len sem o ']' final
+    uint8_t  n;        // registros no lote
+    uint32_t t0_ms;    // ms do boot do 1º registro
+} tele_batch_t;
+
+// Põe o registro (u32 ms + JSON, len bytes) no lote; false = não cabe
+bool tele_batch_add(tele_batch_t *b, const uint8_t *rec, size_t len, int64_t epoch_off_ms);
+
+// Hora de publicar: o registro seguinte não coube (cheio), o próximo não
+// caberia ou venceu o prazo do primeiro
+bool tele_batch_due(const tele_batch_t *b, bool cheio, uint32_t t_ms);
+
+// Fecha o array (o ']' vai no byte reservado) e retorna o tamanho do payload
+size_t tele_batch_close(tele_batch_t *b);
+
+static inline void tele_batch_clear(tele_batch_t *b) {
+    b->n = 0;
+}
+
+#endif